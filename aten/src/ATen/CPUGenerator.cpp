@@ -53,6 +53,7 @@ void CPUGenerator::set_current_seed(uint64_t seed) {
   next_float_normal_sample_.reset();
   next_double_normal_sample_.reset();
   engine_ = mt19937(seed);
+  philox_offset_ = 0;
 }
 
 /**
@@ -151,6 +152,60 @@ void CPUGenerator::set_engine(at::mt19937 engine) {
   engine_ = engine;
 }
 
+/**
+ * Whether the distribution kernels draw from the counter based Philox engine
+ * instead of mt19937.
+ *
+ * Note [CPU Philox mode]
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ * mt19937 is sequential, so a kernel drawing from it has to hold the lock of
+ * the generator and fill its output on one thread. In Philox mode a kernel
+ * only takes the lock to reserve a range of the Philox stream of the current
+ * seed with philox_engine_inputs; every element then uses a fixed position in
+ * that range, so the output can be filled in parallel and does not depend on
+ * the number of threads. The two modes produce different numbers.
+ */
+bool CPUGenerator::use_philox() const {
+  return use_philox_;
+}
+
+/**
+ * Switches between mt19937 and Philox, see Note [CPU Philox mode]
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGenerator::set_use_philox(bool use_philox) {
+  use_philox_ = use_philox;
+}
+
+/**
+ * Sets the offset of the Philox stream, in 128 bit blocks
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGenerator::set_philox_offset(uint64_t offset) {
+  philox_offset_ = offset;
+}
+
+/**
+ * Gets the offset of the Philox stream, in 128 bit blocks
+ */
+uint64_t CPUGenerator::philox_offset() const {
+  return philox_offset_;
+}
+
+/**
+ * Reserves increment 128 bit blocks of the Philox stream and returns the seed
+ * and the offset of the first one, see Note [CPU Philox mode]
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+std::pair<uint64_t, uint64_t> CPUGenerator::philox_engine_inputs(uint64_t increment) {
+  uint64_t offset = philox_offset_;
+  philox_offset_ += increment;
+  return std::make_pair(current_seed(), offset);
+}
+
 /**
  * Public clone method implementation
  *
@@ -170,6 +225,8 @@ CPUGenerator* CPUGenerator::clone_impl() const {
   gen->set_engine(engine_);
   gen->set_next_float_normal_sample(next_float_normal_sample_);
   gen->set_next_double_normal_sample(next_double_normal_sample_);
+  gen->set_use_philox(use_philox_);
+  gen->set_philox_offset(philox_offset_);
   return gen;
 }
 
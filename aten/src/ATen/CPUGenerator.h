@@ -3,6 +3,7 @@
 #include <ATen/core/Generator.h>
 #include <ATen/core/MT19937RNGEngine.h>
 #include <c10/util/Optional.h>
+#include <utility>
 
 namespace at {
 
@@ -25,12 +26,19 @@ struct CAFFE2_API CPUGenerator : public Generator {
   void set_next_double_normal_sample(c10::optional<double> randn);
   at::mt19937 engine();
   void set_engine(at::mt19937 engine);
+  bool use_philox() const;
+  void set_use_philox(bool use_philox);
+  void set_philox_offset(uint64_t offset);
+  uint64_t philox_offset() const;
+  std::pair<uint64_t, uint64_t> philox_engine_inputs(uint64_t increment);
 
 private:
   CPUGenerator* clone_impl() const override;
   at::mt19937 engine_;
   c10::optional<float> next_float_normal_sample_;
   c10::optional<double> next_double_normal_sample_;
+  bool use_philox_ = false;
+  uint64_t philox_offset_ = 0;
 };
 
 namespace detail {
@@ -80,14 +80,32 @@ private:
  * consider the operator add(Tensor, Tensor), the dispatch table for this
  * operator may contain implementations for various dynamic tensor types, such
  * as CPUTensorId, CUDATensorId, etc.
+ *
+ * Besides the kernels registered for this operator, the table keeps, for each
+ * dispatch key, a pointer to the kernel a call with that key resolves to
+ * after taking backend fallback and catch-all kernels into account. Calls
+ * then only need a single load instead of walking the kernel, backend
+ * fallback and catch-all tables. The resolved pointers are recomputed
+ * whenever a kernel of this operator or a backend fallback kernel changes,
+ * which is rare compared to the number of calls.
  */
 class DispatchTable final {
  public:
-  explicit DispatchTable(const FunctionSchema& schema)
+  explicit DispatchTable(const FunctionSchema& schema, const impl::KernelFunctionTable& backendFallbackKernels)
   : kernels_()
   , catchallKernel_()
   , dispatchKeyExtractor_(DispatchKeyExtractor::make(schema))
-  , operatorName_(toString(schema.operator_name())) {}
+  , operatorName_(toString(schema.operator_name()))
+  , backendFallbackKernels_(&backendFallbackKernels)
+  , resolvedKernels_() {
+    updateResolvedKernels();
+  }
+
+  // resolvedKernels_ points into this object, so it must not be copied or moved.
+  DispatchTable(const DispatchTable&) = delete;
+  DispatchTable(DispatchTable&&) = delete;
+  DispatchTable& operator=(const DispatchTable&) = delete;
+  DispatchTable& operator=(DispatchTable&&) = delete;
 
   /**
    * Register a kernel in the table at some dispatch key.
@@ -100,6 +118,7 @@ class DispatchTable final {
     if (result == impl::KernelFunctionTable::SetKernelResult::OVERWROTE_EXISTING_KERNEL) {
       TORCH_WARN("Registered a kernel for operator ", operatorName_, " with dispatch key ", toString(dispatchKey), " that overwrote a previously registered kernel with the same dispatch key for the same operator.");
     }
+    updateResolvedKernels();
   }
 
   /**
@@ -110,6 +129,7 @@ class DispatchTable final {
   void removeKernelIfExists(DispatchKey dispatchKey) {
     kernels_.removeKernelIfExists(dispatchKey);
     dispatchKeyExtractor_.setOperatorHasKernelForBackend(dispatchKey, false);
+    updateResolvedKernels();
   }
 
   /**
@@ -123,6 +143,7 @@ class DispatchTable final {
       TORCH_WARN("Registered a catch-all kernel for operator ", operatorName_," that overwrote a previously registered catch-all kernel for the same operator.");
     }
     catchallKernel_ = std::move(kernel);
+    updateResolvedKernels();
   }
 
   /**
@@ -131,6 +152,7 @@ class DispatchTable final {
   void removeCatchallKernel() {
     TORCH_INTERNAL_ASSERT(catchallKernel_.isValid(), "Tried to remove the catch-all kernel for operator ", operatorName_," but there is no catch-all kernel registered.");
     catchallKernel_ = {};
+    updateResolvedKernels();
   }
 
   bool isEmpty() const {
@@ -180,6 +202,34 @@ class DispatchTable final {
     return &catchallKernel_;
   }
 
+  /**
+   * Returns the kernel to call for the given dispatch key: the kernel
+   * registered for it, else the backend fallback kernel for it, else the
+   * catch-all kernel. Returns nullptr if there is none of these.
+   */
+  const KernelFunction* lookupResolved(DispatchKey dispatchKey) const {
+    return resolvedKernels_[static_cast<uint8_t>(dispatchKey)];
+  }
+
+  /**
+   * Recompute the kernels returned by lookupResolved(). Must be called
+   * whenever a backend fallback kernel is registered or deregistered;
+   * changes to this table's own kernels call it automatically.
+   */
+  void updateResolvedKernels() {
+    const KernelFunction* catchallKernel = lookupCatchallKernel();
+    for (uint8_t iter = 0; iter != static_cast<uint8_t>(DispatchKey::NumDispatchKeys); ++iter) {
+      auto dispatchKey = static_cast<DispatchKey>(iter);
+      if (const KernelFunction* backendKernel = lookup(dispatchKey)) {
+        resolvedKernels_[iter] = backendKernel;
+      } else if ((*backendFallbackKernels_)[dispatchKey].isValid()) {
+        resolvedKernels_[iter] = &(*backendFallbackKernels_)[dispatchKey];
+      } else {
+        resolvedKernels_[iter] = catchallKernel;
+      }
+    }
+  }
+
   const DispatchKeyExtractor& dispatchKeyExtractor() const {
     return dispatchKeyExtractor_;
   }
@@ -194,6 +244,9 @@ private:
   KernelFunction catchallKernel_;
   DispatchKeyExtractor dispatchKeyExtractor_;
   std::string operatorName_;
+  // Owned by the Dispatcher, which outlives all dispatch tables.
+  const impl::KernelFunctionTable* backendFallbackKernels_;
+  std::array<const KernelFunction*, static_cast<uint8_t>(DispatchKey::NumDispatchKeys)> resolvedKernels_;
 };
 
 } // namespace c10
@@ -35,8 +35,8 @@ class SchemaRegistrationHandleRAII;
 class CAFFE2_API Dispatcher final {
 private:
   struct OperatorDef final {
-    explicit OperatorDef(FunctionSchema&& schema, OperatorOptions&& options)
-    : op(std::move(schema), std::move(options)), refcount(0) {}
+    explicit OperatorDef(FunctionSchema&& schema, OperatorOptions&& options, const impl::KernelFunctionTable& backendFallbackKernels)
+    : op(std::move(schema), std::move(options), backendFallbackKernels), refcount(0) {}
 
     impl::OperatorEntry op;
     size_t refcount;
@@ -137,6 +137,7 @@ private:
 
   void deregisterSchema_(const OperatorHandle& op, const OperatorName& op_name);
   void deregisterBackendFallbackKernel_(DispatchKey dispatchKey);
+  void updateBackendFallbackKernels_();
   [[noreturn]] static void reportError(const DispatchTable& dispatchTable, DispatchKey dispatchKey);
 
   const KernelFunction& dispatch_(const DispatchTable& dispatchTable, DispatchKey dispatch_key) const;
@@ -223,20 +224,11 @@ inline void Dispatcher::callBoxed(const OperatorHandle& op, Stack* stack) const
 }
 
 inline const KernelFunction& Dispatcher::dispatch_(const DispatchTable& dispatchTable, DispatchKey dispatchKey) const {
-  const KernelFunction* backendKernel = dispatchTable.lookup(dispatchKey);
-
-  if (nullptr != backendKernel) {
-    return *backendKernel;
-  }
-
-  const auto& backendFallbackKernel = backendFallbackKernels_[dispatchKey];
-  if (backendFallbackKernel.isValid()) {
-    return backendFallbackKernel;
-  }
-
-  const KernelFunction* catchallKernel = dispatchTable.lookupCatchallKernel();
-  if (C10_LIKELY(nullptr != catchallKernel)) {
-    return *catchallKernel;
+  // The dispatch table has already folded backend fallback and catch-all
+  // kernels into its per-key entries, see DispatchTable::lookupResolved.
+  const KernelFunction* kernel = dispatchTable.lookupResolved(dispatchKey);
+  if (C10_LIKELY(nullptr != kernel)) {
+    return *kernel;
   }
 
   reportError(dispatchTable, dispatchKey);
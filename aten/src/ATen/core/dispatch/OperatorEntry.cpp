@@ -17,9 +17,9 @@ namespace {
   }
 }
 
-OperatorEntry::OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options)
+OperatorEntry::OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options, const KernelFunctionTable& backendFallbackKernels)
 : schema_(std::move(schema))
-, dispatchTable_(schema_)
+, dispatchTable_(schema_, backendFallbackKernels)
 , kernels_()
 , catchAllKernels_()
 , options_(std::move(options)) {
@@ -70,6 +70,12 @@ RegistrationHandleRAII OperatorEntry::registerCatchallKernel(KernelFunction kern
   });
 }
 
+void OperatorEntry::updateBackendFallbackKernels() {
+  std::unique_lock<std::mutex> lock(kernelsMutex_);
+
+  dispatchTable_.updateResolvedKernels();
+}
+
 void OperatorEntry::deregisterKernel_(DispatchKey dispatch_key, std::list<KernelFunction>::iterator kernel) {
   std::unique_lock<std::mutex> lock(kernelsMutex_);
 
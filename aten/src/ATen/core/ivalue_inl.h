@@ -252,8 +252,7 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
     completed_ = true;
     value_ = std::move(value);
 
-    fireCallbacks();
-    finished_cv_.notify_all();
+    fireCallbacks(lock);
   }
 
   void markCompleted() {
@@ -267,8 +266,7 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
     has_error = true;
     error = std::move(error_);
 
-    fireCallbacks();
-    finished_cv_.notify_all();
+    fireCallbacks(lock);
   }
 
   // Get the result of the current future.
@@ -311,14 +309,18 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
   }
 
  private:
-  void fireCallbacks() {
+  void fireCallbacks(std::unique_lock<std::mutex>& lock) {
     AT_ASSERT(completed());
-    // There is no need to protect callbacks with the lock.
     // Once completed_ is set to true, no one can add new callback to the list.
-    for (auto& callback : callbacks) {
+    // The callbacks run without the lock, as they may read the value, e.g. a
+    // continuation of the interpreter that runs inline and resumes its wait().
+    std::vector<std::function<void(void)>> cbs;
+    cbs.swap(callbacks);
+    lock.unlock();
+    finished_cv_.notify_all();
+    for (auto& callback : cbs) {
       callback();
     }
-    callbacks.clear();
   }
 
   std::mutex mutex_;
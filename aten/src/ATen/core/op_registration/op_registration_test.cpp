@@ -784,6 +784,29 @@ TEST(OperatorRegistrationTest, whenRegisteringBackendFallbackKernelAndCatchallKe
   EXPECT_EQ("hello _test::dummy", stack[1].toString()->string());
 }
 
+TEST(OperatorRegistrationTest, givenOpWithCatchallKernel_whenRegisteringBackendFallbackKernelAfterwards_thenCallsFallbackKernel) {
+  auto registrar1 = c10::RegisterOperators().op("_test::dummy(Tensor dummy, str input) -> ()", c10::RegisterOperators::options()
+      .catchAllKernel([] (Tensor, std::string) {
+        called = true;
+      }));
+  auto op = Dispatcher::singleton().findSchema({"_test::dummy", ""});
+  ASSERT_TRUE(op.has_value());
+
+  {
+    auto registrar = c10::Dispatcher::singleton().registerBackendFallbackKernel(c10::DispatchKey::CPUTensorId, c10::KernelFunction::makeFromBoxedFunction<&backend_fallback_kernel>());
+
+    called = false;
+    auto stack = callOp(*op, dummyTensor(c10::DispatchKey::CPUTensorId), "hello ");
+    EXPECT_FALSE(called);
+    EXPECT_EQ("hello _test::dummy", stack[1].toString()->string());
+  }
+
+  // the fallback kernel is gone, so the call resolves to the catch-all kernel again
+  called = false;
+  callOp(*op, dummyTensor(c10::DispatchKey::CPUTensorId), "hello ");
+  EXPECT_TRUE(called);
+}
+
 bool called_autograd = false;
 bool called_nonautograd = false;
 
@@ -620,6 +620,25 @@ Tensor gelu_backward_cpu(const Tensor& grad, const Tensor& self) {
   return dX;
 }
 
+// Only meant for inference: it has no derivative of its own, so anything that
+// needs a gradient, or that the kernel does not handle, takes the unfused path.
+Tensor _bias_gelu(const Tensor& self, const Tensor& bias) {
+  const bool fused = self.device().type() == kCPU &&
+      bias.device().type() == kCPU &&
+      isFloatingType(self.scalar_type()) && self.scalar_type() != kHalf &&
+      self.scalar_type() != kBFloat16 &&
+      bias.scalar_type() == self.scalar_type() &&
+      !(GradMode::is_enabled() &&
+        (self.requires_grad() || bias.requires_grad()));
+  if (!fused) {
+    return at::gelu(self + bias);
+  }
+  Tensor result;
+  auto it = TensorIterator::binary_op(result, self, bias);
+  BiasGeluKernel(kCPU, it);
+  return it.output();
+}
+
 Tensor& leaky_relu_out(
     Tensor& result,
     const Tensor& self,
@@ -711,5 +730,6 @@ Tensor& log_sigmoid_backward_out_cpu(
 
 DEFINE_DISPATCH(GeluKernel);
 DEFINE_DISPATCH(GeluBackwardKernel);
+DEFINE_DISPATCH(BiasGeluKernel);
 
 }}  // namespace at::native
@@ -17,6 +17,7 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/DistributionTemplates.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/LegacyTHFunctionsCPU.h>
 
 #include <type_traits>
 #include <functional>
@@ -115,6 +116,7 @@ namespace at {
 namespace native {
 
 DEFINE_DISPATCH(bernoulli_mkl_stub);
+DEFINE_DISPATCH(bernoulli_scalar_stub);
 DEFINE_DISPATCH(cauchy_stub);
 DEFINE_DISPATCH(exponential_stub);
 DEFINE_DISPATCH(multinomial_stub);
@@ -124,6 +126,7 @@ DEFINE_DISPATCH(normal_stub);
 DEFINE_DISPATCH(random_stub);
 DEFINE_DISPATCH(random_from_to_stub);
 DEFINE_DISPATCH(random_full_64_bits_range_stub);
+DEFINE_DISPATCH(uniform_stub);
 
 Tensor bernoulli(const Tensor& self, Generator* gen) {
   return at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT).bernoulli_(self, gen);
@@ -173,6 +176,12 @@ Tensor& bernoulli_tensor_cpu_(Tensor& self, const Tensor& p_, Generator* gen) {
 
 Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   TORCH_CHECK(0 <= p && p <= 1, "bernoulli_ expects p to be in [0, 1], but got p=", p);
+  if (get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator())->use_philox()) {
+    // See Note [CPU Philox mode]
+    auto iter = TensorIterator::nullary_op(self);
+    bernoulli_scalar_stub(iter.device_type(), iter, p, gen);
+    return self;
+  }
 #if AT_MKL_ENABLED()
   if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     bernoulli_mkl_stub(kCPU, self, p, gen);
@@ -192,6 +201,17 @@ Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   return self;
 }
 
+Tensor& uniform_cpu_(Tensor& self, double from, double to, Generator* gen) {
+  if (!get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator())->use_philox()) {
+    return legacy::cpu::_th_uniform_(self, from, to, gen);
+  }
+  // See Note [CPU Philox mode]
+  TORCH_CHECK(from <= to, "uniform_ expects to return a [from, to) range, but found from=", from, " > to=", to);
+  auto iter = TensorIterator::nullary_op(self);
+  uniform_stub(iter.device_type(), iter, from, to, gen);
+  return self;
+}
+
 Tensor& log_normal_(Tensor& self, double mean, double std, Generator* gen) {
   TORCH_CHECK(std > 0.0, "log_normal_ expects std > 0.0, but found std=", std);
   auto iter = TensorIterator::nullary_op(self);
@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/native/EmbeddingBackward.h>
 
 #include <cstring>
 #include <memory>
@@ -40,6 +41,58 @@ Tensor embedding_backward(
   }
 }
 
+// Sums the rows of the same index, so that the result is coalesced
+static Tensor embedding_sparse_backward_cpu(
+    const Tensor & grad_, const Tensor & indices, int64_t num_weights,
+    int64_t padding_idx) {
+  int64_t num_features = grad_.size(-1);
+  int64_t numel = indices.numel();
+  auto grad = grad_.contiguous().view({numel, num_features});
+
+  Tensor sorted_indices, sources;
+  std::tie(sorted_indices, sources) = indices.reshape(-1).sort();
+  auto sorted_indices_data = sorted_indices.data_ptr<int64_t>();
+  auto segment_offsets =
+      embedding_backward_segments(sorted_indices_data, numel);
+  int64_t num_segments = segment_offsets.size() - 1;
+
+  // the row of the result of every segment, or -1 for padding_idx
+  std::vector<int64_t> rows(num_segments);
+  int64_t num_rows = 0;
+  for (int64_t s = 0; s < num_segments; s++) {
+    rows[s] = sorted_indices_data[segment_offsets[s]] == padding_idx
+        ? -1
+        : num_rows++;
+  }
+  auto index = at::empty({1, num_rows}, indices.options());
+  auto index_data = index.data_ptr<int64_t>();
+  for (int64_t s = 0; s < num_segments; s++) {
+    if (rows[s] >= 0) {
+      index_data[rows[s]] = sorted_indices_data[segment_offsets[s]];
+    }
+  }
+  auto values = at::zeros({num_rows, num_features}, grad.options());
+
+  AT_DISPATCH_FLOATING_TYPES(
+      grad.scalar_type(), "embedding_sparse_backward_cpu", [&] {
+        auto values_data = values.data_ptr<scalar_t>();
+        embedding_backward_reduce_segments<scalar_t>(
+            segment_offsets,
+            sources.data_ptr<int64_t>(),
+            grad.data_ptr<scalar_t>(),
+            num_features,
+            [](int64_t /* s */, int64_t /* j */) { return 1.0; },
+            [&](int64_t s) -> scalar_t* {
+              return rows[s] < 0 ? nullptr
+                                 : values_data + rows[s] * num_features;
+            });
+      });
+
+  auto weight_size = std::array<int64_t, 2>{{ num_weights, num_features }};
+  return at::_sparse_coo_tensor_unsafe(index, values, weight_size)
+      ._coalesced_(true);
+}
+
 Tensor embedding_sparse_backward(
     const Tensor & grad_, const Tensor & indices_, int64_t num_weights,
     int64_t padding_idx, bool scale_grad_by_freq) {
@@ -53,6 +106,15 @@ Tensor embedding_sparse_backward(
         "embedding_backward: scale_grad_by_freq not supported with sparse gradients");
   }
 
+  // the reduction is not differentiable, which only matters for double
+  // backward
+  if (grad_.device().type() == kCPU &&
+      (grad_.scalar_type() == kFloat || grad_.scalar_type() == kDouble) &&
+      !(GradMode::is_enabled() && grad_.requires_grad())) {
+    return embedding_sparse_backward_cpu(
+        grad_, indices_, num_weights, padding_idx);
+  }
+
   Tensor indices = indices_;
   Tensor grad = grad_;
   if (padding_idx != -1) {
@@ -84,49 +146,62 @@ Tensor embedding_dense_backward_cpu(
   auto indices_arg = TensorArg(indices, "indices", 2);
   checkScalarType("embedding_backward", indices_arg, kLong);
 
-  auto indices_contig = indices.contiguous();
-  auto indices_data = indices_contig.data_ptr<int64_t>();
   int64_t numel = indices.numel();
-
-  std::unique_ptr<int64_t[]> counts;
-  if (scale_grad_by_freq) {
-    counts.reset(new int64_t[num_weights]);
-    for (int i = 0; i < numel; i++) {
-      counts[indices_data[i]] = 0;
-    }
-    for (int i = 0; i < numel; i++) {
-      counts[indices_data[i]]++;
-    }
+  int64_t num_features = grad_.size(-1);
+  auto grad = grad_.contiguous().view({numel, num_features});
+  auto grad_weight = at::zeros({num_weights, num_features}, grad_.options());
+  if (numel == 0) {
+    return grad_weight;
   }
 
-  auto grad = grad_.contiguous().view({numel, grad_.size(-1)});
-  auto grad_weight = at::zeros({num_weights, grad_.size(-1)}, grad_.options());
-
-  auto parallel_section = [&](int64_t start, int64_t end) {
-    for (int64_t i = 0; i < numel; i++) {
-      if (indices_data[i] != padding_idx) {
-        int64_t k = indices_data[i];
-        if (k >= start && k < end) {
-          double scale = 1.0;
-          if (scale_grad_by_freq) {
-            scale /= counts[k];
-          }
-          grad_weight[k].add_(grad[i], scale);
-        }
-      }
-    }
+  // Every weight is updated by the thread that reduces its segment of the
+  // sorted indices, which is also where its count comes from
+  Tensor sorted_indices, sources;
+  std::tie(sorted_indices, sources) = indices.reshape(-1).sort();
+  auto sorted_indices_data = sorted_indices.data_ptr<int64_t>();
+  auto segment_offsets =
+      embedding_backward_segments(sorted_indices_data, numel);
+  auto segment_scale = [&](int64_t s) {
+    return scale_grad_by_freq
+        ? 1.0 / (segment_offsets[s + 1] - segment_offsets[s])
+        : 1.0;
   };
 
-  if (numel > 1000) {
-    // The strategy is to parallelize over sections of the vocabulary, so that
-    // thread 1 handles updates to gradWeight[0..nVocab/nThreads]. Every thread
-    // has to traverse the entire input, but the dominating factor is the axpy
-    // BLAS call.
-    at::parallel_for(0, num_weights, 0, parallel_section);
-  } else {
-    parallel_section(0, num_weights);
+  // THBlas has no axpy for the other types, e.g. BFloat16, whose segments
+  // are reduced with add_. Note that we cannot use at::parallel_for here
+  // because we perform operations on Tensor inside the loop, see
+  // embedding_renorm_cpu_.
+  if (grad.scalar_type() != kFloat && grad.scalar_type() != kDouble) {
+    auto sources_data = sources.data_ptr<int64_t>();
+    for (size_t s = 0; s + 1 < segment_offsets.size(); s++) {
+      int64_t k = sorted_indices_data[segment_offsets[s]];
+      if (k == padding_idx) {
+        continue;
+      }
+      auto row = grad_weight[k];
+      for (int64_t j = segment_offsets[s]; j < segment_offsets[s + 1]; j++) {
+        row.add_(grad[sources_data[j]], segment_scale(s));
+      }
+    }
+    return grad_weight;
   }
 
+  AT_DISPATCH_FLOATING_TYPES(
+      grad.scalar_type(), "embedding_dense_backward_cpu", [&] {
+        auto grad_weight_data = grad_weight.data_ptr<scalar_t>();
+        embedding_backward_reduce_segments<scalar_t>(
+            segment_offsets,
+            sources.data_ptr<int64_t>(),
+            grad.data_ptr<scalar_t>(),
+            num_features,
+            [&](int64_t s, int64_t /* j */) { return segment_scale(s); },
+            [&](int64_t s) -> scalar_t* {
+              int64_t k = sorted_indices_data[segment_offsets[s]];
+              return k == padding_idx ? nullptr
+                                      : grad_weight_data + k * num_features;
+            });
+      });
+
   return grad_weight;
 }
 
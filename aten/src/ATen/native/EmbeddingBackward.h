@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+#include <TH/THBlasUtils.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace at {
+namespace native {
+
+// The backward of embedding and embedding_bag on CPU reduces the rows of grad
+// that belong to the same weight. With the weight indices sorted, the rows of
+// a weight form a segment, and every segment is reduced by one thread, so no
+// two threads write the same row of the result.
+
+// Returns the start of every segment of equal indices in sorted_indices,
+// followed by numel.
+inline std::vector<int64_t> embedding_backward_segments(
+    const int64_t* sorted_indices,
+    int64_t numel) {
+  std::vector<int64_t> segment_offsets;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || sorted_indices[i] != sorted_indices[i - 1]) {
+      segment_offsets.push_back(i);
+    }
+  }
+  segment_offsets.push_back(numel);
+  return segment_offsets;
+}
+
+// For every segment s, adds scale(s, j) * grad[sources[j]] to out_row(s) for
+// the positions j of the segment, in order; out_row may return nullptr to skip
+// the segment. The segments are split between the
+// threads by the number of rows they reduce rather than by their number, so
+// that frequent indices do not leave threads idle.
+template <typename scalar_t, typename ScaleFn, typename OutRowFn>
+void embedding_backward_reduce_segments(
+    const std::vector<int64_t>& segment_offsets,
+    const int64_t* sources,
+    const scalar_t* grad_data,
+    int64_t ddim,
+    const ScaleFn& scale,
+    const OutRowFn& out_row) {
+  const int64_t numel = segment_offsets.back();
+  const auto segments_end = segment_offsets.end() - 1;
+  // about as much work per task as the rest of ATen
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(ddim, 1));
+  parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
+    // the segments that start in [begin, end)
+    auto first = std::lower_bound(segment_offsets.begin(), segments_end, begin);
+    auto last = std::lower_bound(first, segments_end, end);
+    for (auto it = first; it != last; ++it) {
+      const int64_t s = it - segment_offsets.begin();
+      scalar_t* out = out_row(s);
+      if (out == nullptr) {
+        continue;
+      }
+      for (int64_t j = *it; j < *(it + 1); j++) {
+        THBlas_axpy<scalar_t>(
+            ddim,
+            static_cast<scalar_t>(scale(s, j)),
+            const_cast<scalar_t*>(grad_data) + ddim * sources[j],
+            1,
+            out,
+            1);
+      }
+    }
+  });
+}
+
+} // namespace native
+} // namespace at
@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/EmbeddingBackward.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -521,44 +522,6 @@ static Tensor _embedding_bag_dense_backward_cpu_max(
   return index_grad_weight;
 }
 
-static std::vector<int64_t> compute_counts(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length) {
-  std::vector<int64_t> counts(num_weights, 0);
-  for (int i = 0; i < indices_length; i++) {
-    counts[indices_data[i]]++;
-  }
-  return counts;
-}
-
-// counts_uniq stores the index of the NEXT unique element
-// of the (sorted) indices vector.
-//
-// For example:
-// indices: [0, 0, 0, 1, 3, 3, 4]
-// counts: [3, 1, 0, 2, 1, 0]
-// counts_uniq: [3, 4, 6, 7]
-//
-// The unique indices can be found at index 0, 3, 4, 6.
-static std::vector<int64_t> compute_counts_uniq(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length,
-    const std::vector<int64_t>& counts) {
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < indices_length; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
-    }
-    o++;
-  }
-  return counts_uniq;
-}
-
 template <typename scalar_t>
 void _embedding_bag_dense_backward_cpu_sum_mean(
     const Tensor& grad,
@@ -591,50 +554,45 @@ void _embedding_bag_dense_backward_cpu_sum_mean(
   auto* offsets_data = offsets_.data_ptr<int64_t>();
   auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
   int64_t numel = indices.numel();
-
-  auto counts = compute_counts(num_weights, indices_data, numel);
-  auto next_unique_index_idx =
-      compute_counts_uniq(num_weights, indices_data, numel, counts);
-
-  auto loop = [&](int64_t start, int64_t end) {
-    for (int64_t i = start; i < end; i++) {
-      int64_t start = i == 0 ? 0 : next_unique_index_idx[i - 1];
-      int64_t index = indices_data[start];
-      for (int64_t j = start; j < next_unique_index_idx[i]; j++) {
-        int64_t source = offset2bag_data[j];
-        double scale = 1.0;
-        if (per_sample_weights) {
-          AT_ASSERT(mode == MODE_SUM);
-          scale = per_sample_weights_data[*per_sample_weights_stride * j];
-        }
-        if (scale_grad_by_freq) {
-          scale /= counts[indices_data[i]];
-        }
-        if (mode == 1) { // MODE_MEAN
-          if (offsets_.size(0) == 1) {
-            auto bag_size = indices.size(0);
-            scale /= bag_size;
-          } else {
-            if (source == offsets_.size(0) - 1) {
-              scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-            } else {
-              scale /= offsets_data[source + 1] - offsets_data[source];
-            }
-          }
-        }
-        int64_t ddim = grad.size(1);
-        auto igwd = index_grad_weight.data_ptr<scalar_t>();
-        auto gd = grad.data_ptr<scalar_t>();
-        THBlas_axpy<scalar_t>(ddim, (scalar_t)scale, gd + ddim * source, 1,
-                    igwd + ddim * index, 1);
+  int64_t num_bags = offsets_.size(0);
+  int64_t ddim = grad.size(1);
+
+  // the segment of an index holds all its occurrences, so its size is the
+  // count used by scale_grad_by_freq
+  auto segment_offsets = embedding_backward_segments(indices_data, numel);
+
+  auto scale = [&](int64_t s, int64_t j) {
+    int64_t source = offset2bag_data[j];
+    double scale = 1.0;
+    if (per_sample_weights) {
+      AT_ASSERT(mode == MODE_SUM);
+      scale = per_sample_weights_data[*per_sample_weights_stride * j];
+    }
+    if (scale_grad_by_freq) {
+      scale /= segment_offsets[s + 1] - segment_offsets[s];
+    }
+    if (mode == MODE_MEAN) {
+      if (num_bags == 1) {
+        scale /= numel;
+      } else if (source == num_bags - 1) {
+        scale /= numel - offsets_data[num_bags - 1];
+      } else {
+        scale /= offsets_data[source + 1] - offsets_data[source];
       }
     }
+    return scale;
   };
-  if (numel > 1000) {
-    at::parallel_for(0, (int64_t)next_unique_index_idx.size(), 0, loop);
-  } else {
-    loop(0, (int64_t)next_unique_index_idx.size());
-  }
+  auto* index_grad_weight_data = index_grad_weight.data_ptr<scalar_t>();
+  embedding_backward_reduce_segments<scalar_t>(
+      segment_offsets,
+      offset2bag_data,
+      grad.data_ptr<scalar_t>(),
+      ddim,
+      scale,
+      [&](int64_t s) {
+        return index_grad_weight_data +
+            ddim * indices_data[segment_offsets[s]];
+      });
 }
 
 Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indices_,
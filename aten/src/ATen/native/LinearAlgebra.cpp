@@ -12,6 +12,7 @@
 #include <vector>
 #include <limits>
 #include <ATen/NamedTensorUtils.h>
+#include <TH/THBlasUtils.h>
 
 namespace at {
 namespace native {
@@ -170,7 +171,7 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
   auto s0 = self.accessor<scalar_t, 3>();
   auto m0 = mat2.accessor<scalar_t, 3>();
 
-  int64_t grain_size = std::min(internal::GRAIN_SIZE / (is * js * ks), (int64_t)1);
+  int64_t grain_size = std::max(internal::GRAIN_SIZE / (is * js * ks), (int64_t)1);
   parallel_for(0, bs, grain_size, [&](int64_t b_begin, int64_t b_end) {
       for (int64_t b = b_begin; b < b_end; b++) {
         auto r1 = r0[b];
@@ -198,11 +199,69 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
     });
 }
 
+// Runs every batch as a GEMM on raw pointers, in parallel across the batches
+// and, when there are fewer batches than threads, across blocks of rows of
+// each GEMM. The rows of every batch item of result must be contiguous, and
+// every batch item of batch1 and batch2 must be contiguous or transposed.
+template <typename scalar_t>
+inline void baddbmm_gemm_batched(const Tensor& result, const Tensor& batch1, const Tensor& batch2, Scalar beta_, Scalar alpha_) {
+  int64_t bs = result.size(0);
+  int64_t res_rows = result.size(1);
+  int64_t res_cols = result.size(2);
+  int64_t contraction_size = batch1.size(2);
+
+  scalar_t alpha = alpha_.to<scalar_t>();
+  scalar_t beta = beta_.to<scalar_t>();
+
+  // THBlas_gemm is column major, so compute result^T = batch2^T * batch1^T,
+  // which reads the row major operands without copies.
+  auto is_transposed = [](const Tensor& t) {
+    return !(t.stride(2) == 1 && t.stride(1) >= t.size(2));
+  };
+  const bool trans1 = is_transposed(batch1);
+  const bool trans2 = is_transposed(batch2);
+  const char transa = trans2 ? 't' : 'n';
+  const char transb = trans1 ? 't' : 'n';
+  const int64_t lda = trans2 ? batch2.stride(2) : batch2.stride(1);
+  const int64_t ldb = trans1 ? batch1.stride(2) : batch1.stride(1);
+  const int64_t ldc = result.stride(1);
+
+  int64_t rows_per_block = res_rows;
+  const int64_t num_threads = at::get_num_threads();
+  if (bs < num_threads) {
+    rows_per_block = divup(res_rows, divup(num_threads, bs));
+  }
+  const int64_t row_blocks = divup(res_rows, rows_per_block);
+  const int64_t grain_size = std::max(
+      internal::GRAIN_SIZE / (rows_per_block * res_cols * contraction_size),
+      (int64_t)1);
+
+  scalar_t* r = result.data_ptr<scalar_t>();
+  scalar_t* s = batch1.data_ptr<scalar_t>();
+  scalar_t* m = batch2.data_ptr<scalar_t>();
+  parallel_for(0, bs * row_blocks, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t b = i / row_blocks;
+      const int64_t row = (i % row_blocks) * rows_per_block;
+      const int64_t rows = std::min(rows_per_block, res_rows - row);
+      THBlas_gemm<scalar_t>(
+          transa, transb, res_cols, rows, contraction_size, alpha,
+          m + b * batch2.stride(0), lda,
+          s + b * batch1.stride(0) + row * batch1.stride(1), ldb,
+          beta,
+          r + b * result.stride(0) + row * result.stride(1), ldc);
+    }
+  });
+}
+
 // This tries to apply some optimizations to bmm/baddbmm:
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
-// - Otherwise, we use a series of matrix multiplications.
+// - Otherwise, the batches are run as independent GEMMs in parallel, see
+//   baddbmm_gemm_batched. A result whose rows are not contiguous, or a type
+//   baddbmm_gemm_batched is not instantiated for, falls back to a series of
+//   matrix multiplications.
 // The threshold of 400 for the first has not been thoroughly benchmarked yet and may have room for further
 // optimization, it likely depends on the characteristics of the CPU, MKL will be different from non-MKL etc.,
 // but this seems to be a first starting point.
@@ -245,6 +304,9 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             || (t.stride(1) == 1 && t.stride(2) >= t.size(1));
   };
 
+  // Only the types of AT_DISPATCH_ALL_TYPES take the batched paths below, the
+  // others (e.g. BFloat16) run as a series of matrix multiplications.
+  const auto dtype = self_or_result.scalar_type();
   if (contraction_size * res_rows * res_cols < 400) {
     if (is_bmm_out) {
       AT_DISPATCH_ALL_TYPES(batch1.scalar_type(), "bmm", [&] {
@@ -255,11 +317,18 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
           baddbmm_cpu_kernel<scalar_t, false>(self_or_result, batch1, batch2, beta, alpha);
         });
     }
-  } else if (at::hasMKL() && at::native::is_floating_point(self_or_result)
+  } else if (at::hasMKL() && (dtype == kFloat || dtype == kDouble)
             && batch_items_contiguous_or_transposed(batch1)
             && batch_items_contiguous_or_transposed(batch2)
             && self_or_result.is_contiguous()) {
     at::native::_baddbmm_mkl_(self_or_result, batch1, batch2, beta, alpha);
+  } else if ((isIntegralType(dtype, /*includeBool=*/false) || dtype == kFloat || dtype == kDouble)
+            && self_or_result.stride(2) == 1 && self_or_result.stride(1) >= res_cols) {
+    const Tensor b1 = batch_items_contiguous_or_transposed(batch1) ? batch1 : batch1.contiguous();
+    const Tensor b2 = batch_items_contiguous_or_transposed(batch2) ? batch2 : batch2.contiguous();
+    AT_DISPATCH_ALL_TYPES(batch1.scalar_type(), c, [&] {
+        baddbmm_gemm_batched<scalar_t>(self_or_result, b1, b2, beta, alpha);
+      });
   } else { // split along batch dimension
     if (is_bmm_out) {
       for (int64_t b = 0; b < bs; b++) {
@@ -425,9 +494,16 @@ Tensor matmul(
     std::vector<int64_t> tensor2_bmm_view({expand_batch_product});
     tensor2_bmm_view.insert(tensor2_bmm_view.end(), {m2, p});
 
-    // flatten expanded batches
-    Tensor tensor1_expanded = tensor1.expand(tensor1_expand_size).contiguous().view(tensor1_bmm_view);
-    Tensor tensor2_expanded = tensor2.expand(tensor2_expand_size).contiguous().view(tensor2_bmm_view);
+    // flatten expanded batches. The CPU bmm reads every batch through its own
+    // pointer, so batches that are only broadcast need not be copied.
+    Tensor tensor1_expanded, tensor2_expanded;
+    if (tensor1.device().is_cpu() && tensor2.device().is_cpu()) {
+      tensor1_expanded = tensor1.expand(tensor1_expand_size).reshape(tensor1_bmm_view);
+      tensor2_expanded = tensor2.expand(tensor2_expand_size).reshape(tensor2_bmm_view);
+    } else {
+      tensor1_expanded = tensor1.expand(tensor1_expand_size).contiguous().view(tensor1_bmm_view);
+      tensor2_expanded = tensor2.expand(tensor2_expand_size).contiguous().view(tensor2_bmm_view);
+    }
 
     // reshape batches back into result
     std::vector<int64_t> output_shape(expand_batch_portion);
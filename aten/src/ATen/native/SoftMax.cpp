@@ -4,6 +4,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/WrapDimUtils.h>
+#include <ATen/ExpandUtils.h>
 #include <ATen/native/cpu/SoftmaxKernel.h>
 #include <ATen/NamedTensorUtils.h>
 
@@ -11,58 +12,6 @@ namespace at {
 namespace native {
 namespace {
 
-template <typename scalar_t, bool LogSoftMax>
-void host_softmax(Tensor output, const Tensor& input, const int64_t dim) {
-  int64_t outer_size = 1;
-  int64_t dim_size = input.size(dim);
-  int64_t inner_size = 1;
-  for (int64_t i = 0; i < dim; ++i)
-    outer_size *= input.size(i);
-  for (int64_t i = dim + 1; i < input.dim(); ++i)
-    inner_size *= input.size(i);
-  int64_t dim_stride = inner_size;
-  int64_t outer_stride = dim_size * dim_stride;
-  scalar_t* input_data_base = input.data_ptr<scalar_t>();
-  scalar_t* output_data_base = output.data_ptr<scalar_t>();
-  int64_t grain_size = std::min(internal::GRAIN_SIZE / dim_size, (int64_t)1);
-  parallel_for(
-      0, outer_size * inner_size, grain_size,
-      [&](int64_t begin, int64_t end) {
-        for (int64_t i = begin; i < end; i++) {
-          int64_t outer_idx = i / inner_size;
-          int64_t inner_idx = i % inner_size;
-          scalar_t* input_data =
-              input_data_base + outer_idx * outer_stride + inner_idx;
-          scalar_t* output_data =
-              output_data_base + outer_idx * outer_stride + inner_idx;
-          scalar_t max_input = input_data[0];
-          for (int64_t d = 1; d < dim_size; d++)
-            max_input = std::max(max_input, input_data[d * dim_stride]);
-
-          acc_type<scalar_t, false> tmpsum = 0;
-          for (int64_t d = 0; d < dim_size; d++) {
-            scalar_t z = std::exp(input_data[d * dim_stride] - max_input);
-            if (!LogSoftMax) {
-              output_data[d * dim_stride] = z;
-            }
-            tmpsum += z;
-          }
-
-          if (LogSoftMax)
-            tmpsum = std::log(tmpsum);
-          else
-            tmpsum = 1 / tmpsum;
-
-          for (int64_t d = 0; d < dim_size; d++)
-            if (LogSoftMax)
-              output_data[d * dim_stride] =
-                  input_data[d * dim_stride] - max_input - tmpsum;
-            else
-              output_data[d * dim_stride] *= tmpsum;
-        }
-      });
-}
-
 template <typename scalar_t, bool LogSoftMax>
 void host_softmax_backward(
     Tensor& gI,
@@ -134,9 +83,7 @@ Tensor softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_
   if (input.ndimension() > 0 && dim == input.ndimension() - 1) {
     softmax_lastdim_kernel(kCPU, output, input);
   } else {
-    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "softmax", [&] {
-      host_softmax<scalar_t, false>(output, input, dim);
-    });
+    softmax_kernel(kCPU, output, input, dim);
   }
   return output;
 }
@@ -158,9 +105,7 @@ Tensor log_softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half
   if (input.ndimension() > 0 && dim == input.ndimension() - 1) {
     log_softmax_lastdim_kernel(kCPU, output, input);
   } else {
-    AT_DISPATCH_FLOATING_TYPES_AND(
-        at::ScalarType::BFloat16, input.scalar_type(), "log_softmax",
-        [&] { host_softmax<scalar_t, true>(output, input, dim); });
+    log_softmax_kernel(kCPU, output, input, dim);
   }
   return output;
 }
@@ -277,10 +222,44 @@ Tensor log_softmax(const Tensor& input_, const int64_t dim_, c10::optional<Scala
   return result;
 }
 
+// softmax((self * scale).masked_fill(mask, value), dim), fused on CPU for the
+// attention scores of inference. It has no derivative of its own, so anything
+// that needs a gradient, or that the kernel does not handle, takes the
+// unfused path.
+Tensor _masked_softmax(
+    const Tensor& self,
+    const Tensor& mask,
+    int64_t dim_,
+    Scalar value,
+    double scale) {
+  int64_t dim = maybe_wrap_dim(dim_, self.dim());
+  const bool fused = self.device().type() == kCPU &&
+      mask.device().type() == kCPU &&
+      (self.scalar_type() == kFloat || self.scalar_type() == kDouble) &&
+      mask.scalar_type() == kBool && self.dim() > 0 &&
+      dim == self.dim() - 1 && is_expandable_to(mask.sizes(), self.sizes()) &&
+      !(GradMode::is_enabled() && self.requires_grad());
+  if (!fused) {
+    Tensor scaled = scale == 1 ? self : self * scale;
+    return at::softmax(scaled.masked_fill(mask, value), dim);
+  }
+  auto input = self.contiguous();
+  Tensor output =
+      at::native::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (input.numel() > 0) {
+    masked_softmax_lastdim_kernel(
+        kCPU, output, input, mask.expand(input.sizes()), scale, value);
+  }
+  return output;
+}
+
 DEFINE_DISPATCH(softmax_lastdim_kernel);
 DEFINE_DISPATCH(log_softmax_lastdim_kernel);
 DEFINE_DISPATCH(softmax_backward_lastdim_kernel);
 DEFINE_DISPATCH(log_softmax_backward_lastdim_kernel);
+DEFINE_DISPATCH(softmax_kernel);
+DEFINE_DISPATCH(log_softmax_kernel);
+DEFINE_DISPATCH(masked_softmax_lastdim_kernel);
 
 Tensor softmax(const Tensor& self, Dimname dim, optional<ScalarType> dtype) {
   return at::softmax(self, dimname_to_position(self, dim), dtype);
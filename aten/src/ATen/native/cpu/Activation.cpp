@@ -280,6 +280,29 @@ void GeluKernelImpl(TensorIterator& it) {
   }
 }
 
+// gelu(x + b) with the erf of GeluKernelImpl, which the MKL path does not
+// leave room to fuse
+void BiasGeluKernelImpl(TensorIterator& it) {
+  AT_DISPATCH_FLOATING_TYPES(it.dtype(), "BiasGeluKernelImpl", [&]() {
+    using Vec = vec256::Vec256<scalar_t>;
+    const Vec kAlphaVec(M_SQRT1_2);
+    const Vec kOneVec(1);
+    const Vec kPointFiveVec(0.5);
+    cpu_kernel_vec(
+        it,
+        [](scalar_t x, scalar_t b) {
+          constexpr scalar_t kAlpha = M_SQRT1_2;
+          x += b;
+          return x * scalar_t(0.5) * (scalar_t(1) + std::erf(x * kAlpha));
+        },
+        [&](Vec x_vec, Vec b_vec) {
+          x_vec = x_vec + b_vec;
+          return x_vec * kPointFiveVec *
+              (kOneVec + (x_vec * kAlphaVec).erf());
+        });
+  });
+}
+
 void GeluBackwardKernelImpl(TensorIterator& it) {
   if (hasMKL() && it.is_contiguous()) {
     AT_DISPATCH_FLOATING_TYPES(it.dtype(), "GeluBackwardKernelImpl", [&]() {
@@ -490,6 +513,7 @@ REGISTER_DISPATCH(threshold_stub, &threshold_kernel);
 REGISTER_DISPATCH(elu_stub, &elu_kernel);
 REGISTER_DISPATCH(elu_backward_stub, &elu_backward_kernel);
 REGISTER_DISPATCH(GeluKernel, &GeluKernelImpl);
+REGISTER_DISPATCH(BiasGeluKernel, &BiasGeluKernelImpl);
 REGISTER_DISPATCH(GeluBackwardKernel, &GeluBackwardKernelImpl);
 REGISTER_DISPATCH(hardtanh_backward_stub, &hardtanh_backward_kernel);
 REGISTER_DISPATCH(hardshrink_stub, &hardshrink_kernel);
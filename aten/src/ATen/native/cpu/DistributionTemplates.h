@@ -1,7 +1,10 @@
 #pragma once
 
+#include <ATen/CPUGenerator.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/DistributionsHelper.h>
+#include <ATen/core/PhiloxRNGEngine.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 #include <limits>
@@ -12,22 +15,123 @@ namespace native {
 namespace templates {
 namespace cpu {
 
+// A position in a Philox stream, with the interface the distributions of
+// DistributionsHelper.h expect from a generator. Normal samples are not
+// cached, so that every element of a tensor uses the same number of draws.
+// See Note [CPU Philox mode]
+class PhiloxStream {
+ public:
+  // offset is in 128 bit blocks, position in 32 bit draws after it.
+  PhiloxStream(uint64_t seed, uint64_t offset, uint64_t position)
+    : seed_(seed), offset_(offset), position_(position), engine_(seed, 0, offset + position / 4) {
+    for (uint64_t i = 0; i < position % 4; i++) {
+      engine_();
+    }
+  }
+
+  void seek(uint64_t position) {
+    if (position != position_) {
+      *this = PhiloxStream(seed_, offset_, position);
+    }
+  }
+
+  uint32_t random() {
+    position_++;
+    return engine_();
+  }
+
+  uint64_t random64() {
+    uint32_t hi = random();
+    uint32_t lo = random();
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+  c10::optional<float> next_float_normal_sample() { return c10::nullopt; }
+  c10::optional<double> next_double_normal_sample() { return c10::nullopt; }
+  void set_next_float_normal_sample(c10::optional<float> /* randn */) {}
+  void set_next_double_normal_sample(c10::optional<double> /* randn */) {}
+
+ private:
+  uint64_t seed_;
+  uint64_t offset_;
+  uint64_t position_;
+  at::philox_engine engine_;
+};
+
+// Fills the output of iter in parallel with f(PhiloxStream*). Element i
+// starts at draw i * draws_per_element of a range of the Philox stream that
+// is reserved under the lock of the generator, so the result does not depend
+// on how the elements are split across threads.
+template<typename scalar_t, typename RNG, typename func_t>
+void cpu_philox_kernel(TensorIterator& iter, RNG* generator, uint64_t draws_per_element, const func_t& f) {
+  const int64_t numel = iter.numel();
+  std::pair<uint64_t, uint64_t> philox_inputs;
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    philox_inputs = generator->philox_engine_inputs(divup(numel * draws_per_element, 4));
+  }
+  at::parallel_for(0, numel, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    PhiloxStream stream(philox_inputs.first, philox_inputs.second, begin * draws_per_element);
+    int64_t index = begin;
+    iter.serial_for_each([&](char** data, const int64_t* strides, int64_t n) {
+      for (int64_t i = 0; i < n; i++, index++) {
+        stream.seek(index * draws_per_element);
+        *reinterpret_cast<scalar_t*>(data[0] + i * strides[0]) = static_cast<scalar_t>(f(&stream));
+      }
+    }, {begin, end});
+  });
+}
+
+// Number of 32 bit draws of uniform_real_distribution<T>.
+template<typename T>
+constexpr uint64_t uniform_draws() {
+  return std::is_same<T, double>::value ? 2 : 1;
+}
+
+// Returns the generator if it is a CPUGenerator in Philox mode, see
+// Note [CPU Philox mode]
+template<typename RNG>
+CPUGenerator* philox_generator(RNG* /* generator */) {
+  return nullptr;
+}
+
+inline CPUGenerator* philox_generator(CPUGenerator* generator) {
+  return generator->use_philox() ? generator : nullptr;
+}
+
+// Fills the output of iter with f(generator), which has to be callable with
+// both RNG* and PhiloxStream* and to use draws_per_element 32 bit draws. The
+// output is filled in parallel if the generator is in Philox mode, and
+// serially under the lock of the generator otherwise.
+template<typename scalar_t, typename RNG, typename func_t>
+void cpu_random_kernel(TensorIterator& iter, RNG* generator, uint64_t draws_per_element, const func_t& f) {
+  if (auto* philox = philox_generator(generator)) {
+    cpu_philox_kernel<scalar_t>(iter, philox, draws_per_element, f);
+    return;
+  }
+  // See Note [Acquire lock when using random generators]
+  std::lock_guard<std::mutex> lock(generator->mutex_);
+  cpu_serial_kernel(iter, [generator, &f]() -> scalar_t {
+    return static_cast<scalar_t>(f(generator));
+  });
+}
+
 template<typename RNG>
 void random_from_to_kernel(TensorIterator& iter, uint64_t range, int64_t base, RNG* generator) {
   AT_DISPATCH_ALL_TYPES_AND3(at::ScalarType::Bool, at::ScalarType::Half, at::ScalarType::BFloat16, iter.dtype(), "random_from_to_kernel_cpu", [&] {
-    std::lock_guard<std::mutex> lock(generator->mutex_);
     if ((
       std::is_same<scalar_t, int64_t>::value ||
       std::is_same<scalar_t, double>::value ||
       std::is_same<scalar_t, float>::value ||
       std::is_same<scalar_t, at::BFloat16>::value) && range >= 1ULL << 32)
     {
-      cpu_serial_kernel(iter, [range, base, generator]() -> scalar_t {
-        return static_cast<scalar_t>(static_cast<int64_t>((generator->random64() % range) + base));
+      cpu_random_kernel<scalar_t>(iter, generator, 2, [range, base](auto* gen) -> scalar_t {
+        return static_cast<scalar_t>(static_cast<int64_t>((gen->random64() % range) + base));
       });
     } else {
-      cpu_serial_kernel(iter, [range, base, generator]() -> scalar_t {
-        return static_cast<scalar_t>(static_cast<int64_t>((generator->random() % range) + base));
+      cpu_random_kernel<scalar_t>(iter, generator, 1, [range, base](auto* gen) -> scalar_t {
+        return static_cast<scalar_t>(static_cast<int64_t>((gen->random() % range) + base));
       });
     }
   });
@@ -39,13 +143,12 @@ void random_from_to_kernel(TensorIterator& iter, uint64_t range, int64_t base, R
 template<typename RNG>
 void random_full_64_bits_range_kernel(TensorIterator& iter, RNG* generator) {
   AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::BFloat16, iter.dtype(), "random_full_64_bits_range_kernel_cpu", [&] {
-    std::lock_guard<std::mutex> lock(generator->mutex_);
     if (std::is_same<scalar_t, int64_t>::value ||
         std::is_same<scalar_t, double>::value ||
         std::is_same<scalar_t, float>::value ||
         std::is_same<scalar_t, at::BFloat16>::value) {
-      cpu_serial_kernel(iter, [generator]() -> scalar_t {
-        return static_cast<scalar_t>(static_cast<int64_t>(generator->random64()));
+      cpu_random_kernel<scalar_t>(iter, generator, 2, [](auto* gen) -> scalar_t {
+        return static_cast<scalar_t>(static_cast<int64_t>(gen->random64()));
       });
     } else {
       TORCH_CHECK(false, "random_full_64_bits_range_kernel_cpu handles only int64, double, float and bfloat16");
@@ -65,32 +168,31 @@ struct RandomFromToKernel {
 
 template<typename RNG>
 void random_kernel(TensorIterator& iter, RNG* generator) {
-  std::lock_guard<std::mutex> lock(generator->mutex_);
   if (isFloatingType(iter.dtype())) {
     AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, iter.dtype(), "random_kernel_fp_cpu", [&] {
       if (std::is_same<scalar_t, double>::value) {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-          return static_cast<scalar_t>(generator->random64() % static_cast<uint64_t>((1ULL << std::numeric_limits<scalar_t>::digits) + 1));
+        cpu_random_kernel<scalar_t>(iter, generator, 2, [](auto* gen) -> scalar_t {
+          return static_cast<scalar_t>(gen->random64() % static_cast<uint64_t>((1ULL << std::numeric_limits<scalar_t>::digits) + 1));
         });
       } else {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-          return static_cast<scalar_t>(generator->random() % static_cast<uint64_t>((1ULL << std::numeric_limits<scalar_t>::digits) + 1));
+        cpu_random_kernel<scalar_t>(iter, generator, 1, [](auto* gen) -> scalar_t {
+          return static_cast<scalar_t>(gen->random() % static_cast<uint64_t>((1ULL << std::numeric_limits<scalar_t>::digits) + 1));
         });
       }
     });
   } else if (isIntegralType(iter.dtype(), /*includeBool=*/true)) {
     AT_DISPATCH_INTEGRAL_TYPES_AND(at::ScalarType::Bool, iter.dtype(), "random_kernel_int_cpu", [&] {
       if (std::is_same<scalar_t, int64_t>::value) {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-          return static_cast<scalar_t>(generator->random64() % (static_cast<uint64_t>(std::numeric_limits<scalar_t>::max()) + 1));
+        cpu_random_kernel<scalar_t>(iter, generator, 2, [](auto* gen) -> scalar_t {
+          return static_cast<scalar_t>(gen->random64() % (static_cast<uint64_t>(std::numeric_limits<scalar_t>::max()) + 1));
         });
       } else if (std::is_same<scalar_t, bool>::value) {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-          return static_cast<scalar_t>(generator->random() & 1);
+        cpu_random_kernel<scalar_t>(iter, generator, 1, [](auto* gen) -> scalar_t {
+          return static_cast<scalar_t>(gen->random() & 1);
         });
       } else {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-          return static_cast<scalar_t>(generator->random() % (static_cast<uint64_t>(std::numeric_limits<scalar_t>::max()) + 1));
+        cpu_random_kernel<scalar_t>(iter, generator, 1, [](auto* gen) -> scalar_t {
+          return static_cast<scalar_t>(gen->random() % (static_cast<uint64_t>(std::numeric_limits<scalar_t>::max()) + 1));
         });
       }
     });
@@ -109,10 +211,9 @@ struct RandomKernel {
 template<typename RNG>
 void cauchy_kernel(TensorIterator& iter, double median, double sigma, RNG* generator) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "cauchy_cpu", [&]() {
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    cpu_serial_kernel(iter, [median, sigma, generator]() -> scalar_t {
+    cpu_random_kernel<scalar_t>(iter, generator, uniform_draws<double>(), [median, sigma](auto* gen) -> scalar_t {
       at::cauchy_distribution<double> cauchy(median, sigma);
-      return (scalar_t)cauchy(generator);
+      return (scalar_t)cauchy(gen);
     });
   });
 }
@@ -1,7 +1,12 @@
 #include <ATen/native/ScatterGatherShapeChecks.h>
 #include <ATen/native/ReduceOpsUtils.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/MemoryOverlap.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <cstring>
 
 namespace at { namespace native {
 
@@ -147,6 +152,152 @@ void cpu_scatter_gather_base_kernel(
   );
 }
 
+// Whether the elements of t after dim are laid out contiguously
+bool is_contiguous_after_dim(const Tensor& t, int64_t dim) {
+  int64_t expected_stride = 1;
+  for (int64_t d = t.dim() - 1; d > dim; --d) {
+    if (t.size(d) != 1) {
+      if (t.stride(d) != expected_stride) {
+        return false;
+      }
+      expected_stride *= t.size(d);
+    }
+  }
+  return true;
+}
+
+// Whether index is broadcast over the dimensions after dim, as in
+// index.unsqueeze(-1).expand(...) when gathering or scattering the rows of
+// node features, and self and src are contiguous after dim. The elements that
+// share an index then form contiguous rows of self and src. Bool and Half are
+// left to cpu_scatter_gather_base_kernel, as are a self and src sharing memory,
+// e.g. x.scatter_add_(0, idx.unsqueeze(-1).expand_as(x), x), since the tasks
+// of the rows kernel would read rows that other tasks are writing.
+bool can_use_rows_kernel(
+  const Tensor& self, int64_t dim,
+  const Tensor& index, const Tensor& src
+) {
+  int64_t ndim = index.dim();
+  auto dtype = self.scalar_type();
+  if (self.dim() != ndim || src.dim() != ndim || dim >= ndim - 1 ||
+      src.scalar_type() != dtype ||
+      !(isIntegralType(dtype, /*includeBool=*/false) ||
+        dtype == ScalarType::Float || dtype == ScalarType::Double)) {
+    return false;
+  }
+  for (int64_t d = dim + 1; d < ndim; ++d) {
+    if (index.size(d) != self.size(d) || index.size(d) != src.size(d) ||
+        (index.stride(d) != 0 && index.size(d) != 1)) {
+      return false;
+    }
+  }
+  return is_contiguous_after_dim(self, dim) && is_contiguous_after_dim(src, dim) &&
+      get_overlap_status(self, src) == MemOverlapStatus::NO;
+}
+
+// Gathers (is_gather) or scatters the rows selected by index, see
+// can_use_rows_kernel, calling f(out_row, in_row, n) on chunks of n elements
+// of the rows. `out` is written and `in` is read: for gather they are the
+// result and self, for scatter self and src.
+//
+// The work is split over the slices before dim and over chunks of the rows,
+// which never write the same elements. When that gives fewer tasks than
+// threads, the rows along dim are split as well: gather splits the index
+// positions, scatter splits the rows of `out`, every task scanning the whole
+// index and only writing the rows it owns, so that scatter_add needs no
+// atomics and adds in the same order as a serial loop.
+template <typename scalar_t, bool is_gather, typename func_t>
+void cpu_scatter_gather_rows_kernel(
+  const Tensor& out, const Tensor& in, int64_t dim,
+  const Tensor& index, int64_t indexed_dim_size,
+  const func_t& f
+) {
+  constexpr int64_t kChunkSize = 1024;
+
+  int64_t ndim = index.dim();
+  int64_t index_dim_size = index.size(dim);
+  int64_t row_size = 1;
+  for (int64_t d = dim + 1; d < ndim; ++d) {
+    row_size *= index.size(d);
+  }
+  int64_t outer_size = 1;
+  for (int64_t d = 0; d < dim; ++d) {
+    outer_size *= index.size(d);
+  }
+  int64_t num_chunks = (row_size + kChunkSize - 1) / kChunkSize;
+
+  int64_t split_size = is_gather ? index_dim_size : indexed_dim_size;
+  int64_t num_parts = 1;
+  if (outer_size * num_chunks < at::get_num_threads()) {
+    num_parts = std::min(
+      split_size,
+      (at::get_num_threads() + outer_size * num_chunks - 1) /
+        (outer_size * num_chunks));
+    num_parts = std::max<int64_t>(num_parts, 1);
+  }
+
+  auto* out_data = out.data_ptr<scalar_t>();
+  const auto* in_data = in.data_ptr<scalar_t>();
+  const auto* index_data = index.data_ptr<int64_t>();
+  auto out_dim_stride = out.stride(dim);
+  auto in_dim_stride = in.stride(dim);
+  auto index_dim_stride = index.stride(dim);
+
+  int64_t task_size = index_dim_size * std::min(row_size, kChunkSize);
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / task_size);
+  parallel_for(0, outer_size * num_chunks * num_parts, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; ++task) {
+      int64_t part = task % num_parts;
+      int64_t chunk = (task / num_parts) % num_chunks;
+      int64_t outer = task / (num_parts * num_chunks);
+
+      int64_t out_offset = 0, in_offset = 0, index_offset = 0;
+      for (int64_t d = dim - 1, rem = outer; d >= 0; --d) {
+        int64_t coord = rem % index.size(d);
+        rem /= index.size(d);
+        out_offset += coord * out.stride(d);
+        in_offset += coord * in.stride(d);
+        index_offset += coord * index.stride(d);
+      }
+      int64_t row_begin = chunk * kChunkSize;
+      int64_t n = std::min(kChunkSize, row_size - row_begin);
+      out_offset += row_begin;
+      in_offset += row_begin;
+
+      int64_t split_begin = split_size * part / num_parts;
+      int64_t split_end = split_size * (part + 1) / num_parts;
+      int64_t i_begin = is_gather ? split_begin : 0;
+      int64_t i_end = is_gather ? split_end : index_dim_size;
+      for (int64_t i = i_begin; i < i_end; ++i) {
+        int64_t idx_dim = index_data[index_offset + i * index_dim_stride];
+        TORCH_CHECK(idx_dim >= 0 && idx_dim < indexed_dim_size,
+                    "index ", index_data[index_offset + i * index_dim_stride], " is out of bounds for dimension ", dim,
+                    " with size ", indexed_dim_size);
+        if (is_gather) {
+          f(out_data + out_offset + i * out_dim_stride,
+            in_data + in_offset + idx_dim * in_dim_stride, n);
+        } else if (idx_dim >= split_begin && idx_dim < split_end) {
+          f(out_data + out_offset + idx_dim * out_dim_stride,
+            in_data + in_offset + i * in_dim_stride, n);
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void copy_row(scalar_t* out, const scalar_t* in, int64_t n) {
+  std::memmove(out, in, n * sizeof(scalar_t));
+}
+
+template <typename scalar_t>
+void add_row(scalar_t* out, const scalar_t* in, int64_t n) {
+  using Vec = vec256::Vec256<scalar_t>;
+  vec256::map2(
+    [](Vec x, Vec y) { return x + y; },
+    out, out, const_cast<scalar_t*>(in), n);
+}
+
 void gather_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
   if (index.numel() == 0) {
     return;
@@ -159,6 +310,14 @@ void gather_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim, const Te
   int64_t index_dim_size = ensure_nonempty_size(index, dim);
   int64_t self_dim_size = ensure_nonempty_size(self, dim);
 
+  if (can_use_rows_kernel(self, dim, index, result)) {
+    AT_DISPATCH_ALL_TYPES(self.scalar_type(), "gather_out_cpu", [&] {
+      cpu_scatter_gather_rows_kernel<scalar_t, /*is_gather=*/true>(
+        result, self, dim, index, self_dim_size, copy_row<scalar_t>);
+    });
+    return;
+  }
+
   cpu_scatter_gather_base_kernel(
     result, dim, index, self,
     "gather_out_cpu", [&] (
@@ -191,6 +350,15 @@ void scatter_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, const Te
   int64_t index_dim_size = ensure_nonempty_size(index, dim);
   int64_t self_dim_size = ensure_nonempty_size(self, dim);
 
+  if (can_use_rows_kernel(self, dim, index, src) &&
+      has_internal_overlap(self) == MemOverlap::NO) {
+    AT_DISPATCH_ALL_TYPES(self.scalar_type(), "scatter_cpu_", [&] {
+      cpu_scatter_gather_rows_kernel<scalar_t, /*is_gather=*/false>(
+        self, src, dim, index, self_dim_size, copy_row<scalar_t>);
+    });
+    return;
+  }
+
   cpu_scatter_gather_base_kernel(
     self, dim, index, src,
     "scatter_cpu_", [&] (
@@ -258,6 +426,18 @@ void scatter_add_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, cons
   int64_t index_dim_size = ensure_nonempty_size(index, dim);
   int64_t self_dim_size = ensure_nonempty_size(self, dim);
 
+  // Distinct elements of the iteration add to distinct elements of self,
+  // unless self overlaps itself
+  bool self_overlaps = has_internal_overlap(self) != MemOverlap::NO;
+
+  if (!self_overlaps && can_use_rows_kernel(self, dim, index, src)) {
+    AT_DISPATCH_ALL_TYPES(self.scalar_type(), "scatter_add_", [&] {
+      cpu_scatter_gather_rows_kernel<scalar_t, /*is_gather=*/false>(
+        self, src, dim, index, self_dim_size, add_row<scalar_t>);
+    });
+    return;
+  }
+
   cpu_scatter_gather_base_kernel(
     self, dim, index, src,
     "scatter_add_", [&] (
@@ -275,7 +455,7 @@ void scatter_add_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, cons
         self_data[idx_dim * self_dim_stride] += src_data[i * src_dim_stride];
       }
     },
-      /*serial_exec=*/true);
+      /*serial_exec=*/self_overlaps);
 }
 
 } // anonymous namespace
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <numeric>
 
 #include <ATen/Dispatch.h>
@@ -132,6 +133,168 @@ inline void _vec_softmax_lastdim(
       });
 }
 
+// Loads and stores the vectors _vec_softmax computes in
+template <typename scalar_t>
+struct vec_softmax_acc {
+  using Vec = vec256::Vec256<scalar_t>;
+  static Vec load(const scalar_t* data, int64_t count) {
+    return Vec::loadu(data, count);
+  }
+  static void store(const Vec& x, scalar_t* data, int64_t count) {
+    x.store(data, count);
+  }
+};
+
+// Vec256<BFloat16> rounds every result to BFloat16, so BFloat16 is computed
+// in float, as host_softmax does with acc_type
+template <>
+struct vec_softmax_acc<BFloat16> {
+  using Vec = vec256::Vec256<float>;
+  static Vec load(const BFloat16* data, int64_t count) {
+    float buf[Vec::size()];
+    for (int64_t k = 0; k < count; k++) {
+      buf[k] = static_cast<float>(data[k]);
+    }
+    return Vec::loadu(buf, count);
+  }
+  static void store(const Vec& x, BFloat16* data, int64_t count) {
+    float buf[Vec::size()];
+    x.store(buf, count);
+    for (int64_t k = 0; k < count; k++) {
+      data[k] = static_cast<BFloat16>(buf[k]);
+    }
+  }
+};
+
+// Softmax over a dimension other than the last: the inner dimensions are
+// contiguous, so Vec::size() neighbouring positions of the inner dimensions
+// are reduced together, with strided loads along dim.
+template <typename scalar_t, bool LogSoftMax>
+inline void _vec_softmax(
+    scalar_t* input_data_base,
+    scalar_t* output_data_base,
+    int64_t outer_size,
+    int64_t inner_size,
+    int64_t dim_size) {
+  using Acc = vec_softmax_acc<scalar_t>;
+  using Vec = typename Acc::Vec;
+  int64_t dim_stride = inner_size;
+  int64_t outer_stride = dim_size * dim_stride;
+  int64_t inner_chunks = (inner_size + Vec::size() - 1) / Vec::size();
+  int64_t grain_size =
+      internal::GRAIN_SIZE / (16 * dim_size * Vec::size());
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size * inner_chunks,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t outer_idx = i / inner_chunks;
+          int64_t inner_idx = (i % inner_chunks) * Vec::size();
+          int64_t count =
+              std::min<int64_t>(Vec::size(), inner_size - inner_idx);
+          scalar_t* input_data =
+              input_data_base + outer_idx * outer_stride + inner_idx;
+          scalar_t* output_data =
+              output_data_base + outer_idx * outer_stride + inner_idx;
+          Vec max_input = Acc::load(input_data, count);
+          for (int64_t d = 1; d < dim_size; d++) {
+            max_input = vec256::maximum(
+                max_input, Acc::load(input_data + d * dim_stride, count));
+          }
+          Vec tmp_sum(0);
+          for (int64_t d = 0; d < dim_size; d++) {
+            Vec z = (Acc::load(input_data + d * dim_stride, count) - max_input)
+                        .exp();
+            if (!LogSoftMax) {
+              Acc::store(z, output_data + d * dim_stride, count);
+            }
+            tmp_sum = tmp_sum + z;
+          }
+          if (LogSoftMax) {
+            tmp_sum = tmp_sum.log();
+            // same order of operations as _vec_log_softmax_lastdim
+            for (int64_t d = 0; d < dim_size; d++) {
+              Vec x = Acc::load(input_data + d * dim_stride, count);
+              Acc::store(
+                  x - max_input - tmp_sum, output_data + d * dim_stride, count);
+            }
+          } else {
+            tmp_sum = Vec(1) / tmp_sum;
+            for (int64_t d = 0; d < dim_size; d++) {
+              Vec z = Acc::load(output_data + d * dim_stride, count);
+              Acc::store(z * tmp_sum, output_data + d * dim_stride, count);
+            }
+          }
+        }
+      });
+}
+
+// softmax(mask ? value : input * scale) over the last dimension. The masked
+// and scaled row is written to the output, where it is normalized.
+template <typename scalar_t>
+inline void _vec_masked_softmax_lastdim(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& mask,
+    scalar_t scale,
+    scalar_t value) {
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t ndim = input.dim();
+  int64_t dim_size = input.size(ndim - 1);
+  int64_t outer_size = input.numel() / dim_size;
+  scalar_t* input_data_base = input.data_ptr<scalar_t>();
+  scalar_t* output_data_base = output.data_ptr<scalar_t>();
+  // mask is expanded to the input, so its strides may be 0
+  const bool* mask_data_base = mask.data_ptr<bool>();
+  auto mask_sizes = mask.sizes();
+  auto mask_strides = mask.strides();
+  int64_t mask_dim_stride = mask_strides[ndim - 1];
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          scalar_t* input_data = input_data_base + i * dim_size;
+          scalar_t* output_data = output_data_base + i * dim_size;
+          int64_t mask_offset = 0;
+          for (int64_t k = ndim - 2, idx = i; k >= 0; k--) {
+            mask_offset += (idx % mask_sizes[k]) * mask_strides[k];
+            idx /= mask_sizes[k];
+          }
+          const bool* mask_data = mask_data_base + mask_offset;
+          scalar_t max_input = -std::numeric_limits<scalar_t>::infinity();
+          for (int64_t d = 0; d < dim_size; d++) {
+            scalar_t y =
+                mask_data[d * mask_dim_stride] ? value : input_data[d] * scale;
+            output_data[d] = y;
+            max_input = std::max(max_input, y);
+          }
+          vec256::map(
+              [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
+              output_data,
+              output_data,
+              dim_size);
+          scalar_t tmp_sum = vec256::reduce_all<scalar_t>(
+              [](Vec x, Vec y) { return x + y; }, output_data, dim_size);
+          tmp_sum = 1 / tmp_sum;
+          vec256::map(
+              [tmp_sum](Vec x) { return x * Vec(tmp_sum); },
+              output_data,
+              output_data,
+              dim_size);
+        }
+      });
+}
+
 template <typename scalar_t, bool log_softmax>
 inline void _vec_host_softmax_backward_lastdim(
     scalar_t* grad_input_data_base,
@@ -203,6 +366,23 @@ struct vec_host_softmax_lastdim {
   }
 };
 
+template <typename scalar_t, bool LogSoftMax>
+struct vec_softmax {
+  static void apply(Tensor& output, const Tensor& input, int64_t dim) {
+    int64_t outer_size = 1;
+    int64_t dim_size = input.size(dim);
+    int64_t inner_size = 1;
+    for (int64_t i = 0; i < dim; ++i)
+      outer_size *= input.size(i);
+    for (int64_t i = dim + 1; i < input.dim(); ++i)
+      inner_size *= input.size(i);
+    scalar_t* input_data_base = input.data_ptr<scalar_t>();
+    scalar_t* output_data_base = output.data_ptr<scalar_t>();
+    _vec_softmax<scalar_t, LogSoftMax>(
+        input_data_base, output_data_base, outer_size, inner_size, dim_size);
+  }
+};
+
 template <typename scalar_t, bool LogSoftMax>
 struct vec_host_softmax_backward_lastdim {
   static void
@@ -261,6 +441,42 @@ static void log_softmax_backward_lastdim_kernel_impl(
       });
 }
 
+static void softmax_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    const int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_kernel_impl", [&] {
+    vec_softmax<scalar_t, false>::apply(result, self, dim);
+  });
+}
+
+static void log_softmax_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    const int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "log_softmax_kernel_impl",
+      [&] { vec_softmax<scalar_t, true>::apply(result, self, dim); });
+}
+
+static void masked_softmax_lastdim_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    const Tensor& mask,
+    double scale,
+    Scalar value) {
+  AT_DISPATCH_FLOATING_TYPES(
+      self.scalar_type(), "masked_softmax_lastdim_kernel_impl", [&] {
+        _vec_masked_softmax_lastdim<scalar_t>(
+            result,
+            self,
+            mask,
+            static_cast<scalar_t>(scale),
+            value.to<scalar_t>());
+      });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(softmax_lastdim_kernel, &softmax_lastdim_kernel_impl);
@@ -271,5 +487,10 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     log_softmax_backward_lastdim_kernel,
     &log_softmax_backward_lastdim_kernel_impl);
+REGISTER_DISPATCH(softmax_kernel, &softmax_kernel_impl);
+REGISTER_DISPATCH(log_softmax_kernel, &log_softmax_kernel_impl);
+REGISTER_DISPATCH(
+    masked_softmax_lastdim_kernel,
+    &masked_softmax_lastdim_kernel_impl);
 
 }} // namespace at::native
@@ -8,11 +8,18 @@ namespace native {
 
 using forward_fn = void(*)(Tensor &, const Tensor &);
 using backward_fn = void(*)(Tensor &, const Tensor &, const Tensor&);
+using forward_dim_fn = void(*)(Tensor &, const Tensor &, const int64_t);
+// output, input, mask expanded to the input, scale, value
+using masked_forward_fn =
+    void(*)(Tensor &, const Tensor &, const Tensor &, double, Scalar);
 
 DECLARE_DISPATCH(forward_fn, softmax_lastdim_kernel);
 DECLARE_DISPATCH(forward_fn, log_softmax_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, softmax_backward_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, log_softmax_backward_lastdim_kernel);
+DECLARE_DISPATCH(forward_dim_fn, softmax_kernel);
+DECLARE_DISPATCH(forward_dim_fn, log_softmax_kernel);
+DECLARE_DISPATCH(masked_forward_fn, masked_softmax_lastdim_kernel);
 
 }
 }
@@ -320,10 +320,9 @@ void bernoulli_mkl_kernel(Tensor &self, const double p, Generator* gen) {
 static void exponential_kernel(TensorIterator& iter, double lambda, Generator* gen) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "exponential_cpu", [&]() {
     CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    at::exponential_distribution<double> exponential(lambda);
-    cpu_serial_kernel(iter, [&exponential, generator]() -> scalar_t {
-      return static_cast<scalar_t>(exponential(generator));
+    templates::cpu::cpu_random_kernel<scalar_t>(iter, generator, templates::cpu::uniform_draws<double>(), [lambda](auto* rng) -> scalar_t {
+      at::exponential_distribution<double> exponential(lambda);
+      return static_cast<scalar_t>(exponential(rng));
     });
   });
 }
@@ -331,10 +330,9 @@ static void exponential_kernel(TensorIterator& iter, double lambda, Generator* g
 static void geometric_kernel(TensorIterator& iter, double p, Generator* gen) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "geometric_cpu", [&]() {
     CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    cpu_serial_kernel(iter, [p, generator]() -> scalar_t {
+    templates::cpu::cpu_random_kernel<scalar_t>(iter, generator, templates::cpu::uniform_draws<double>(), [p](auto* rng) -> scalar_t {
       at::geometric_distribution<double> geometric(p);
-      return (scalar_t)geometric(generator);
+      return (scalar_t)geometric(rng);
     });
   });
 }
@@ -342,10 +340,10 @@ static void geometric_kernel(TensorIterator& iter, double p, Generator* gen) {
 static void log_normal_kernel(TensorIterator& iter, double mean, double std, Generator* gen) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "log_normal_cpu", [&]() {
     CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    cpu_serial_kernel(iter, [mean, std, generator]() -> scalar_t {
+    // Two uniform samples per normal one, see Note [CPU Philox mode]
+    templates::cpu::cpu_random_kernel<scalar_t>(iter, generator, 2 * templates::cpu::uniform_draws<double>(), [mean, std](auto* rng) -> scalar_t {
       at::lognormal_distribution<double> logNormal(mean, std);
-      return (scalar_t)logNormal(generator);
+      return (scalar_t)logNormal(rng);
     });
   });
 }
@@ -441,6 +439,18 @@ void normal_fill(Tensor& self, const scalar_t mean, const scalar_t std, Generato
 }
 
 void normal_kernel(Tensor& self, double mean, double std, Generator* gen) {
+  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  if (generator->use_philox()) {
+    // See Note [CPU Philox mode]
+    auto iter = TensorIterator::nullary_op(self);
+    AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "normal_cpu", [&] {
+      templates::cpu::cpu_philox_kernel<scalar_t>(iter, generator, 2 * templates::cpu::uniform_draws<double>(), [mean, std](auto* rng) -> scalar_t {
+        at::normal_distribution<double> normal(mean, std);
+        return (scalar_t)normal(rng);
+      });
+    });
+    return;
+  }
   auto size = self.numel();
   if (self.scalar_type() == ScalarType::Float && size >= 16 && self.is_contiguous()) {
 #ifdef __AVX2__
@@ -465,6 +475,26 @@ void normal_kernel(Tensor& self, double mean, double std, Generator* gen) {
   }
 }
 
+static void uniform_kernel(TensorIterator& iter, double from, double to, Generator* gen) {
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "uniform_cpu", [&]() {
+    CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+    templates::cpu::cpu_random_kernel<scalar_t>(iter, generator, templates::cpu::uniform_draws<scalar_t>(), [from, to](auto* rng) -> scalar_t {
+      at::uniform_real_distribution<scalar_t> uniform(from, to);
+      return (scalar_t)uniform(rng);
+    });
+  });
+}
+
+static void bernoulli_scalar_kernel(TensorIterator& iter, double p, Generator* gen) {
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, iter.dtype(), "bernoulli_scalar_cpu_", [&] {
+    CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+    templates::cpu::cpu_random_kernel<scalar_t>(iter, generator, templates::cpu::uniform_draws<double>(), [p](auto* rng) -> scalar_t {
+      at::bernoulli_distribution<double> bernoulli(p);
+      return static_cast<scalar_t>(bernoulli(rng));
+    });
+  });
+}
+
 static void random_from_to_kernel(TensorIterator& iter, uint64_t range, int64_t base, Generator* gen) {
   CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
   templates::cpu::random_from_to_kernel(iter, range, base, generator);
@@ -563,6 +593,7 @@ static void rsqrt_kernel(TensorIterator& iter) {
 REGISTER_DISPATCH(rsqrt_stub, &rsqrt_kernel);
 REGISTER_DISPATCH(sigmoid_stub, &sigmoid_kernel);
 REGISTER_DISPATCH(bernoulli_mkl_stub, &bernoulli_mkl_kernel);
+REGISTER_DISPATCH(bernoulli_scalar_stub, &bernoulli_scalar_kernel);
 REGISTER_DISPATCH(cauchy_stub, &cauchy_kernel);
 REGISTER_DISPATCH(exponential_stub, &exponential_kernel);
 REGISTER_DISPATCH(geometric_stub, &geometric_kernel);
@@ -571,6 +602,7 @@ REGISTER_DISPATCH(normal_stub, &normal_kernel);
 REGISTER_DISPATCH(random_from_to_stub, &random_from_to_kernel);
 REGISTER_DISPATCH(random_full_64_bits_range_stub, &random_full_64_bits_range_kernel);
 REGISTER_DISPATCH(random_stub, &random_kernel);
+REGISTER_DISPATCH(uniform_stub, &uniform_kernel);
 REGISTER_DISPATCH(abs_stub, &abs_kernel);
 REGISTER_DISPATCH(angle_stub, &angle_kernel);
 REGISTER_DISPATCH(real_stub, &real_kernel);
@@ -82,6 +82,91 @@ void LayerNormKernelImpl(
   });
 }
 
+// The residual sum of a row is written to Y and normalized there while it
+// is still in cache, so that X and R are read once and Y written once.
+template <typename T>
+void AddLayerNormKernelImplInternal(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    T eps,
+    Tensor* Y) {
+  using Vec = vec256::Vec256<T>;
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK_EQ(R.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  T* X_data = X.data_ptr<T>();
+  T* R_data = R.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  T* Y_data = Y->data_ptr<T>();
+  const T c = T(1) / static_cast<T>(N);
+  const bool gamma_null = gamma_data == nullptr;
+  const bool beta_null = beta_data == nullptr;
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      T* Y_ptr = Y_data + i * N;
+      vec256::map2<T>(
+          [](Vec x, Vec r) { return x + r; },
+          Y_ptr,
+          X_data + i * N,
+          R_data + i * N,
+          N);
+      T mean_val = vec256::reduce_all<T>(
+          [](Vec& x, Vec& y) { return x + y; },
+          Y_ptr,
+          N);
+      T rstd_val = vec256::map_reduce_all<T>(
+          [](Vec x) { return x * x; },
+          [](Vec x, Vec y) { return x + y; },
+          Y_ptr,
+          N);
+      mean_val *= c;
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, T(0));
+      rstd_val = T(1) / std::sqrt(rstd_val + eps);
+      const T scale = rstd_val;
+      const T bias = -rstd_val * mean_val;
+      const Vec scale_vec(scale);
+      const Vec bias_vec(bias);
+      int64_t j = 0;
+      for (; j + Vec::size() <= N; j += Vec::size()) {
+        Vec y_vec = Vec::loadu(Y_ptr + j) * scale_vec + bias_vec;
+        if (!gamma_null) {
+          y_vec = y_vec * Vec::loadu(gamma_data + j);
+        }
+        if (!beta_null) {
+          y_vec = y_vec + Vec::loadu(beta_data + j);
+        }
+        y_vec.store(Y_ptr + j);
+      }
+      for (; j < N; ++j) {
+        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
+        const T beta_v = beta_null ? T(0) : beta_data[j];
+        Y_ptr[j] = (Y_ptr[j] * scale + bias) * gamma_v + beta_v;
+      }
+    }
+  });
+}
+
+void AddLayerNormKernelImpl(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    Tensor* Y) {
+  AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "AddLayerNormKernelImpl", [&]() {
+    AddLayerNormKernelImplInternal<scalar_t>(
+        X, R, gamma, beta, M, N, static_cast<scalar_t>(eps), Y);
+  });
+}
+
 template <typename T>
 void LayerNormBackwardKernelImplInternal(
     const Tensor& dY,
@@ -173,6 +258,7 @@ void LayerNormBackwardKernelImpl(
 
 REGISTER_DISPATCH(LayerNormKernel, &LayerNormKernelImpl);
 REGISTER_DISPATCH(LayerNormBackwardKernel, &LayerNormBackwardKernelImpl);
+REGISTER_DISPATCH(AddLayerNormKernel, &AddLayerNormKernelImpl);
 
 } // namespace native
 } // namespace at
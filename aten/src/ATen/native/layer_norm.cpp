@@ -60,13 +60,14 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
 
-Tensor layer_norm(
+namespace {
+
+// Returns M and N, the number of rows and their size
+std::tuple<int64_t, int64_t> _check_layer_norm_inputs(
     const Tensor& input,
     IntArrayRef normalized_shape,
     const Tensor& weight /* optional */,
-    const Tensor& bias /* optional */,
-    double eps,
-    bool /* cudnn_enable, deprecated */) {
+    const Tensor& bias /* optional */) {
   const int normalized_ndim = normalized_shape.size();
   TORCH_CHECK(
       normalized_ndim >= 1,
@@ -115,6 +116,21 @@ Tensor layer_norm(
       input_shape.cend(),
       1LL,
       std::multiplies<int64_t>());
+  return std::make_tuple(M, N);
+}
+
+} // namespace
+
+Tensor layer_norm(
+    const Tensor& input,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double eps,
+    bool /* cudnn_enable, deprecated */) {
+  int64_t M, N;
+  std::tie(M, N) =
+      _check_layer_norm_inputs(input, normalized_shape, weight, bias);
 
   const auto& X = input.is_contiguous() ? input : input.contiguous();
   const auto& gamma = weight.is_contiguous() ? weight : weight.contiguous();
@@ -122,8 +138,54 @@ Tensor layer_norm(
   return std::get<0>(at::native_layer_norm(X, gamma, beta, M, N, eps));
 }
 
+// layer_norm(input + residual) in a single pass over the rows on CPU. Only
+// meant for inference: it has no derivative of its own, so anything that
+// needs a gradient, or that the kernel does not handle, takes the unfused
+// path.
+Tensor _add_layer_norm(
+    const Tensor& input,
+    const Tensor& residual,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double eps) {
+  auto requires_grad = [](const Tensor& t) {
+    return t.defined() && t.requires_grad();
+  };
+  auto same_type = [&](const Tensor& t) {
+    return !t.defined() || t.scalar_type() == input.scalar_type();
+  };
+  const bool fused = input.device().type() == kCPU &&
+      residual.device().type() == kCPU &&
+      isFloatingType(input.scalar_type()) &&
+      input.scalar_type() != kHalf && input.scalar_type() != kBFloat16 &&
+      same_type(residual) && same_type(weight) && same_type(bias) &&
+      input.sizes().equals(residual.sizes()) &&
+      !(GradMode::is_enabled() &&
+        (requires_grad(input) || requires_grad(residual) ||
+         requires_grad(weight) || requires_grad(bias)));
+  if (!fused) {
+    return at::layer_norm(
+        input + residual, normalized_shape, weight, bias, eps);
+  }
+
+  int64_t M, N;
+  std::tie(M, N) =
+      _check_layer_norm_inputs(input, normalized_shape, weight, bias);
+  const auto& X = input.is_contiguous() ? input : input.contiguous();
+  const auto& R = residual.is_contiguous() ? residual : residual.contiguous();
+  const auto& gamma = weight.is_contiguous() ? weight : weight.contiguous();
+  const auto& beta = bias.is_contiguous() ? bias : bias.contiguous();
+  Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (M > 0) {
+    AddLayerNormKernel(kCPU, X, R, gamma, beta, M, N, eps, &Y);
+  }
+  return Y;
+}
+
 DEFINE_DISPATCH(LayerNormKernel);
 DEFINE_DISPATCH(LayerNormBackwardKernel);
+DEFINE_DISPATCH(AddLayerNormKernel);
 
 } // namespace native
 } // namespace at
@@ -29,8 +29,20 @@ using backward_fn = void (*)(
     Tensor* /* dgamma */,
     Tensor* /* dbeta */);
 
+// Y = layer_norm(X + R), without mean and rstd
+using add_forward_fn = void (*)(
+    const Tensor& /* X */,
+    const Tensor& /* R */,
+    const Tensor& /* gamma */,
+    const Tensor& /* beta */,
+    int64_t /* M */,
+    int64_t /* N */,
+    double /* eps */,
+    Tensor* /* Y */);
+
 DECLARE_DISPATCH(forward_fn, LayerNormKernel);
 DECLARE_DISPATCH(backward_fn, LayerNormBackwardKernel);
+DECLARE_DISPATCH(add_forward_fn, AddLayerNormKernel);
 
 } // namespace native
 } // namespace at
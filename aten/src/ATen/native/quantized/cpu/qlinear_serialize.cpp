@@ -0,0 +1,314 @@
+#include <ATen/ATen.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/cpp_custom_type_hack.h>
+#include <ATen/native/quantized/cpu/fbgemm_utils.h>
+#include <ATen/native/quantized/cpu/qnnpack_utils.h>
+
+#include <cpuinfo.h>
+#include <cstring>
+#include <vector>
+
+// Serialization of backend-prepacked linear weights.
+//
+// quantized::linear_prepack_serialize turns a packed weight into a uint8
+// tensor that can be stored next to the portable (unpacked) weight in a
+// TorchScript archive. quantized::linear_prepack_deserialize takes that blob
+// together with the portable weight and bias, and rebuilds the packed weight
+// from the blob when it was produced by the same engine on a CPU with the
+// same instruction set, skipping the work done by linear_prepack. For fbgemm
+// int8 weights that work is only partly skipped: fbgemm::PackBMatrix has no
+// way to adopt packed data, so the weight is still packed on load. Otherwise
+// (different engine or ISA, or a blob from an older format) it falls back to
+// a regular prepack of the portable weight, so archives stay loadable
+// everywhere.
+//
+// Blob layout (native endianness, the ISA tag guards against foreign hosts):
+//   uint32 magic, uint32 version, uint8 engine, uint8 kind, uint32 isa_tag,
+//   followed by a kind-specific payload.
+//
+// Only the fbgemm packed weights are serialized. QNNPACK packs lazily on the
+// first call because the packing depends on the input scale, so its blob is
+// empty and always takes the fallback path.
+
+namespace at {
+namespace native {
+namespace {
+
+constexpr uint32_t kPackedWeightMagic = 0x51504b57; // "QPKW"
+constexpr uint32_t kPackedWeightVersion = 1;
+
+enum class PackedWeightKind : uint8_t {
+  Int8 = 0,
+  Fp16 = 1,
+};
+
+// Bitmask of the instruction set extensions that influence the packed
+// layouts chosen by the backends.
+uint32_t isa_tag() {
+  uint32_t tag = 0;
+#if !defined(__powerpc__) && !defined(__s390x__)
+  if (cpuinfo_initialize()) {
+    tag |= cpuinfo_has_x86_avx2() ? 1u << 0 : 0;
+    tag |= cpuinfo_has_x86_fma3() ? 1u << 1 : 0;
+    tag |= cpuinfo_has_x86_avx512f() ? 1u << 2 : 0;
+    tag |= cpuinfo_has_x86_avx512bw() ? 1u << 3 : 0;
+    tag |= cpuinfo_has_x86_avx512dq() ? 1u << 4 : 0;
+    tag |= cpuinfo_has_x86_avx512vl() ? 1u << 5 : 0;
+  }
+#endif
+  return tag;
+}
+
+class BlobWriter {
+ public:
+  template <typename T>
+  void write(const T& value) {
+    write(&value, 1);
+  }
+
+  template <typename T>
+  void write(const T* data, size_t n) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + n * sizeof(T));
+  }
+
+  template <typename T>
+  void writeVector(const std::vector<T>& v) {
+    write<uint64_t>(v.size());
+    write(v.data(), v.size());
+  }
+
+  Tensor toTensor() const {
+    auto blob = at::empty({static_cast<int64_t>(buffer_.size())}, at::kByte);
+    std::memcpy(blob.data_ptr<uint8_t>(), buffer_.data(), buffer_.size());
+    return blob;
+  }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+class BlobReader {
+ public:
+  explicit BlobReader(const Tensor& blob)
+      : data_(blob.data_ptr<uint8_t>()), size_(blob.numel()), pos_(0) {}
+
+  template <typename T>
+  T read() {
+    T value;
+    read(&value, 1);
+    return value;
+  }
+
+  template <typename T>
+  void read(T* data, size_t n) {
+    checkAvailable<T>(n);
+    std::memcpy(data, data_ + pos_, n * sizeof(T));
+    pos_ += n * sizeof(T);
+  }
+
+  template <typename T>
+  std::vector<T> readVector() {
+    const auto n = read<uint64_t>();
+    // checked before allocating, the size comes from the blob
+    checkAvailable<T>(n);
+    std::vector<T> v(n);
+    read(v.data(), v.size());
+    return v;
+  }
+
+  // Throws unless n more elements of type T are left in the blob
+  template <typename T>
+  void checkAvailable(uint64_t n) const {
+    TORCH_CHECK(
+        n <= (size_ - pos_) / sizeof(T),
+        "quantized::linear_prepack_deserialize: truncated packed weight");
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_;
+};
+
+void writeHeader(BlobWriter& writer, QEngine engine, PackedWeightKind kind) {
+  writer.write(kPackedWeightMagic);
+  writer.write(kPackedWeightVersion);
+  writer.write(static_cast<uint8_t>(engine));
+  writer.write(static_cast<uint8_t>(kind));
+  writer.write(isa_tag());
+}
+
+// Returns whether the blob was produced for the current engine and CPU, with
+// the given kind of packed weight.
+bool readHeader(BlobReader& reader, const Tensor& blob, PackedWeightKind kind) {
+  constexpr size_t kHeaderSize = 2 * sizeof(uint32_t) + 2 * sizeof(uint8_t) + sizeof(uint32_t);
+  if (blob.numel() < static_cast<int64_t>(kHeaderSize)) {
+    return false;
+  }
+  if (reader.read<uint32_t>() != kPackedWeightMagic ||
+      reader.read<uint32_t>() != kPackedWeightVersion) {
+    return false;
+  }
+  auto engine = static_cast<QEngine>(reader.read<uint8_t>());
+  auto blob_kind = static_cast<PackedWeightKind>(reader.read<uint8_t>());
+  auto tag = reader.read<uint32_t>();
+  return engine == at::globalContext().qEngine() && blob_kind == kind &&
+      tag == isa_tag();
+}
+
+class QLinearSerializePackedWeight final : public c10::OperatorKernel {
+ public:
+  at::Tensor operator()(at::Tensor packed_weight) {
+    BlobWriter writer;
+#ifdef USE_FBGEMM
+    if (cpp_custom_type_hack::isa<PackedLinearWeight>(packed_weight)) {
+      auto& pack_ptr =
+          cpp_custom_type_hack::cast<PackedLinearWeight>(packed_weight);
+      writeHeader(writer, QEngine::FBGEMM, PackedWeightKind::Int8);
+      writer.write<int64_t>(pack_ptr.w->numRows());
+      writer.write<int64_t>(pack_ptr.w->numCols());
+      writer.write<uint8_t>(static_cast<uint8_t>(pack_ptr.q_scheme));
+      writer.writeVector(pack_ptr.w_scale);
+      writer.writeVector(pack_ptr.w_zp);
+      writer.writeVector(pack_ptr.col_offsets);
+      return writer.toTensor();
+    }
+    if (cpp_custom_type_hack::isa<PackedLinearWeightFp16>(packed_weight)) {
+      auto& pack_ptr =
+          cpp_custom_type_hack::cast<PackedLinearWeightFp16>(packed_weight);
+      auto& w = *pack_ptr.w;
+      writeHeader(writer, QEngine::FBGEMM, PackedWeightKind::Fp16);
+      writer.write<int32_t>(w.numRows());
+      writer.write<int32_t>(w.numCols());
+      writer.write<int32_t>(w.blockRowSize());
+      writer.write<int32_t>(w.lastBrow());
+      writer.write<int32_t>(w.blockColSize());
+      writer.write<int32_t>(w.numBrow());
+      writer.write<int32_t>(w.numBcol());
+      writer.write<uint64_t>(w.matSize());
+      writer.write(w.pmat(), w.matSize());
+      return writer.toTensor();
+    }
+#endif // USE_FBGEMM
+    // Nothing to serialize (e.g. QNNPACK packs on the first call); the
+    // deserializer falls back to prepacking the portable weight.
+    return writer.toTensor();
+  }
+};
+
+class QLinearDeserializePackedWeight final : public c10::OperatorKernel {
+ public:
+#ifdef USE_FBGEMM
+  at::Tensor fbgemm_linear_deserialize_int8(
+      BlobReader& reader,
+      at::Tensor weight,
+      c10::optional<Tensor> bias) {
+    const int64_t K = reader.read<int64_t>();
+    const int64_t N = reader.read<int64_t>();
+    const auto qtype = static_cast<c10::QScheme>(reader.read<uint8_t>());
+    auto w_scale = reader.readVector<float>();
+    auto w_zp = reader.readVector<int32_t>();
+    auto col_offsets = reader.readVector<int32_t>();
+    TORCH_CHECK(
+        weight.dim() == 2 && weight.size(0) == N && weight.size(1) == K &&
+            weight.qscheme() == qtype &&
+            static_cast<int64_t>(col_offsets.size()) == N,
+        "quantized::linear_prepack_deserialize: packed weight does not match"
+        " the weight tensor");
+
+    // fbgemm::PackBMatrix can only be built from the unpacked matrix, so the
+    // packing itself still runs; the quantization parameters and column
+    // offsets come from the blob instead of being recomputed per channel.
+    auto weight_contig = weight.contiguous();
+    int8_t* weight_ptr_int8 =
+        reinterpret_cast<int8_t*>(weight_contig.data_ptr<c10::qint8>());
+    c10::optional<at::Tensor> bias_contig;
+    if (bias.has_value()) {
+      bias_contig = bias->contiguous();
+    }
+    auto ret_ptr = std::make_unique<PackedLinearWeight>(PackedLinearWeight{
+        std::make_unique<fbgemm::PackBMatrix<int8_t>>(
+            /*trans=*/fbgemm::matrix_op_t::Transpose,
+            /*nRow=*/K,
+            /*nCol=*/N,
+            /*smat=*/weight_ptr_int8,
+            /*ld=*/K,
+            /*pmat=*/nullptr, // PackBMatrix manages ownership of pmat
+            /*groups=*/1),
+        bias_contig,
+        std::move(col_offsets),
+        std::move(w_scale),
+        std::move(w_zp),
+        qtype});
+    return cpp_custom_type_hack::create(std::move(ret_ptr), weight.options());
+  }
+
+  at::Tensor fbgemm_linear_deserialize_fp16(
+      BlobReader& reader,
+      at::Tensor weight,
+      c10::optional<Tensor> bias) {
+    const int nrow = reader.read<int32_t>();
+    const int ncol = reader.read<int32_t>();
+    const int brow = reader.read<int32_t>();
+    const int last_brow = reader.read<int32_t>();
+    const int bcol = reader.read<int32_t>();
+    const int nbrow = reader.read<int32_t>();
+    const int nbcol = reader.read<int32_t>();
+    const uint64_t size = reader.read<uint64_t>();
+    reader.checkAvailable<fbgemm::float16>(size);
+    TORCH_CHECK(
+        weight.dim() == 2 && weight.size(0) == ncol && weight.size(1) == nrow,
+        "quantized::linear_prepack_deserialize: packed weight does not match"
+        " the weight tensor");
+
+    // The packed matrix is copied in as is, without converting or packing
+    // the fp32 weight again.
+    auto packed = std::make_unique<fbgemm::PackedGemmMatrixFP16>(
+        nrow, ncol, brow, last_brow, bcol, nbrow, nbcol, size);
+    reader.read(packed->pmat(), size);
+    auto ptr = std::make_unique<PackedLinearWeightFp16>(
+        PackedLinearWeightFp16{std::move(packed), bias});
+    return cpp_custom_type_hack::create(std::move(ptr), weight.options());
+  }
+#endif // USE_FBGEMM
+
+  at::Tensor operator()(
+      at::Tensor packed,
+      at::Tensor weight,
+      c10::optional<Tensor> bias) {
+    const bool is_fp16 = weight.scalar_type() == at::kFloat;
+    auto blob = packed.contiguous();
+#ifdef USE_FBGEMM
+    BlobReader reader(blob);
+    if (readHeader(
+            reader,
+            blob,
+            is_fp16 ? PackedWeightKind::Fp16 : PackedWeightKind::Int8)) {
+      return is_fp16 ? fbgemm_linear_deserialize_fp16(reader, weight, bias)
+                     : fbgemm_linear_deserialize_int8(reader, weight, bias);
+    }
+#endif // USE_FBGEMM
+    static const auto prepack = c10::Dispatcher::singleton().findSchemaOrThrow(
+        "quantized::linear_prepack", "");
+    static const auto prepack_fp16 =
+        c10::Dispatcher::singleton().findSchemaOrThrow(
+            "quantized::linear_prepack_fp16", "");
+    return (is_fp16 ? prepack_fp16 : prepack)
+        .callUnboxed<at::Tensor, at::Tensor, c10::optional<Tensor>>(
+            weight, bias);
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::linear_prepack_serialize(Tensor W_prepack) -> Tensor",
+            c10::RegisterOperators::options()
+                .catchAllKernel<QLinearSerializePackedWeight>())
+        .op("quantized::linear_prepack_deserialize(Tensor packed, Tensor W, Tensor? B=None) -> Tensor W_prepack",
+            c10::RegisterOperators::options()
+                .catchAllKernel<QLinearDeserializePackedWeight>());
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Utils.h>
 #include <ATen/CPUGenerator.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/PhiloxRNGEngine.h>
 #include <thread>
 #include <limits>
@@ -120,6 +121,36 @@ TEST(CPUGenerator, TestRNGForking) {
   ASSERT_EQ(target_value.sum().item<double>(), forked_value.sum().item<double>());
 }
 
+TEST(CPUGenerator, TestPhiloxModeThreadIndependence) {
+  // Test Description:
+  //   Tests that in Philox mode the distribution kernels give the same
+  //   values for any number of threads, and that every call moves the
+  //   offset of the generator past the values it used.
+  // See Note [CPU Philox mode]
+  auto gen = at::detail::createCPUGenerator(123);
+  gen->set_use_philox(true);
+  auto num_threads = at::get_num_threads();
+
+  at::set_num_threads(1);
+  gen->set_current_seed(123);
+  auto uniform1 = at::empty({100000}).uniform_(0, 1, gen.get());
+  auto normal1 = at::empty({100000}, at::kDouble).normal_(0, 1, gen.get());
+  auto offset = gen->philox_offset();
+  ASSERT_GT(offset, 0);
+
+  at::set_num_threads(4);
+  gen->set_current_seed(123);
+  ASSERT_EQ(gen->philox_offset(), 0);
+  auto uniform2 = at::empty({100000}).uniform_(0, 1, gen.get());
+  auto normal2 = at::empty({100000}, at::kDouble).normal_(0, 1, gen.get());
+  ASSERT_EQ(gen->philox_offset(), offset);
+  at::set_num_threads(num_threads);
+
+  ASSERT_TRUE(uniform1.equal(uniform2));
+  ASSERT_TRUE(normal1.equal(normal2));
+  ASSERT_FALSE(uniform1.slice(0, 0, 50000).equal(uniform1.slice(0, 50000)));
+}
+
 /** 
  * Philox CPU Engine Tests
  */
@@ -0,0 +1,71 @@
+#include "benchmark/benchmark.h"
+
+#include <torch/data.h>
+
+#include <numeric>
+
+// Measures how fast ChunkDataset can hand out batches when several preloaders
+// feed one shared batch buffer versus one buffer shard per preloader, with
+// and without the cross-chunk shuffle buffer. Chunks are cheap to produce so
+// that the numbers are dominated by the batch buffer itself.
+
+namespace {
+
+using namespace torch::data;
+
+constexpr size_t kChunkCount = 256;
+constexpr size_t kChunkSize = 1024;
+constexpr size_t kBatchSize = 32;
+
+struct SyntheticChunkReader : public datasets::ChunkDataReader<int> {
+  ChunkType read_chunk(size_t chunk_index) override {
+    ChunkType chunk(kChunkSize);
+    std::iota(chunk.begin(), chunk.end(), chunk_index * kChunkSize);
+    return chunk;
+  }
+
+  size_t chunk_count() override {
+    return kChunkCount;
+  }
+
+  void reset() override {}
+};
+
+using Dataset = datasets::ChunkDataset<
+    SyntheticChunkReader,
+    samplers::RandomSampler,
+    samplers::RandomSampler>;
+
+// Args: preloader count, buffer shard count, shuffle buffer size.
+static void BM_ChunkDatasetEpoch(benchmark::State& state) {
+  const size_t preloader_count = state.range(0);
+  Dataset dataset(
+      SyntheticChunkReader(),
+      samplers::RandomSampler(0),
+      samplers::RandomSampler(0),
+      datasets::ChunkDatasetOptions(preloader_count, kBatchSize, 8192)
+          .buffer_shard_count(state.range(1))
+          .shuffle_buffer_size(state.range(2)));
+
+  size_t example_count = 0;
+  while (state.KeepRunning()) {
+    dataset.reset();
+    while (auto batch = dataset.get_batch(kBatchSize)) {
+      example_count += batch->size();
+    }
+  }
+  state.SetItemsProcessed(example_count);
+}
+BENCHMARK(BM_ChunkDatasetEpoch)
+    ->Args({1, 1, 0})
+    ->Args({4, 1, 0})
+    ->Args({4, 4, 0})
+    ->Args({8, 1, 0})
+    ->Args({8, 8, 0})
+    ->Args({8, 8, 4096})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
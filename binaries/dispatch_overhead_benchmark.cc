@@ -0,0 +1,66 @@
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+// Measures the cost of going through the c10 dispatcher for ops whose
+// kernels do (almost) no work, so that the numbers are dominated by
+// dispatch key extraction and the kernel lookup.
+
+namespace {
+
+at::Tensor identity_kernel(const at::Tensor& self) {
+  return self;
+}
+
+static auto registry = c10::RegisterOperators()
+    .op("_bench::cpu_kernel(Tensor self) -> Tensor",
+        c10::RegisterOperators::options()
+            .kernel<decltype(identity_kernel), &identity_kernel>(c10::DispatchKey::CPUTensorId))
+    .op("_bench::catchall_kernel(Tensor self) -> Tensor",
+        c10::RegisterOperators::options()
+            .catchAllKernel<decltype(identity_kernel), &identity_kernel>());
+
+void callUnboxed(benchmark::State& state, const char* name) {
+  auto op = c10::Dispatcher::singleton().findSchemaOrThrow(name, "");
+  at::Tensor input = at::ones({1});
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(op.callUnboxed<at::Tensor, const at::Tensor&>(input));
+  }
+}
+
+static void BM_CallUnboxedCPUKernel(benchmark::State& state) {
+  callUnboxed(state, "_bench::cpu_kernel");
+}
+BENCHMARK(BM_CallUnboxedCPUKernel);
+
+static void BM_CallUnboxedCatchallKernel(benchmark::State& state) {
+  callUnboxed(state, "_bench::catchall_kernel");
+}
+BENCHMARK(BM_CallUnboxedCatchallKernel);
+
+static void BM_CallBoxedCPUKernel(benchmark::State& state) {
+  auto op = c10::Dispatcher::singleton().findSchemaOrThrow("_bench::cpu_kernel", "");
+  at::Tensor input = at::ones({1});
+  torch::jit::Stack stack;
+  while (state.KeepRunning()) {
+    stack.emplace_back(input);
+    op.callBoxed(&stack);
+    stack.clear();
+  }
+}
+BENCHMARK(BM_CallBoxedCPUKernel);
+
+// End-to-end cost of a small dense CPU op, for comparison with the above.
+static void BM_AddSmallTensor(benchmark::State& state) {
+  at::Tensor a = at::ones({1});
+  at::Tensor b = at::ones({1});
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::add(a, b));
+  }
+}
+BENCHMARK(BM_AddSmallTensor);
+
+} // namespace
+
+BENCHMARK_MAIN();
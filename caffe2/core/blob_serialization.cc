@@ -1,11 +1,16 @@
 #include "caffe2/core/blob_serialization.h"
 
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <sstream>
 #include <mutex>
 
 #include "caffe2/core/blob.h"
 #include "caffe2/utils/proto_utils.h"
 
+#include "miniz.h"
+
 C10_DEFINE_int(
     caffe2_tensor_chunk_size,
     1000000,
@@ -21,6 +26,24 @@ C10_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+C10_DEFINE_bool(
+    caffe2_serialize_using_raw_bytes,
+    false,
+    "Serialize tensors of fundamental types as raw little-endian bytes in the "
+    "raw_data field instead of element by element in the typed fields");
+
+C10_DEFINE_int(
+    caffe2_serialize_raw_bytes_compression_level,
+    0,
+    "zlib compression level (1-9) of tensors serialized as raw bytes. "
+    "0 disables compression");
+
+C10_DEFINE_int(
+    caffe2_serialize_raw_bytes_block_size,
+    1 << 20,
+    "Size in bytes of the blocks compressed independently (and in parallel) "
+    "when compressing tensors serialized as raw bytes");
+
 namespace caffe2 {
 /**
  * @brief StringSerializer is the serializer for String.
@@ -89,6 +112,156 @@ SerializeBlob(const void* pointer, TypeMeta typeMeta, const string& name) {
 }
 } // namespace
 
+namespace {
+// Runs fn(0), ..., fn(n - 1), spreading the calls over up to
+// caffe2_max_tensor_serializer_threads threads.
+void ParallelForBlocks(size_t n, const std::function<void(size_t)>& fn) {
+#ifndef __ANDROID__
+  const size_t num_threads = std::min<size_t>(
+      n, std::max(FLAGS_caffe2_max_tensor_serializer_threads, 1));
+  if (num_threads > 1) {
+    std::atomic<size_t> next{0};
+    auto task = [&]() {
+      for (size_t i = next++; i < n; i = next++) {
+        fn(i);
+      }
+    };
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+      futures.emplace_back(std::async(std::launch::async, task));
+    }
+    task();
+    for (auto& fut : futures) {
+      fut.get();
+    }
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; ++i) {
+    fn(i);
+  }
+}
+
+bool IsLittleEndian() {
+  const int kValue = 1;
+  return reinterpret_cast<const char*>(&kValue)[0] == 1;
+}
+
+// Whether tensors of this type can be stored as raw bytes, i.e. the type is
+// fundamental and has the same representation in memory and on disk.
+bool SupportsRawBytes(TensorProto::DataType data_type) {
+  switch (data_type) {
+    case TensorProto_DataType_FLOAT:
+    case TensorProto_DataType_INT32:
+    case TensorProto_DataType_BOOL:
+    case TensorProto_DataType_UINT8:
+    case TensorProto_DataType_INT8:
+    case TensorProto_DataType_UINT16:
+    case TensorProto_DataType_INT16:
+    case TensorProto_DataType_INT64:
+    case TensorProto_DataType_FLOAT16:
+    case TensorProto_DataType_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Stores `nbytes` bytes at `data` into proto.raw_data, compressing them block
+// by block if requested.
+void StoreRawBytes(
+    const char* data,
+    size_t nbytes,
+    int compression_level,
+    TensorProto* proto) {
+  proto->set_storage_type(TensorProto_StorageType_RAW);
+  if (compression_level <= 0 || nbytes == 0) {
+    proto->set_raw_data(data, nbytes);
+    return;
+  }
+
+  const size_t block_bytes =
+      std::max(FLAGS_caffe2_serialize_raw_bytes_block_size, 1);
+  const size_t num_blocks = (nbytes + block_bytes - 1) / block_bytes;
+  std::vector<std::string> blocks(num_blocks);
+  ParallelForBlocks(num_blocks, [&](size_t b) {
+    const size_t begin = b * block_bytes;
+    const size_t size = std::min(block_bytes, nbytes - begin);
+    auto& block = blocks[b];
+    mz_ulong compressed_size = mz_compressBound(size);
+    block.resize(compressed_size);
+    CAFFE_ENFORCE_EQ(
+        mz_compress2(
+            reinterpret_cast<unsigned char*>(&block[0]),
+            &compressed_size,
+            reinterpret_cast<const unsigned char*>(data + begin),
+            size,
+            std::min(compression_level, 9)),
+        MZ_OK,
+        "Failed to compress tensor data");
+    block.resize(compressed_size);
+  });
+
+  proto->set_raw_data_compression(TensorProto_Compression_ZLIB);
+  proto->set_raw_data_block_bytes(block_bytes);
+  size_t total_size = 0;
+  for (const auto& block : blocks) {
+    proto->add_raw_data_compressed_block_sizes(block.size());
+    total_size += block.size();
+  }
+  std::string* raw_data = proto->mutable_raw_data();
+  raw_data->reserve(total_size);
+  for (auto& block : blocks) {
+    raw_data->append(block);
+    std::string().swap(block);
+  }
+}
+
+// Copies the `nbytes` bytes stored in proto.raw_data to `dst`, decompressing
+// the blocks in parallel if they are compressed.
+void LoadRawBytes(const TensorProto& proto, size_t nbytes, char* dst) {
+  const std::string& raw_data = proto.raw_data();
+  if (proto.raw_data_compression() == TensorProto_Compression_NO_COMPRESSION) {
+    CAFFE_ENFORCE_EQ(nbytes, raw_data.size(), "Incorrect proto field size.");
+    std::memcpy(dst, raw_data.data(), nbytes);
+    return;
+  }
+  CAFFE_ENFORCE_EQ(
+      proto.raw_data_compression(),
+      TensorProto_Compression_ZLIB,
+      "Unknown compression of raw tensor data.");
+
+  const size_t block_bytes = proto.raw_data_block_bytes();
+  const size_t num_blocks = proto.raw_data_compressed_block_sizes_size();
+  CAFFE_ENFORCE(
+      block_bytes > 0 && num_blocks == (nbytes + block_bytes - 1) / block_bytes,
+      "Inconsistent compressed blocks in raw tensor data.");
+  std::vector<size_t> offsets(num_blocks + 1, 0);
+  for (size_t b = 0; b < num_blocks; ++b) {
+    offsets[b + 1] = offsets[b] + proto.raw_data_compressed_block_sizes(b);
+  }
+  CAFFE_ENFORCE_EQ(
+      offsets.back(), raw_data.size(), "Incorrect proto field size.");
+
+  ParallelForBlocks(num_blocks, [&](size_t b) {
+    const size_t begin = b * block_bytes;
+    const size_t size = std::min(block_bytes, nbytes - begin);
+    mz_ulong uncompressed_size = size;
+    CAFFE_ENFORCE_EQ(
+        mz_uncompress(
+            reinterpret_cast<unsigned char*>(dst + begin),
+            &uncompressed_size,
+            reinterpret_cast<const unsigned char*>(
+                raw_data.data() + offsets[b]),
+            offsets[b + 1] - offsets[b]),
+        MZ_OK,
+        "Failed to decompress tensor data");
+    CAFFE_ENFORCE_EQ(uncompressed_size, size, "Incorrect proto field size.");
+  });
+}
+} // namespace
+
 void SerializeBlob(
     const Blob& blob,
     const string& name,
@@ -226,6 +399,32 @@ void TensorSerializer::Serialize(
   // TODO: use CUDAGuard here instead of context and employ explicit sync
   // copy
   auto uniq_ptr = CreateContext(input.GetDevice());
+  if (FLAGS_caffe2_serialize_using_raw_bytes && SupportsRawBytes(data_type)) {
+    CAFFE_ENFORCE(
+        IsLittleEndian(),
+        "Serialization as raw bytes on big endian platform "
+        "is not written yet.");
+    const size_t nbytes = chunkSize * input.itemsize();
+    const char* data = static_cast<const char*>(input.raw_data()) +
+        chunkBegin * input.itemsize();
+    if (input.GetDeviceType() == CPU) {
+      StoreRawBytes(
+          data,
+          nbytes,
+          FLAGS_caffe2_serialize_raw_bytes_compression_level,
+          &proto);
+    } else {
+      std::unique_ptr<char[]> buffer(new char[nbytes]);
+      uniq_ptr->CopyBytesToCPU(nbytes, data, buffer.get());
+      uniq_ptr->FinishDeviceComputation();
+      StoreRawBytes(
+          buffer.get(),
+          nbytes,
+          FLAGS_caffe2_serialize_raw_bytes_compression_level,
+          &proto);
+    }
+    return;
+  }
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
@@ -511,6 +710,29 @@ void TensorDeserializer::DeserializeToTensor(
       tensor->numel());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (tensor_proto.storage_type() == TensorProto_StorageType_RAW) {
+    CAFFE_ENFORCE(
+        SupportsRawBytes(tensor_proto.data_type()),
+        "Raw storage is not supported for tensors of type ",
+        tensor->dtype().name());
+    CAFFE_ENFORCE(
+        IsLittleEndian(),
+        "Deserialization of raw bytes on big endian platform "
+        "is not written yet.");
+    const size_t nbytes = chunkSize * tensor->itemsize();
+    char* dst = static_cast<char*>(tensor->raw_mutable_data(tensor->dtype())) +
+        chunkBegin * tensor->itemsize();
+    if (tensor->GetDeviceType() == CPU) {
+      LoadRawBytes(tensor_proto, nbytes, dst);
+    } else {
+      std::unique_ptr<char[]> buffer(new char[nbytes]);
+      LoadRawBytes(tensor_proto, nbytes, buffer.get());
+      context->CopyBytesFromCPU(nbytes, buffer.get(), dst);
+      context->FinishDeviceComputation();
+    }
+    return;
+  }
+
   switch (tensor_proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
@@ -20,6 +20,9 @@
 
 C10_DEFINE_int64(caffe2_test_big_tensor_size, 100000000, "");
 C10_DECLARE_int(caffe2_tensor_chunk_size);
+C10_DECLARE_bool(caffe2_serialize_using_raw_bytes);
+C10_DECLARE_int(caffe2_serialize_raw_bytes_compression_level);
+C10_DECLARE_int(caffe2_serialize_raw_bytes_block_size);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
 
 namespace caffe2 {
@@ -733,6 +736,70 @@ TEST(TensorTest, Half) {
   }
 }
 
+TEST(TensorTest, TensorSerializationRawBytes) {
+  const int64_t kSize = 100000;
+  const int kChunkSize = 30000;
+  Blob blob;
+  TensorCPU* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    tensor->mutable_data<float>()[i] = i % 1000;
+  }
+
+  const bool old_raw_bytes = FLAGS_caffe2_serialize_using_raw_bytes;
+  const int old_level = FLAGS_caffe2_serialize_raw_bytes_compression_level;
+  const int old_block_size = FLAGS_caffe2_serialize_raw_bytes_block_size;
+  FLAGS_caffe2_serialize_using_raw_bytes = true;
+  // Several blocks per chunk, the last one shorter.
+  FLAGS_caffe2_serialize_raw_bytes_block_size = 7000 * sizeof(float);
+  for (int level : {0, 6}) {
+    FLAGS_caffe2_serialize_raw_bytes_compression_level = level;
+    std::mutex mutex;
+    std::vector<std::string> chunks;
+    auto acceptor = [&](const std::string& /*key*/, const std::string& value) {
+      std::lock_guard<std::mutex> guard(mutex);
+      chunks.push_back(value);
+    };
+    SerializeBlob(blob, "test", acceptor, kChunkSize);
+    EXPECT_EQ(chunks.size(), 4);
+
+    Blob new_blob;
+    for (const auto& chunk : chunks) {
+      BlobProto proto;
+      CHECK(proto.ParseFromString(chunk));
+      const TensorProto& tensor_proto = proto.tensor();
+      EXPECT_EQ(tensor_proto.storage_type(), TensorProto_StorageType_RAW);
+      EXPECT_EQ(tensor_proto.float_data_size(), 0);
+      const auto chunk_bytes = sizeof(float) *
+          (tensor_proto.segment().end() - tensor_proto.segment().begin());
+      if (level == 0) {
+        EXPECT_EQ(tensor_proto.raw_data().size(), chunk_bytes);
+      } else {
+        EXPECT_EQ(
+            tensor_proto.raw_data_compression(), TensorProto_Compression_ZLIB);
+        EXPECT_LT(tensor_proto.raw_data().size(), chunk_bytes);
+      }
+      EXPECT_NO_THROW(DeserializeBlob(chunk, &new_blob));
+    }
+    const TensorCPU& new_tensor = new_blob.Get<TensorCPU>();
+    EXPECT_EQ(new_tensor.numel(), kSize);
+    for (int i = 0; i < kSize; ++i) {
+      EXPECT_EQ(new_tensor.data<float>()[i], i % 1000);
+    }
+  }
+  FLAGS_caffe2_serialize_using_raw_bytes = old_raw_bytes;
+  FLAGS_caffe2_serialize_raw_bytes_compression_level = old_level;
+  FLAGS_caffe2_serialize_raw_bytes_block_size = old_block_size;
+
+  // With the flag off, tensors go back to the typed fields.
+  BlobProto typed_proto;
+  CHECK(typed_proto.ParseFromString(SerializeBlob(blob, "test")));
+  EXPECT_EQ(typed_proto.tensor().float_data_size(), kSize);
+  Blob typed_blob;
+  EXPECT_NO_THROW(DeserializeBlob(typed_proto, &typed_blob));
+  EXPECT_EQ(typed_blob.Get<TensorCPU>().data<float>()[999], 999);
+}
+
 TEST(TensorTest, TensorFactory) {
   Tensor a = empty({1, 2, 3}, at::device(CPU).dtype<float>());
   EXPECT_NE(a.data<float>(), nullptr);
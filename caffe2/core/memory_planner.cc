@@ -0,0 +1,414 @@
+#include "caffe2/core/memory_planner.h"
+
+#include <algorithm>
+
+#include "c10/core/CPUAllocator.h"
+#include "caffe2/core/blob.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/workspace.h"
+
+namespace caffe2 {
+namespace memory_planner {
+
+namespace {
+
+size_t AlignUp(size_t n) {
+  return (n + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+bool HasSubnet(const OperatorDef& op) {
+  for (const auto& arg : op.arg()) {
+    if (arg.has_n() || arg.nets_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The ops touching a blob, in net order.
+struct BlobUses {
+  std::vector<int> ops;
+  bool read_before_write = false;
+  bool non_cpu = false;
+};
+
+// Tells whether an op is guaranteed to have finished before another one
+// starts under the executor of the net.
+class HappensBefore {
+ public:
+  explicit HappensBefore(const NetDef& net)
+      : sequential_(IsSequential(net)) {
+    if (sequential_) {
+      return;
+    }
+    // Same dependencies as dag_utils::prepareOperatorNodes.
+    const int num_ops = net.op_size();
+    ancestors_.assign(num_ops, std::vector<bool>(num_ops, false));
+    std::unordered_map<std::string, int> last_writer;
+    std::unordered_map<std::string, std::vector<int>> readers;
+    for (int idx = 0; idx < num_ops; ++idx) {
+      const auto& op = net.op(idx);
+      auto& ancestors = ancestors_[idx];
+      auto add_parent = [&](int parent) {
+        if (ancestors[parent]) {
+          return;
+        }
+        ancestors[parent] = true;
+        const auto& inherited = ancestors_[parent];
+        for (int i = 0; i < parent; ++i) {
+          if (inherited[i]) {
+            ancestors[i] = true;
+          }
+        }
+      };
+      auto read = [&](const std::string& input) {
+        auto it = last_writer.find(input);
+        if (it != last_writer.end()) {
+          add_parent(it->second);
+        }
+        readers[input].push_back(idx);
+      };
+      for (const auto& input : op.input()) {
+        read(input);
+      }
+      for (const auto& input : op.control_input()) {
+        read(input);
+      }
+      for (const auto& output : op.output()) {
+        auto it = last_writer.find(output);
+        if (it != last_writer.end()) {
+          add_parent(it->second);
+        }
+        for (int reader : readers[output]) {
+          if (reader != idx) {
+            add_parent(reader);
+          }
+        }
+        readers[output].clear();
+        last_writer[output] = idx;
+      }
+    }
+  }
+
+  bool operator()(int first, int second) const {
+    if (sequential_) {
+      return first < second;
+    }
+    return ancestors_[second][first];
+  }
+
+ private:
+  const bool sequential_;
+  std::vector<std::vector<bool>> ancestors_;
+};
+
+} // namespace
+
+bool IsSequential(const NetDef& net) {
+  return !net.has_type() || net.type().empty() || net.type() == "simple";
+}
+
+ArenaLayout ComputeArenaLayout(
+    const NetDef& net,
+    const BlobSizeMap& sizes,
+    const std::unordered_set<std::string>& dont_plan,
+    int64_t max_batch_size) {
+  ArenaLayout layout;
+  layout.max_batch_size = max_batch_size;
+  for (const auto& op : net.op()) {
+    if (HasSubnet(op)) {
+      VLOG(1) << "Not planning net " << net.name() << " with control flow op "
+              << op.type();
+      return layout;
+    }
+  }
+
+  const bool net_is_cpu = !net.has_device_option() ||
+      net.device_option().device_type() == PROTO_CPU;
+  std::unordered_map<std::string, BlobUses> uses;
+  for (int idx = 0; idx < net.op_size(); ++idx) {
+    const auto& op = net.op(idx);
+    const bool is_cpu = op.has_device_option()
+        ? op.device_option().device_type() == PROTO_CPU
+        : net_is_cpu;
+    auto touch = [&](const std::string& name, bool is_read) {
+      auto& blob = uses[name];
+      if (blob.ops.empty()) {
+        blob.read_before_write = is_read;
+      }
+      if (blob.ops.empty() || blob.ops.back() != idx) {
+        blob.ops.push_back(idx);
+      }
+      blob.non_cpu |= !is_cpu;
+    };
+    for (const auto& input : op.input()) {
+      touch(input, true);
+    }
+    for (const auto& input : op.control_input()) {
+      touch(input, true);
+    }
+    for (const auto& output : op.output()) {
+      touch(output, false);
+    }
+  }
+
+  std::unordered_set<std::string> external(
+      net.external_input().begin(), net.external_input().end());
+  external.insert(net.external_output().begin(), net.external_output().end());
+
+  std::vector<const std::string*> planned;
+  for (const auto& kv : uses) {
+    const auto& name = kv.first;
+    const auto& blob = kv.second;
+    auto size = sizes.find(name);
+    if (size == sizes.end() || size->second.nbytes == 0 ||
+        size->second.dtype.placementNew() != nullptr ||
+        blob.read_before_write || blob.non_cpu || external.count(name) ||
+        dont_plan.count(name)) {
+      continue;
+    }
+    planned.push_back(&name);
+  }
+  // Largest first, so that small blobs fill the gaps between large ones.
+  std::sort(
+      planned.begin(),
+      planned.end(),
+      [&](const std::string* a, const std::string* b) {
+        const auto a_bytes = sizes.at(*a).nbytes;
+        const auto b_bytes = sizes.at(*b).nbytes;
+        return a_bytes != b_bytes ? a_bytes > b_bytes : *a < *b;
+      });
+
+  const HappensBefore before(net);
+  // Whether all uses of `a` finish before `b` is first written.
+  auto done_before = [&](const BlobUses& a, const BlobUses& b) {
+    const int writer = b.ops.front();
+    for (int op : a.ops) {
+      if (!before(op, writer)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<std::pair<size_t, size_t>> taken;
+  for (const auto* name : planned) {
+    const auto& blob = uses.at(*name);
+    const auto& size = sizes.at(*name);
+    taken.clear();
+    for (const auto& slot : layout.slots) {
+      const auto& other = uses.at(slot.blob);
+      if (!done_before(blob, other) && !done_before(other, blob)) {
+        taken.emplace_back(slot.offset, slot.offset + slot.nbytes);
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    // Lowest gap that fits the blob.
+    size_t offset = 0;
+    for (const auto& range : taken) {
+      if (range.first >= offset + size.nbytes) {
+        break;
+      }
+      offset = std::max(offset, AlignUp(range.second));
+    }
+    layout.slots.push_back({*name, size.dtype, offset, size.nbytes});
+    layout.arena_bytes =
+        std::max(layout.arena_bytes, AlignUp(offset + size.nbytes));
+  }
+  return layout;
+}
+
+} // namespace memory_planner
+
+struct MemoryPlan::Arena {
+  explicit Arena(size_t nbytes)
+      : data(c10::GetCPUAllocator()->allocate(nbytes)), nbytes(nbytes) {}
+
+  char* base() const {
+    return static_cast<char*>(data.get());
+  }
+
+  at::DataPtr data;
+  const size_t nbytes;
+};
+
+namespace {
+
+// Deleter of the storages bound to an arena: drops the reference that the
+// storage holds on the arena. Also identifies arena-backed storages.
+void ReleaseArena(void* ctx) {
+  delete static_cast<std::shared_ptr<void>*>(ctx);
+}
+
+const at::DataPtr& StorageDataPtr(const Tensor& tensor) {
+  return tensor.getIntrusivePtr()->storage().data_ptr();
+}
+
+Tensor* CPUTensorOrNull(Blob* blob) {
+  if (blob == nullptr || !blob->IsType<Tensor>()) {
+    return nullptr;
+  }
+  auto* tensor = blob->GetMutable<Tensor>();
+  if (!tensor->defined() || tensor->GetDeviceType() != CPU) {
+    return nullptr;
+  }
+  return tensor;
+}
+
+} // namespace
+
+MemoryPlan::MemoryPlan(
+    const NetDef& net,
+    Workspace* ws,
+    const std::string& batch_blob,
+    const std::unordered_map<int64_t, BlobSizeMap>& buckets)
+    : net_(net),
+      sequential_(memory_planner::IsSequential(net)),
+      ws_(ws),
+      batch_blob_(batch_blob) {
+  CAFFE_ENFORCE(ws_ != nullptr);
+  CAFFE_ENFORCE(!buckets.empty(), "A memory plan needs at least one bucket");
+  for (const auto& kv : buckets) {
+    CAFFE_ENFORCE_GT(kv.first, 0, "Max batch size of a bucket must be > 0");
+    buckets_.push_back({kv.second, {}});
+    buckets_.back().layout.max_batch_size = kv.first;
+  }
+  std::sort(
+      buckets_.begin(), buckets_.end(), [](const Bucket& a, const Bucket& b) {
+        return a.layout.max_batch_size < b.layout.max_batch_size;
+      });
+
+  op_outputs_.resize(net_.op_size());
+  for (int idx = 0; idx < net_.op_size(); ++idx) {
+    for (const auto& output : net_.op(idx).output()) {
+      op_outputs_[idx].emplace_back(output, ws_->CreateBlob(output));
+    }
+  }
+  Replan();
+}
+
+MemoryPlan::~MemoryPlan() = default;
+
+bool MemoryPlan::IsArenaBacked(const Tensor& tensor) {
+  return tensor.defined() &&
+      StorageDataPtr(tensor).get_deleter() == &ReleaseArena;
+}
+
+void MemoryPlan::Replan() {
+  Unbind();
+  std::lock_guard<std::mutex> lock(dont_plan_mutex_);
+  for (auto& bucket : buckets_) {
+    bucket.layout = memory_planner::ComputeArenaLayout(
+        net_, bucket.sizes, dont_plan_, bucket.layout.max_batch_size);
+    VLOG(1) << "Planned " << bucket.layout.slots.size() << " blobs of net "
+            << net_.name() << " for batch size "
+            << bucket.layout.max_batch_size << " into "
+            << bucket.layout.arena_bytes << " bytes";
+  }
+}
+
+MemoryPlan::Bucket* MemoryPlan::FindBucket() {
+  auto* tensor = CPUTensorOrNull(ws_->GetBlob(batch_blob_));
+  if (tensor == nullptr || tensor->dim() == 0) {
+    return nullptr;
+  }
+  const auto batch_size = tensor->size(0);
+  for (auto& bucket : buckets_) {
+    if (bucket.layout.max_batch_size >= batch_size) {
+      return &bucket;
+    }
+  }
+  return nullptr;
+}
+
+void MemoryPlan::Bind(Bucket* bucket) {
+  const auto& layout = bucket->layout;
+  if (bucket != current_) {
+    Unbind();
+  }
+  if (!arena_ || arena_->nbytes < layout.arena_bytes) {
+    // Storages still bound to the old arena keep it alive until rebound.
+    arena_ = std::make_shared<Arena>(layout.arena_bytes);
+  }
+  for (const auto& slot : layout.slots) {
+    Blob* blob = ws_->CreateBlob(slot.blob);
+    char* target = arena_->base() + slot.offset;
+    auto* tensor = BlobGetMutableTensor(blob, CPU);
+    if (tensor->dtype() == slot.dtype &&
+        StorageDataPtr(*tensor).get() == target) {
+      // Still bound from the previous run.
+      bound_[blob] = &slot;
+      continue;
+    }
+    // Resize first, so that the old storage is released and the sizes match
+    // the bound capacity until the op writing the blob resizes it.
+    tensor->Resize(static_cast<int64_t>(slot.nbytes / slot.dtype.itemsize()));
+    tensor->ShareExternalPointer(
+        at::DataPtr(
+            target,
+            new std::shared_ptr<void>(arena_),
+            &ReleaseArena,
+            at::Device(CPU)),
+        slot.dtype,
+        slot.nbytes);
+    bound_[blob] = &slot;
+  }
+  current_ = bucket;
+}
+
+void MemoryPlan::Unbind() {
+  for (const auto& kv : bound_) {
+    auto* tensor = CPUTensorOrNull(kv.first);
+    if (tensor != nullptr && IsArenaBacked(*tensor)) {
+      tensor->FreeMemory();
+    }
+  }
+  bound_.clear();
+  current_ = nullptr;
+}
+
+void MemoryPlan::BeforeRun() {
+  if (stale_.exchange(false)) {
+    Replan();
+  }
+  if (auto* bucket = FindBucket()) {
+    Bind(bucket);
+  }
+}
+
+void MemoryPlan::AfterOperator(int op_idx) {
+  for (const auto& output : op_outputs_[op_idx]) {
+    Blob* blob = output.second;
+    auto* tensor = CPUTensorOrNull(blob);
+    if (tensor == nullptr || !IsArenaBacked(*tensor)) {
+      continue;
+    }
+    auto it = bound_.find(blob);
+    if (it != bound_.end() && arena_ &&
+        StorageDataPtr(*tensor).get() == arena_->base() + it->second->offset) {
+      continue;
+    }
+    // The op made the output share the storage of another blob of the arena,
+    // which the layout doesn't account for: give the output its own memory
+    // and stop planning both blobs.
+    LOG(WARNING) << "Output " << output.first << " of op " << op_idx
+                 << " of net " << net_.name()
+                 << " aliases planned memory, replanning without it";
+    {
+      std::lock_guard<std::mutex> lock(dont_plan_mutex_);
+      dont_plan_.insert(output.first);
+      for (const auto& input : net_.op(op_idx).input()) {
+        auto* source = CPUTensorOrNull(ws_->GetBlob(input));
+        if (source != nullptr &&
+            source->getIntrusivePtr()->storage().is_alias_of(
+                tensor->getIntrusivePtr()->storage())) {
+          dont_plan_.insert(input);
+        }
+      }
+    }
+    BlobSetTensor(blob, tensor->Clone());
+    stale_ = true;
+  }
+}
+
+} // namespace caffe2
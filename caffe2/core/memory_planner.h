@@ -0,0 +1,164 @@
+#ifndef CAFFE2_CORE_MEMORY_PLANNER_H_
+#define CAFFE2_CORE_MEMORY_PLANNER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "caffe2/core/blob.h"
+#include "caffe2/core/common.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/proto/caffe2_pb.h"
+
+namespace caffe2 {
+
+class Workspace;
+
+// A blob placed at a fixed offset of a memory arena.
+struct CAFFE2_API ArenaSlot {
+  std::string blob;
+  TypeMeta dtype;
+  size_t offset = 0;
+  size_t nbytes = 0;
+};
+
+// The placement of the intermediate blobs of a net in a single arena, valid
+// for runs whose batch size is at most max_batch_size.
+struct CAFFE2_API ArenaLayout {
+  int64_t max_batch_size = 0;
+  size_t arena_bytes = 0;
+  std::vector<ArenaSlot> slots;
+};
+
+// The upper bound on the size of a blob, e.g. as derived from bound shape
+// inference.
+struct CAFFE2_API BlobSize {
+  TypeMeta dtype;
+  size_t nbytes = 0;
+};
+
+using BlobSizeMap = std::unordered_map<std::string, BlobSize>;
+
+namespace memory_planner {
+
+// Alignment of every slot in the arena, in bytes.
+constexpr size_t kArenaAlignment = 64;
+
+// Whether the ops of `net` run one after the other in net order, i.e. it runs
+// on the "simple" executor.
+CAFFE2_API bool IsSequential(const NetDef& net);
+
+// Computes an offset-based layout of the blobs of `net` in one arena.
+//
+// Unlike memonger, which recycles blob names, the planner packs blobs of
+// different sizes into a single buffer: two blobs may overlap in the arena
+// whenever every op touching one of them is guaranteed to have finished
+// before the other is first written. For "simple" nets this is the op order,
+// for other executors it is the dependency DAG of the net (read-after-write,
+// write-after-read and write-after-write), which is what the async executors
+// enforce.
+//
+// Only blobs that are in `sizes`, are neither external inputs nor outputs of
+// the net, are written before they are read, and are only touched by CPU ops
+// are planned. Nets with control flow ops (any op carrying a net argument)
+// are not planned at all.
+CAFFE2_API ArenaLayout ComputeArenaLayout(
+    const NetDef& net,
+    const BlobSizeMap& sizes,
+    const std::unordered_set<std::string>& dont_plan = {},
+    int64_t max_batch_size = 0);
+
+} // namespace memory_planner
+
+// Runs the intermediate blobs of a net out of preplanned arenas, one per
+// batch size bucket, instead of allocating them one by one.
+//
+// Before each run the plan picks the smallest bucket that fits the current
+// batch size (read from dim 0 of `batch_blob`) and binds the planned blobs to
+// their slots. Operators then resize and write their outputs in place, since
+// the bound storage is already large enough. A run with a batch size beyond
+// all buckets keeps the current binding; outputs that outgrow their slot are
+// simply reallocated by the tensor as usual.
+//
+// Operators that make an output share the storage of another blob (e.g.
+// in-place reshapes) are detected after they run: the output is copied out
+// of the arena and the plan is recomputed without the blobs involved.
+//
+// The plan is attached to a net with NetBase::AttachMemoryPlan. Blobs that
+// are needed after the run must be listed as external outputs of the net.
+class CAFFE2_API MemoryPlan {
+ public:
+  // `buckets` maps max batch size to the sizes of the blobs for that batch
+  // size.
+  MemoryPlan(
+      const NetDef& net,
+      Workspace* ws,
+      const std::string& batch_blob,
+      const std::unordered_map<int64_t, BlobSizeMap>& buckets);
+
+  ~MemoryPlan();
+
+  // Binds the planned blobs of the bucket matching the current batch size.
+  void BeforeRun();
+
+  // Checks the outputs of the op that just ran for storage aliasing into the
+  // arena. May be called concurrently for different ops.
+  void AfterOperator(int op_idx);
+
+  // The layout currently bound, or nullptr if none is.
+  const ArenaLayout* layout() const {
+    return current_ == nullptr ? nullptr : &current_->layout;
+  }
+
+  size_t num_buckets() const {
+    return buckets_.size();
+  }
+
+  // Whether the layouts rely on the ops running in net order.
+  bool sequential() const {
+    return sequential_;
+  }
+
+  // Whether `tensor` is backed by one of the arenas of a memory plan.
+  static bool IsArenaBacked(const Tensor& tensor);
+
+ private:
+  struct Arena;
+  struct Bucket {
+    BlobSizeMap sizes;
+    ArenaLayout layout;
+  };
+
+  void Replan();
+  Bucket* FindBucket();
+  void Bind(Bucket* bucket);
+  void Unbind();
+
+  NetDef net_;
+  const bool sequential_;
+  Workspace* ws_;
+  std::string batch_blob_;
+  std::vector<Bucket> buckets_;
+  Bucket* current_ = nullptr;
+
+  // Runs never overlap, so all buckets share one arena, grown to the largest
+  // layout bound so far.
+  std::shared_ptr<Arena> arena_;
+  // Slot of each planned blob of the bound layout.
+  std::unordered_map<Blob*, const ArenaSlot*> bound_;
+  // Name and blob of the outputs of each op.
+  std::vector<std::vector<std::pair<std::string, Blob*>>> op_outputs_;
+  std::unordered_set<std::string> dont_plan_;
+  std::mutex dont_plan_mutex_;
+  std::atomic<bool> stale_{false};
+
+  C10_DISABLE_COPY_AND_ASSIGN(MemoryPlan);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_MEMORY_PLANNER_H_
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+
+#include "caffe2/core/memory_planner.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+class MemoryPlannerTestAddOneOp final : public Operator<CPUContext> {
+ public:
+  MemoryPlannerTestAddOneOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+
+  bool RunOnDevice() override {
+    const auto& X = Input(0);
+    auto* Y = Output(0, X.sizes(), at::dtype<float>());
+    const float* x = X.data<float>();
+    float* y = Y->mutable_data<float>();
+    for (int64_t i = 0; i < X.numel(); ++i) {
+      y[i] = x[i] + 1;
+    }
+    return true;
+  }
+};
+
+class MemoryPlannerTestAliasOp final : public Operator<CPUContext> {
+ public:
+  MemoryPlannerTestAliasOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+
+  bool RunOnDevice() override {
+    OutputTensorAlias(0, Input(0));
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(MemoryPlannerTestAddOne, MemoryPlannerTestAddOneOp);
+REGISTER_CPU_OPERATOR(MemoryPlannerTestAlias, MemoryPlannerTestAliasOp);
+
+OPERATOR_SCHEMA(MemoryPlannerTestAddOne).NumInputs(1).NumOutputs(1);
+OPERATOR_SCHEMA(MemoryPlannerTestAlias).NumInputs(1).NumOutputs(1);
+
+NetDef ChainNet(const std::vector<std::string>& blobs, const string& type) {
+  NetDef net;
+  net.set_name("memory_planner_test");
+  net.set_type(type);
+  for (size_t i = 1; i < blobs.size(); ++i) {
+    net.add_op()->CopyFrom(CreateOperatorDef(
+        "MemoryPlannerTestAddOne", "", {blobs[i - 1]}, {blobs[i]}));
+  }
+  net.add_external_input(blobs.front());
+  net.add_external_output(blobs.back());
+  return net;
+}
+
+BlobSizeMap FloatSizes(const std::map<string, size_t>& numels) {
+  BlobSizeMap sizes;
+  for (const auto& kv : numels) {
+    sizes[kv.first] = {TypeMeta::Make<float>(), kv.second * sizeof(float)};
+  }
+  return sizes;
+}
+
+const ArenaSlot* FindSlot(const ArenaLayout& layout, const string& blob) {
+  for (const auto& slot : layout.slots) {
+    if (slot.blob == blob) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void FillInput(Workspace* ws, int64_t batch_size) {
+  auto* X = BlobGetMutableTensor(ws->CreateBlob("X"), CPU);
+  X->Resize(batch_size, 8);
+  float* x = X->mutable_data<float>();
+  for (int64_t i = 0; i < X->numel(); ++i) {
+    x[i] = i;
+  }
+}
+
+void ExpectOutput(const Workspace& ws, const string& blob, float offset) {
+  const auto& X = ws.GetBlob("X")->Get<Tensor>();
+  const auto& Y = ws.GetBlob(blob)->Get<Tensor>();
+  ASSERT_EQ(X.sizes(), Y.sizes());
+  for (int64_t i = 0; i < Y.numel(); ++i) {
+    EXPECT_EQ(Y.data<float>()[i], X.data<float>()[i] + offset);
+  }
+}
+
+TEST(MemoryPlannerTest, DisjointLifetimesShareMemory) {
+  auto net = ChainNet({"a", "b", "c", "d", "e"}, "simple");
+  auto layout = memory_planner::ComputeArenaLayout(
+      net, FloatSizes({{"a", 100}, {"b", 100}, {"c", 200}, {"d", 100}}));
+  ASSERT_EQ(layout.slots.size(), 3);
+  const auto* b = FindSlot(layout, "b");
+  const auto* c = FindSlot(layout, "c");
+  const auto* d = FindSlot(layout, "d");
+  ASSERT_TRUE(b && c && d);
+  // b is dead once d is written, c overlaps with both.
+  EXPECT_EQ(b->offset, d->offset);
+  EXPECT_NE(b->offset, c->offset);
+  EXPECT_EQ(c->offset % memory_planner::kArenaAlignment, 0);
+  EXPECT_EQ(b->offset % memory_planner::kArenaAlignment, 0);
+  EXPECT_LT(layout.arena_bytes, 400 * sizeof(float));
+}
+
+TEST(MemoryPlannerTest, FollowsDependenciesOfAsyncNets) {
+  // b -> c and d are independent branches reading a.
+  NetDef net;
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"a"}, {"b"}));
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"b"}, {"c"}));
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"a"}, {"d"}));
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"c"}, {"e"}));
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"d"}, {"f"}));
+  net.add_external_input("a");
+  net.add_external_output("e");
+  net.add_external_output("f");
+  const auto sizes = FloatSizes({{"b", 64}, {"c", 64}, {"d", 64}});
+
+  net.set_type("simple");
+  auto layout = memory_planner::ComputeArenaLayout(net, sizes);
+  EXPECT_EQ(FindSlot(layout, "b")->offset, FindSlot(layout, "d")->offset);
+
+  net.set_type("async_scheduling");
+  layout = memory_planner::ComputeArenaLayout(net, sizes);
+  EXPECT_NE(FindSlot(layout, "b")->offset, FindSlot(layout, "d")->offset);
+  EXPECT_NE(FindSlot(layout, "c")->offset, FindSlot(layout, "d")->offset);
+  EXPECT_EQ(layout.arena_bytes, 3 * 64 * sizeof(float));
+}
+
+TEST(MemoryPlannerTest, SkipsBlobsLiveAcrossRuns) {
+  auto net = ChainNet({"a", "b", "c"}, "simple");
+  // b is read before it is written.
+  net.mutable_op(0)->set_input(0, "b");
+  net.mutable_op(0)->set_output(0, "a");
+  auto layout = memory_planner::ComputeArenaLayout(
+      net, FloatSizes({{"a", 16}, {"b", 16}, {"c", 16}}));
+  EXPECT_EQ(layout.slots.size(), 0);
+}
+
+TEST(MemoryPlannerTest, RunsSimpleNetOutOfArena) {
+  Workspace ws;
+  FillInput(&ws, 4);
+  auto net_def = ChainNet({"X", "b", "c", "Y"}, "simple");
+  auto sizes = [](int64_t batch_size) {
+    return FloatSizes({{"b", batch_size * 8}, {"c", batch_size * 8}});
+  };
+  auto plan = std::make_shared<MemoryPlan>(
+      net_def,
+      &ws,
+      "X",
+      std::unordered_map<int64_t, BlobSizeMap>{{4, sizes(4)},
+                                               {16, sizes(16)}});
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  net->AttachMemoryPlan(plan);
+
+  ASSERT_TRUE(net->Run());
+  ExpectOutput(ws, "Y", 3);
+  ASSERT_NE(plan->layout(), nullptr);
+  EXPECT_EQ(plan->layout()->max_batch_size, 4);
+  EXPECT_TRUE(MemoryPlan::IsArenaBacked(ws.GetBlob("b")->Get<Tensor>()));
+  EXPECT_TRUE(MemoryPlan::IsArenaBacked(ws.GetBlob("c")->Get<Tensor>()));
+  EXPECT_FALSE(MemoryPlan::IsArenaBacked(ws.GetBlob("Y")->Get<Tensor>()));
+  const void* b_data = ws.GetBlob("b")->Get<Tensor>().raw_data();
+
+  // Same bucket: the blobs stay where they are.
+  FillInput(&ws, 3);
+  ASSERT_TRUE(net->Run());
+  ExpectOutput(ws, "Y", 3);
+  EXPECT_EQ(ws.GetBlob("b")->Get<Tensor>().raw_data(), b_data);
+
+  FillInput(&ws, 10);
+  ASSERT_TRUE(net->Run());
+  ExpectOutput(ws, "Y", 3);
+  EXPECT_EQ(plan->layout()->max_batch_size, 16);
+  EXPECT_TRUE(MemoryPlan::IsArenaBacked(ws.GetBlob("c")->Get<Tensor>()));
+
+  // Beyond all buckets: outputs that don't fit fall back to the allocator.
+  FillInput(&ws, 32);
+  ASSERT_TRUE(net->Run());
+  ExpectOutput(ws, "Y", 3);
+  EXPECT_FALSE(MemoryPlan::IsArenaBacked(ws.GetBlob("c")->Get<Tensor>()));
+}
+
+TEST(MemoryPlannerTest, RejectsSequentialPlanOnAsyncNet) {
+  Workspace ws;
+  FillInput(&ws, 4);
+  auto net_def = ChainNet({"X", "b", "Y"}, "simple");
+  auto plan = std::make_shared<MemoryPlan>(
+      net_def,
+      &ws,
+      "X",
+      std::unordered_map<int64_t, BlobSizeMap>{{4, FloatSizes({{"b", 32}})}});
+  net_def.set_type("async_scheduling");
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  EXPECT_THROW(net->AttachMemoryPlan(plan), EnforceNotMet);
+}
+
+TEST(MemoryPlannerTest, CopiesAliasedOutputsOutOfArena) {
+  Workspace ws;
+  FillInput(&ws, 4);
+  NetDef net_def;
+  net_def.set_type("simple");
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"X"}, {"b"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAlias", "", {"b"}, {"c"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"X"}, {"d"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("MemoryPlannerTestAddOne", "", {"d"}, {"e"}));
+  net_def.add_external_input("X");
+  net_def.add_external_output("c");
+  net_def.add_external_output("e");
+  auto plan = std::make_shared<MemoryPlan>(
+      net_def,
+      &ws,
+      "X",
+      std::unordered_map<int64_t, BlobSizeMap>{
+          {4, FloatSizes({{"b", 32}, {"d", 32}})}});
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  net->AttachMemoryPlan(plan);
+
+  // b and d share a slot, so c must not keep pointing into it.
+  ASSERT_TRUE(net->Run());
+  ASSERT_NE(plan->layout(), nullptr);
+  EXPECT_EQ(
+      FindSlot(*plan->layout(), "b")->offset,
+      FindSlot(*plan->layout(), "d")->offset);
+  EXPECT_FALSE(MemoryPlan::IsArenaBacked(ws.GetBlob("c")->Get<Tensor>()));
+  ExpectOutput(ws, "c", 1);
+  ExpectOutput(ws, "e", 2);
+
+  // The next run is replanned without b.
+  ASSERT_TRUE(net->Run());
+  EXPECT_EQ(FindSlot(*plan->layout(), "b"), nullptr);
+  EXPECT_NE(FindSlot(*plan->layout(), "d"), nullptr);
+  ExpectOutput(ws, "c", 1);
+  ExpectOutput(ws, "e", 2);
+}
+
+} // namespace
+} // namespace caffe2
@@ -6,6 +6,7 @@
 #include <unordered_set>
 
 #include "caffe2/core/init.h"
+#include "caffe2/core/memory_planner.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/timer.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -97,6 +98,17 @@ bool NetBase::RunAsync() {
   return DoRunAsync();
 }
 
+void NetBase::AttachMemoryPlan(std::shared_ptr<MemoryPlan> plan) {
+  CAFFE_ENFORCE(
+      !plan || SupportsMemoryPlan(*plan),
+      "Net ",
+      name_,
+      " can't run out of a",
+      plan && plan->sequential() ? " sequential" : "",
+      " memory plan");
+  memory_plan_ = std::move(plan);
+}
+
 namespace {
 const std::string kSimpleNet = "simple";
 
@@ -25,6 +25,7 @@ C10_DECLARE_string(caffe2_override_executor);
 namespace caffe2 {
 
 class NetBase;
+class MemoryPlan;
 typedef ObserverBase<NetBase> NetObserver;
 typedef std::function<std::unique_ptr<NetObserver>(NetBase*)>
     NetObserverCreator;
@@ -111,7 +112,23 @@ class CAFFE2_API NetBase : public Observable<NetBase> {
     return net_def_ != nullptr;
   }
 
+  /**
+   * Runs the intermediate blobs of the net out of the arenas of `plan` from
+   * the next run on. Pass nullptr to detach the current plan.
+   */
+  void AttachMemoryPlan(std::shared_ptr<MemoryPlan> plan);
+
+  const std::shared_ptr<MemoryPlan>& memory_plan() const {
+    return memory_plan_;
+  }
+
  protected:
+  // Whether the executor of the net runs its ops in a way that respects the
+  // layouts of `plan`.
+  virtual bool SupportsMemoryPlan(const MemoryPlan& /*plan*/) const {
+    return false;
+  }
+
   virtual bool DoRunAsync() {
     CAFFE_THROW("Not implemented");
   };
@@ -130,6 +147,7 @@ class CAFFE2_API NetBase : public Observable<NetBase> {
   string name_;
   vector<const Event*> events_;
   std::shared_ptr<const NetDef> net_def_;
+  std::shared_ptr<MemoryPlan> memory_plan_;
   C10_DISABLE_COPY_AND_ASSIGN(NetBase);
 };
 
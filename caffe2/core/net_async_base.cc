@@ -1,8 +1,10 @@
 #include "caffe2/core/net_async_base.h"
 
+#include "caffe2/core/memory_planner.h"
 #include "caffe2/core/net_async_tracing.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/timer.h"
+#include "caffe2/core/work_stealing_thread_pool.h"
 
 // experimental support for multiple streams per worker per GPU
 C10_DEFINE_int(
@@ -104,6 +106,11 @@ AsyncNetBase::AsyncNetBase(
   }
 
   num_workers_ = net_def->has_num_workers() ? net_def->num_workers() : -1;
+  task_pools_.reset(new std::atomic<TaskThreadPoolBase*>[chains_.size()]);
+  for (size_t task_id = 0; task_id < chains_.size(); ++task_id) {
+    task_pools_[task_id] = nullptr;
+  }
+  task_enqueue_us_.resize(chains_.size(), 0);
 
   tracer_ = tracing::create(this, net_def->name());
   if (tracer_) {
@@ -156,8 +163,12 @@ TaskThreadPoolBase* AsyncNetBase::poolGetter(
   std::unique_lock<std::mutex> pools_lock(pools_mutex_);
   auto pool = pools[device_id][pool_size];
   if (!pool) {
+    auto pool_type = DeviceTypeName(device_type);
+    if (options_.use_work_stealing_ && IsCPUDeviceType(device_type)) {
+      pool_type += "_WORK_STEALING";
+    }
     pool = c10::ThreadPoolRegistry()->Create(
-        DeviceTypeName(device_type),
+        pool_type,
         device_id,
         pool_size,
         options_.use_per_net_pools_);
@@ -201,6 +212,29 @@ TaskThreadPoolBase* AsyncNetBase::pool(const DeviceOption& device_option) {
   }
 }
 
+TaskThreadPoolBase* AsyncNetBase::taskPool(int task_id) {
+  auto* task_pool = task_pools_[task_id].load(std::memory_order_acquire);
+  if (!task_pool) {
+    task_pool = pool(event(task_id).GetDeviceOption());
+    task_pools_[task_id].store(task_pool, std::memory_order_release);
+  }
+  return task_pool;
+}
+
+namespace {
+int64_t SteadyMicroSeconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+} // namespace
+
+void AsyncNetBase::recordTaskEnqueued(int task_id) {
+  if (tracer_ && tracer_->isEnabled()) {
+    task_enqueue_us_[task_id] = SteadyMicroSeconds();
+  }
+}
+
 int AsyncNetBase::stream(int task_id) {
   const auto& device_option = event(task_id).GetDeviceOption();
   int stream_id = 0;
@@ -400,8 +434,13 @@ bool AsyncNetBase::run(int task_id, int stream_id) noexcept {
       asyncWait(task_id, stream_id, parents(task_id));
     }
     int iter_id = -1;
+    int chain_queue_delay_us = -1;
     if (tracer_) {
       iter_id = tracer_->getIter();
+      if (task_enqueue_us_[task_id] > 0) {
+        chain_queue_delay_us = SteadyMicroSeconds() - task_enqueue_us_[task_id];
+        task_enqueue_us_[task_id] = 0;
+      }
     }
     for (auto& op_id : chains_[task_id]) {
       op = operators_[op_id];
@@ -415,7 +454,9 @@ bool AsyncNetBase::run(int task_id, int stream_id) noexcept {
             tracing::TRACE_STREAM,
             stream_id,
             tracing::TRACE_ITER,
-            iter_id);
+            iter_id,
+            tracing::TRACE_CHAIN_QUEUE_DELAY,
+            op_id == chains_[task_id].front() ? chain_queue_delay_us : -1);
         success = op->RunAsync(stream_id);
       } else {
         counters_.AddPerOpStartTime(op_id);
@@ -430,6 +471,9 @@ bool AsyncNetBase::run(int task_id, int stream_id) noexcept {
         handleChainError(task_id, op, "Failed to execute an op");
         return false;
       }
+      if (memory_plan_) {
+        memory_plan_->AfterOperator(op_id);
+      }
     }
 
     op = nullptr;
@@ -579,6 +623,7 @@ ExecutionOptions::ExecutionOptions(
     use_per_net_pools_ = FLAGS_caffe2_net_async_use_per_net_pools;
     is_blocking_ = false;
     report_stats_ = false;
+    use_work_stealing_ = FLAGS_caffe2_net_async_work_stealing;
   }
 
   use_dfs_scheduling_ = false;
@@ -593,6 +638,10 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "work_stealing") {
+      CAFFE_ENFORCE(arg.has_i(), "work_stealing should be an int");
+      use_work_stealing_ = arg.i() == 1;
+    }
   }
 
   if (FLAGS_caffe2_net_async_profile_operators) {
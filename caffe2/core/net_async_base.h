@@ -55,6 +55,8 @@ struct ExecutionOptions {
   bool use_dfs_scheduling_ = false;
   // run net's root tasks in RunAsync thread instead of in thread pool
   bool run_root_tasks_inline_ = false;
+  // use CPU pools with per-worker lock-free queues and work stealing
+  bool use_work_stealing_ = false;
 };
 
 class CAFFE2_API AsyncNetBase : public NetBase {
@@ -112,6 +114,11 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   int stream(int task_id);
   TaskThreadPoolBase* pool(const DeviceOption& device_option);
   TaskThreadPoolBase* pool();
+  // pool of the task's device, looked up once per net
+  TaskThreadPoolBase* taskPool(int task_id);
+  // remembers when a task was handed to a pool, to trace the queueing delay
+  // of the chain on the event of its first op
+  void recordTaskEnqueued(int task_id);
 
   void finishTasks(const std::unordered_set<int>& task_ids);
   void finalizeEvents();
@@ -140,6 +147,9 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   PoolsMap gpu_pools_;
   static std::vector<int>& getStreamCounters();
   int num_workers_;
+  std::unique_ptr<std::atomic<TaskThreadPoolBase*>[]> task_pools_;
+  // microseconds on a steady clock, 0 if the task wasn't queued while tracing
+  std::vector<int64_t> task_enqueue_us_;
 
   // Exception/error handling
   void handleChainError(
@@ -1,5 +1,6 @@
 #include "caffe2/core/net_async_scheduling.h"
 
+#include "caffe2/core/memory_planner.h"
 #include "caffe2/core/net_async_tracing.h"
 
 namespace caffe2 {
@@ -173,8 +174,8 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
   if (run_inline) {
     schedule_func();
   } else {
-    const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)->run(schedule_func);
+    recordTaskEnqueued(task_id);
+    taskPool(task_id)->run(schedule_func);
   }
 }
 
@@ -224,6 +225,11 @@ void AsyncSchedulingNet::finishRun() {
   running_cv_.notify_all();
 }
 
+bool AsyncSchedulingNet::SupportsMemoryPlan(const MemoryPlan& plan) const {
+  // Ops only follow the dependencies of the net.
+  return !plan.sequential();
+}
+
 bool AsyncSchedulingNet::RunAsync() {
   try {
     std::unique_lock<std::mutex> lock(running_mutex_);
@@ -233,6 +239,9 @@ bool AsyncSchedulingNet::RunAsync() {
     }
     running_ = true;
     reset();
+    if (memory_plan_) {
+      memory_plan_->BeforeRun();
+    }
 
     StartAllObservers();
     tracing::startIter(tracer_);
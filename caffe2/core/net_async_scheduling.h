@@ -18,6 +18,7 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
  protected:
   bool RunAsync() override;
+  bool SupportsMemoryPlan(const MemoryPlan& plan) const override;
 
   void pollAndSchedule(int task_id);
   void schedule(int task_id, bool run_inline = false) noexcept;
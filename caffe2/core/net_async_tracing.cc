@@ -153,6 +153,10 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
       int_args["stream_id"] = event.stream_id_;
     }
 
+    if (event.chain_queue_delay_us_ >= 0) {
+      int_args["chain_queue_delay_us"] = event.chain_queue_delay_us_;
+    }
+
     serialized_event << " \"ph\": \"B\"";
     if (!int_args.empty() || !string_args.empty()) {
       serialized_event << ",\n \"args\": {\n";
@@ -346,6 +350,10 @@ void TracerGuard::addArgument(TracingField field, int value) {
       event_.iter_ = value;
       break;
     }
+    case TRACE_CHAIN_QUEUE_DELAY: {
+      event_.chain_queue_delay_us_ = value;
+      break;
+    }
     default: {
       CAFFE_THROW("Unexpected tracing int field ", field);
     }
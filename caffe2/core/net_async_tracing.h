@@ -40,6 +40,10 @@ struct CAFFE2_API TracerEvent {
   long thread_label_ = -1;
   std::thread::id tid_;
   int iter_ = -1;
+  // Time the task (a chain of ops) spent in a thread pool queue before its
+  // first op started. Only set on the event of that first op: the following
+  // ops of the chain run right after it on the same thread without queueing.
+  int chain_queue_delay_us_ = -1;
 };
 
 enum TracingField {
@@ -50,6 +54,7 @@ enum TracingField {
   TRACE_NAME,
   TRACE_CATEGORY,
   TRACE_ITER,
+  TRACE_CHAIN_QUEUE_DELAY,
 };
 
 enum class TracingMode {
@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "caffe2/core/memory_planner.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/static_tracepoint.h"
 #include "caffe2/core/timer.h"
@@ -54,7 +55,11 @@ SimpleNet::SimpleNet(
 bool SimpleNet::Run() {
   StartAllObservers();
   VLOG(1) << "Running net " << name_;
-  for (auto& op : operators_) {
+  if (memory_plan_) {
+    memory_plan_->BeforeRun();
+  }
+  for (size_t idx = 0; idx < operators_.size(); ++idx) {
+    auto& op = operators_[idx];
     VLOG(1) << "Running operator " << op->debug_def().name() << "("
             << op->debug_def().type() << ").";
 #ifdef CAFFE2_ENABLE_SDT
@@ -72,6 +77,9 @@ bool SimpleNet::Run() {
       LOG(ERROR) << "Operator failed: " << ProtoDebugString(op->debug_def());
       return false;
     }
+    if (memory_plan_) {
+      memory_plan_->AfterOperator(idx);
+    }
   }
   StopAllObservers();
   return true;
@@ -81,6 +89,11 @@ bool SimpleNet::RunAsync() {
   return Run();
 }
 
+bool SimpleNet::SupportsMemoryPlan(const MemoryPlan& /*plan*/) const {
+  // Ops run in net order, which satisfies any layout.
+  return true;
+}
+
 namespace {
 template <typename A, typename B>
 bool PairLargerThan(const std::pair<A, B>& x, const std::pair<A, B>& y) {
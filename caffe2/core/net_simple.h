@@ -45,6 +45,7 @@ class CAFFE2_API SimpleNet : public NetBase {
  protected:
   bool Run() override;
   bool RunAsync() override;
+  bool SupportsMemoryPlan(const MemoryPlan& plan) const override;
 
   vector<unique_ptr<OperatorBase>> operators_;
 
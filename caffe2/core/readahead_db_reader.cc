@@ -0,0 +1,128 @@
+#include "caffe2/core/readahead_db_reader.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+namespace db {
+
+ReadaheadDBReader::ReadaheadDBReader(
+    const DBReader& reader,
+    int batch_size,
+    int num_slots,
+    int num_threads,
+    DecodeFunction decode)
+    : reader_(reader),
+      batch_size_(batch_size),
+      decode_(std::move(decode)),
+      slots_(num_slots),
+      fill_limit_(num_slots) {
+  CAFFE_ENFORCE_GT(batch_size, 0);
+  CAFFE_ENFORCE_GT(num_slots, 0);
+  CAFFE_ENFORCE_GT(num_threads, 0);
+  for (int i = 0; i < num_slots; ++i) {
+    slots_[i].batch = i;
+    slots_[i].pending = batch_size_;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this]() { ReaderLoop(); });
+  }
+}
+
+ReadaheadDBReader::~ReadaheadDBReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  released_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+int ReadaheadDBReader::Next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  CAFFE_ENFORCE(!outstanding_, "Release() the previous batch first.");
+  const int index = next_batch_ % slots_.size();
+  Slot& slot = slots_[index];
+  filled_.wait(lock, [&slot]() { return slot.pending == 0; });
+  ++next_batch_;
+  if (slot.error) {
+    auto error = slot.error;
+    Recycle(&slot);
+    lock.unlock();
+    released_.notify_all();
+    std::rethrow_exception(error);
+  }
+  outstanding_ = true;
+  return index;
+}
+
+void ReadaheadDBReader::Release(int slot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CAFFE_ENFORCE(outstanding_, "No batch to release.");
+    CAFFE_ENFORCE_EQ(
+        slot,
+        (next_batch_ - 1) % slots_.size(),
+        "Released a slot that doesn't hold the current batch.");
+    outstanding_ = false;
+    Recycle(&slots_[slot]);
+  }
+  released_.notify_all();
+}
+
+void ReadaheadDBReader::Recycle(Slot* slot) {
+  slot->batch += slots_.size();
+  slot->pending = batch_size_;
+  slot->error = nullptr;
+  fill_limit_ = slot->batch + 1;
+}
+
+void ReadaheadDBReader::ReaderLoop() {
+  for (;;) {
+    int64_t item;
+    string key;
+    string value;
+    std::exception_ptr error;
+    {
+      // Items are numbered in the order they are read from the shared
+      // cursor, so the batches hold the records in the order Read() returns
+      // them.
+      std::lock_guard<std::mutex> read_lock(read_mutex_);
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [this]() {
+          return stop_ || next_item_ / batch_size_ < fill_limit_;
+        });
+        if (stop_) {
+          return;
+        }
+      }
+      item = next_item_++;
+      try {
+        reader_.Read(&key, &value);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    const int64_t batch = item / batch_size_;
+    const int index = batch % slots_.size();
+    if (!error) {
+      try {
+        decode_(key, value, index, item - batch * batch_size_);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error && !slots_[index].error) {
+      slots_[index].error = error;
+    }
+    if (--slots_[index].pending == 0) {
+      filled_.notify_all();
+    }
+  }
+}
+
+} // namespace db
+} // namespace caffe2
@@ -0,0 +1,113 @@
+#ifndef CAFFE2_CORE_READAHEAD_DB_READER_H_
+#define CAFFE2_CORE_READAHEAD_DB_READER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/db.h"
+
+namespace caffe2 {
+namespace db {
+
+/**
+ * Reads and decodes batches of records ahead of their use.
+ *
+ * The batches are filled into a fixed number of slots, so up to num_slots
+ * batches are read ahead of the consumer. The records are read with
+ * DBReader::Read(), from the position of the reader's shared cursor, so
+ * several ops reading from the same DBReader split its records between them
+ * as they do without readahead. Records read ahead of the consumer are lost
+ * to the other users of the DBReader when the ReadaheadDBReader is destroyed.
+ * The DBReader must outlive the ReadaheadDBReader.
+ *
+ * The reader threads take turns reading from the cursor, and decode the
+ * records they read in parallel, by a callback that writes the result to the
+ * storage the caller keeps for every slot.
+ *
+ * A typical consumer looks like:
+ *
+ *   int slot = readahead.Next();
+ *   // ... use the items decoded into slot ...
+ *   readahead.Release(slot);
+ */
+class CAFFE2_API ReadaheadDBReader {
+ public:
+  // Decodes a record into item `item` of the batch held by slot `slot`.
+  // Called concurrently for distinct (slot, item) pairs.
+  using DecodeFunction = std::function<
+      void(const string& key, const string& value, int slot, int item)>;
+
+  ReadaheadDBReader(
+      const DBReader& reader,
+      int batch_size,
+      int num_slots,
+      int num_threads,
+      DecodeFunction decode);
+  ~ReadaheadDBReader();
+
+  /**
+   * Waits until the next batch is decoded and returns its slot. Rethrows the
+   * first error that reading or decoding the batch raised, in which case the
+   * slot is released right away.
+   */
+  int Next();
+
+  /**
+   * Hands the slot returned by the last Next() back to the reader threads.
+   */
+  void Release(int slot);
+
+  int batch_size() const {
+    return batch_size_;
+  }
+
+  int num_slots() const {
+    return slots_.size();
+  }
+
+ private:
+  struct Slot {
+    int64_t batch = -1;
+    int pending = 0;
+    std::exception_ptr error;
+  };
+
+  void ReaderLoop();
+  // Makes the slot of the current batch available for a later one. Must be
+  // called with mutex_ held.
+  void Recycle(Slot* slot);
+
+  const DBReader& reader_;
+  const int batch_size_;
+  DecodeFunction decode_;
+
+  // Held while numbering and reading an item.
+  std::mutex read_mutex_;
+  // Next item of the stream to read, guarded by read_mutex_.
+  int64_t next_item_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable filled_;
+  std::condition_variable released_;
+  std::vector<Slot> slots_;
+  // Batches below this one were handed to the consumer by Next().
+  int64_t next_batch_ = 0;
+  // Batches below this one may be filled.
+  int64_t fill_limit_;
+  bool outstanding_ = false;
+  std::atomic<bool> stop_{false};
+
+  std::vector<std::thread> threads_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(ReadaheadDBReader);
+};
+
+} // namespace db
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_READAHEAD_DB_READER_H_
@@ -0,0 +1,154 @@
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "caffe2/core/readahead_db_reader.h"
+
+namespace caffe2 {
+namespace db {
+
+namespace {
+
+using Records = std::vector<std::pair<string, string>>;
+
+class VectorCursor : public Cursor {
+ public:
+  explicit VectorCursor(const Records* records) : records_(records) {}
+
+  void Seek(const string& /* unused */) override {
+    CAFFE_THROW("Seek is not supported.");
+  }
+  void SeekToFirst() override {
+    pos_ = 0;
+  }
+  void Next() override {
+    ++pos_;
+  }
+  string key() override {
+    return (*records_)[pos_].first;
+  }
+  string value() override {
+    return (*records_)[pos_].second;
+  }
+  bool Valid() override {
+    return pos_ < records_->size();
+  }
+
+ private:
+  const Records* records_;
+  size_t pos_ = 0;
+};
+
+class VectorDB : public DB {
+ public:
+  explicit VectorDB(int num_records) : DB("", READ) {
+    for (int i = 0; i < num_records; ++i) {
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << i;
+      records_.emplace_back(ss.str(), ss.str());
+    }
+  }
+
+  void Close() override {}
+  std::unique_ptr<Cursor> NewCursor() override {
+    return make_unique<VectorCursor>(&records_);
+  }
+  std::unique_ptr<Transaction> NewTransaction() override {
+    CAFFE_THROW("Read only.");
+  }
+
+ private:
+  Records records_;
+};
+
+// Reads num_batches batches of keys from the reader.
+std::vector<string> ReadBatches(
+    const DBReader& reader,
+    int batch_size,
+    int num_slots,
+    int num_threads,
+    int num_batches) {
+  std::vector<std::vector<string>> keys(
+      num_slots, std::vector<string>(batch_size));
+  ReadaheadDBReader readahead(
+      reader,
+      batch_size,
+      num_slots,
+      num_threads,
+      [&keys](const string& key, const string& /* unused */, int slot, int item) {
+        keys[slot][item] = key;
+      });
+  std::vector<string> result;
+  for (int b = 0; b < num_batches; ++b) {
+    int slot = readahead.Next();
+    result.insert(result.end(), keys[slot].begin(), keys[slot].end());
+    readahead.Release(slot);
+  }
+  return result;
+}
+
+std::vector<string> Keys(int first, int n) {
+  std::vector<string> keys;
+  for (int i = first; i < first + n; ++i) {
+    std::stringstream ss;
+    ss << std::setw(2) << std::setfill('0') << (i % 10);
+    keys.push_back(ss.str());
+  }
+  return keys;
+}
+
+} // namespace
+
+TEST(ReadaheadDBReaderTest, ReadsInOrder) {
+  for (int num_threads : {1, 3, 4}) {
+    for (int num_slots : {1, 2, 5}) {
+      DBReader reader(make_unique<VectorDB>(10));
+      EXPECT_EQ(ReadBatches(reader, 4, num_slots, num_threads, 6), Keys(0, 24));
+    }
+  }
+}
+
+TEST(ReadaheadDBReaderTest, ReadsShard) {
+  DBReader reader;
+  reader.Open(make_unique<VectorDB>(10), 3, 1);
+  EXPECT_EQ(
+      ReadBatches(reader, 2, 2, 2, 2),
+      (std::vector<string>{"01", "04", "07", "01"}));
+}
+
+TEST(ReadaheadDBReaderTest, ReadsFromSharedCursor) {
+  DBReader reader(make_unique<VectorDB>(10));
+  string key;
+  string value;
+  reader.Read(&key, &value);
+  reader.Read(&key, &value);
+  // Starts at the position of the reader, and moves it along.
+  EXPECT_EQ(ReadBatches(reader, 2, 1, 2, 1), Keys(2, 2));
+  // The next batch may have been read, in part, before the readahead stopped.
+  reader.Read(&key, &value);
+  EXPECT_GE(key, "04");
+  EXPECT_LE(key, "06");
+}
+
+TEST(ReadaheadDBReaderTest, PropagatesDecodeErrors) {
+  DBReader reader(make_unique<VectorDB>(10));
+  ReadaheadDBReader readahead(
+      reader,
+      2,
+      2,
+      2,
+      [](const string& key, const string& /* unused */, int, int) {
+        if (key == "03") {
+          throw std::runtime_error("bad record");
+        }
+      });
+  readahead.Release(readahead.Next());
+  EXPECT_THROW(readahead.Next(), std::runtime_error);
+  // The failed batch was released, reading goes on.
+  readahead.Release(readahead.Next());
+}
+
+} // namespace db
+} // namespace caffe2
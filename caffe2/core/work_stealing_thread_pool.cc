@@ -0,0 +1,444 @@
+#include "caffe2/core/work_stealing_thread_pool.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "c10/util/numa.h"
+#include "c10/util/thread_name.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/net_async_base.h"
+
+C10_DEFINE_bool(
+    caffe2_net_async_work_stealing,
+    false,
+    "Run async nets on CPU thread pools with per-worker lock-free run queues "
+    "and work stealing");
+
+C10_DEFINE_bool(
+    caffe2_net_async_pin_threads,
+    false,
+    "Pin the threads of work stealing pools to CPUs. Successive pools of a "
+    "NUMA node take the next CPUs of the node, wrapping around");
+
+namespace caffe2 {
+
+namespace {
+
+constexpr size_t kRingCapacity = 1024;
+constexpr int kSpinCount = 64;
+
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+#if defined(__linux__)
+// Parses a cpulist such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    auto end = list.find(',', pos);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    const auto range = list.substr(pos, end - pos);
+    const auto dash = range.find('-');
+    try {
+      const int first = std::stoi(range.substr(0, dash));
+      const int last =
+          dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception&) {
+      // Skip malformed ranges, e.g. the trailing newline.
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+std::vector<int> NodeCpus(int numa_node_id) {
+  std::ifstream file(
+      "/sys/devices/system/node/node" + c10::to_string(numa_node_id) +
+      "/cpulist");
+  std::string list;
+  if (!std::getline(file, list)) {
+    return {};
+  }
+  return ParseCpuList(list);
+}
+
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return cpus;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::map<int, int> CpuNodes() {
+  std::map<int, int> nodes;
+  for (int node = 0; node < FLAGS_caffe2_net_async_max_numa_nodes; ++node) {
+    for (int cpu : NodeCpus(node)) {
+      nodes[cpu] = node;
+    }
+  }
+  return nodes;
+}
+
+// Offset into the CPUs of numa_node_id (-1 for the CPUs of the process) of the
+// first worker of a new pool. Each pool starts where the previous one ended, so
+// that pools only share CPUs once the node's CPUs are used up.
+size_t NextCpuOffset(int numa_node_id, size_t num_workers) {
+  static std::mutex mutex;
+  static std::map<int, size_t> next_offsets;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& next = next_offsets[numa_node_id];
+  const size_t offset = next;
+  next += num_workers;
+  return offset;
+}
+
+bool PinToCpu(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+#endif // defined(__linux__)
+
+} // namespace
+
+// Bounded lock-free MPMC ring of tasks: the owning worker pops from it like
+// any thief does, so stealing needs no extra synchronization.
+class WorkStealingThreadPool::TaskRing {
+ public:
+  explicit TaskRing(size_t capacity)
+      : slots_(new Slot[capacity]), mask_(capacity - 1) {
+    CAFFE_ENFORCE_EQ(capacity & mask_, 0, "Capacity must be a power of two");
+    for (size_t i = 0; i < capacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool tryPush(std::function<void()>& task) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & mask_];
+      const auto difference =
+          static_cast<std::ptrdiff_t>(
+              slot.sequence.load(std::memory_order_acquire)) -
+          static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (tail_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.task = std::move(task);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool tryPop(std::function<void()>& task) {
+    size_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & mask_];
+      const auto difference =
+          static_cast<std::ptrdiff_t>(
+              slot.sequence.load(std::memory_order_acquire)) -
+          static_cast<std::ptrdiff_t>(position + 1);
+      if (difference == 0) {
+        if (head_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          task = std::move(slot.task);
+          slot.task = nullptr;
+          slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // May spuriously report work that is still being pushed.
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::function<void()> task;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  const size_t mask_;
+  // Keep producers and consumers off each other's cache line.
+  char pad0_[64];
+  std::atomic<size_t> tail_{0};
+  char pad1_[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_{0};
+  char pad2_[64 - sizeof(std::atomic<size_t>)];
+};
+
+// Workers of one NUMA node, which steal from each other and sleep together.
+struct WorkStealingThreadPool::Group {
+  std::vector<size_t> members;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<size_t> sleepers{0};
+  // Tasks that didn't fit into a full ring, guarded by mutex.
+  std::deque<std::function<void()>> overflow;
+  std::atomic<size_t> overflow_size{0};
+};
+
+struct WorkStealingThreadPool::Worker {
+  Worker() : ring(kRingCapacity) {}
+
+  TaskRing ring;
+  size_t group = 0;
+  // Position of the worker among the members of its group.
+  size_t rank = 0;
+  int cpu = -1;
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(int pool_size, int numa_node_id) {
+  const size_t num_workers =
+      pool_size < 0 ? defaultNumThreads() : static_cast<size_t>(pool_size);
+
+  std::vector<int> cpus;
+#if defined(__linux__)
+  if (FLAGS_caffe2_net_async_pin_threads) {
+    cpus = AllowedCpus();
+    if (numa_node_id >= 0) {
+      auto node_cpus = NodeCpus(numa_node_id);
+      std::vector<int> allowed_node_cpus;
+      for (int cpu : node_cpus) {
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+          allowed_node_cpus.push_back(cpu);
+        }
+      }
+      if (!allowed_node_cpus.empty()) {
+        cpus = allowed_node_cpus;
+      }
+    }
+    if (num_workers > cpus.size()) {
+      LOG(INFO) << "Not pinning " << num_workers << " workers to "
+                << cpus.size() << " CPUs";
+      cpus.clear();
+    } else {
+      std::rotate(
+          cpus.begin(),
+          cpus.begin() + NextCpuOffset(numa_node_id, num_workers) % cpus.size(),
+          cpus.end());
+    }
+  }
+  // Group the workers by the NUMA node of their CPU, unless the whole pool
+  // is on one node anyway.
+  std::map<int, int> cpu_nodes;
+  if (numa_node_id < 0 && !cpus.empty()) {
+    cpu_nodes = CpuNodes();
+  }
+#endif
+
+  std::map<int, size_t> node_groups;
+  for (size_t i = 0; i < num_workers; ++i) {
+    auto worker = std::make_unique<Worker>();
+    int node = 0;
+    if (!cpus.empty()) {
+      worker->cpu = cpus[i];
+#if defined(__linux__)
+      auto it = cpu_nodes.find(worker->cpu);
+      if (it != cpu_nodes.end()) {
+        node = it->second;
+      }
+#endif
+    }
+    auto group = node_groups.find(node);
+    if (group == node_groups.end()) {
+      group = node_groups.emplace(node, groups_.size()).first;
+      groups_.push_back(std::make_unique<Group>());
+    }
+    worker->group = group->second;
+    worker->rank = groups_[worker->group]->members.size();
+    groups_[worker->group]->members.push_back(i);
+    workers_.push_back(std::move(worker));
+  }
+
+  threads_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    threads_.emplace_back([this, i, numa_node_id]() {
+      c10::setThreadName("CaffeWSThread");
+      c10::NUMABind(numa_node_id);
+#if defined(__linux__)
+      const int cpu = workers_[i]->cpu;
+      if (cpu >= 0 && !PinToCpu(cpu)) {
+        LOG(WARNING) << "Failed to pin worker " << i << " to CPU " << cpu;
+      }
+#endif
+      mainLoop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  running_.store(false, std::memory_order_release);
+  for (auto& group : groups_) {
+    { std::lock_guard<std::mutex> lock(group->mutex); }
+    group->cv.notify_all();
+  }
+  for (auto& thread : threads_) {
+    try {
+      thread.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (workers_.empty()) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  // Keep the tasks spawned by a worker local to it, spread the others.
+  const size_t index = current_pool == this
+      ? current_worker
+      : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  push(index, func);
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_pool == this;
+}
+
+std::vector<int> WorkStealingThreadPool::workerCpus() const {
+  std::vector<int> cpus;
+  for (const auto& worker : workers_) {
+    cpus.push_back(worker->cpu);
+  }
+  return cpus;
+}
+
+void WorkStealingThreadPool::push(size_t index, std::function<void()> task) {
+  auto& group = *groups_[workers_[index]->group];
+  if (!workers_[index]->ring.tryPush(task)) {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    group.overflow.push_back(std::move(task));
+    group.overflow_size.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Pairs with the fence in mainLoop: either the sleeping worker sees the
+  // task when it checks for work, or we see it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (group.sleepers.load(std::memory_order_relaxed) > 0) {
+    { std::lock_guard<std::mutex> lock(group.mutex); }
+    group.cv.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::tryPop(
+    size_t index,
+    std::function<void()>& task) {
+  auto& worker = *workers_[index];
+  if (worker.ring.tryPop(task)) {
+    return true;
+  }
+  auto& group = *groups_[worker.group];
+  if (group.overflow_size.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    if (!group.overflow.empty()) {
+      task = std::move(group.overflow.front());
+      group.overflow.pop_front();
+      group.overflow_size.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  const auto& members = group.members;
+  for (size_t k = 1; k < members.size(); ++k) {
+    const auto victim = members[(worker.rank + k) % members.size()];
+    if (workers_[victim]->ring.tryPop(task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::mainLoop(size_t index) {
+  current_pool = this;
+  current_worker = index;
+  auto& group = *groups_[workers_[index]->group];
+  const auto has_work = [this, &group]() {
+    if (!running_.load(std::memory_order_acquire) || !group.overflow.empty()) {
+      return true;
+    }
+    for (auto member : group.members) {
+      if (!workers_[member]->ring.empty()) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::function<void()> task;
+  while (running_.load(std::memory_order_acquire)) {
+    bool found = tryPop(index, task);
+    for (int spin = 0; !found && spin < kSpinCount; ++spin) {
+      std::this_thread::yield();
+      found = tryPop(index, task);
+    }
+    if (!found) {
+      std::unique_lock<std::mutex> lock(group.mutex);
+      group.sleepers.fetch_add(1, std::memory_order_relaxed);
+      idle_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      group.cv.wait(lock, has_work);
+      idle_.fetch_sub(1, std::memory_order_relaxed);
+      group.sleepers.fetch_sub(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    try {
+      task();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Exception in thread pool task: " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "Exception in thread pool task: unknown";
+    }
+    // Release whatever the task captured before looking for the next one.
+    task = nullptr;
+  }
+}
+
+} // namespace caffe2
+
+namespace c10 {
+
+C10_REGISTER_CREATOR(
+    ThreadPoolRegistry,
+    CPU_WORK_STEALING,
+    caffe2::GetAsyncNetThreadPool<
+        caffe2::WorkStealingThreadPool,
+        caffe2::PROTO_CPU>);
+
+} // namespace c10
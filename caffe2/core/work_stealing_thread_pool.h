@@ -0,0 +1,75 @@
+#ifndef CAFFE2_CORE_WORK_STEALING_THREAD_POOL_H_
+#define CAFFE2_CORE_WORK_STEALING_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "c10/core/thread_pool.h"
+#include "caffe2/core/common.h"
+
+C10_DECLARE_bool(caffe2_net_async_work_stealing);
+C10_DECLARE_bool(caffe2_net_async_pin_threads);
+
+namespace caffe2 {
+
+/**
+ * A thread pool for the async executors that keeps a lock-free run queue per
+ * worker instead of a single queue under a mutex.
+ *
+ * Tasks submitted from a worker of the pool (e.g. the children of a finished
+ * chain) go to that worker's own queue, tasks submitted from outside are
+ * spread round-robin over the workers. Idle workers steal from the queues of
+ * the other workers on the same NUMA node before going to sleep. With
+ * caffe2_net_async_pin_threads, workers are pinned to the CPUs of the pool's
+ * NUMA node, or to the CPUs the process may run on when the pool is not bound
+ * to a node, successive pools taking successive CPUs.
+ *
+ * The mutex and condition variable of a node are only used when its workers
+ * run out of work, and submitting only notifies when a worker sleeps.
+ */
+class CAFFE2_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool(int pool_size, int numa_node_id = -1);
+  ~WorkStealingThreadPool() override;
+
+  void run(const std::function<void()>& func) override;
+
+  size_t size() const override {
+    return workers_.size();
+  }
+
+  size_t numAvailable() const override {
+    return idle_.load(std::memory_order_relaxed);
+  }
+
+  bool inThreadPool() const override;
+
+  // The CPU each worker is pinned to, or -1 if it is not pinned.
+  std::vector<int> workerCpus() const;
+
+ private:
+  class TaskRing;
+  struct Group;
+  struct Worker;
+
+  void mainLoop(size_t index);
+  bool tryPop(size_t index, std::function<void()>& task);
+  void push(size_t index, std::function<void()> task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::unique_ptr<Group>> groups_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_worker_{0};
+  std::atomic<size_t> idle_{0};
+  std::atomic<bool> running_{true};
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_WORK_STEALING_THREAD_POOL_H_
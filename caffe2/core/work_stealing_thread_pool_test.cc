@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <google/protobuf/text_format.h>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/work_stealing_thread_pool.h"
+
+namespace caffe2 {
+
+namespace {
+
+void WaitFor(const std::atomic<int>& counter, int expected) {
+  while (counter.load() < expected) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, RunsExternalTasks) {
+  WorkStealingThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4);
+  EXPECT_FALSE(pool.inThreadPool());
+
+  // More tasks than the run queues hold, so some overflow.
+  const int kNumTasks = 10000;
+  std::atomic<int> counter{0};
+  std::atomic<int> outside{0};
+  for (int i = 0; i < kNumTasks; ++i) {
+    pool.run([&]() {
+      if (!pool.inThreadPool()) {
+        ++outside;
+      }
+      ++counter;
+    });
+  }
+  WaitFor(counter, kNumTasks);
+  EXPECT_EQ(outside.load(), 0);
+}
+
+TEST(WorkStealingThreadPoolTest, RunsNestedTasks) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> counter{0};
+  std::function<void(int)> spawn = [&](int depth) {
+    ++counter;
+    if (depth > 0) {
+      pool.run([&, depth]() { spawn(depth - 1); });
+      pool.run([&, depth]() { spawn(depth - 1); });
+    }
+  };
+  // Every root spawns a binary tree of 2^7 - 1 tasks on its own worker, which
+  // the idle workers have to steal from.
+  const int kNumRoots = 16;
+  for (int i = 0; i < kNumRoots; ++i) {
+    pool.run([&]() { spawn(6); });
+  }
+  WaitFor(counter, kNumRoots * 127);
+}
+
+TEST(WorkStealingThreadPoolTest, SurvivesThrowingTasks) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> counter{0};
+  pool.run([]() { throw std::runtime_error("task failure"); });
+  pool.run([&]() { ++counter; });
+  WaitFor(counter, 1);
+}
+
+TEST(WorkStealingThreadPoolTest, PinsPoolsToDistinctCpus) {
+  WorkStealingThreadPool unpinned(2);
+  for (int cpu : unpinned.workerCpus()) {
+    EXPECT_EQ(cpu, -1);
+  }
+
+  FLAGS_caffe2_net_async_pin_threads = true;
+  WorkStealingThreadPool first(1);
+  WorkStealingThreadPool second(1);
+  FLAGS_caffe2_net_async_pin_threads = false;
+#if defined(__linux__)
+  const int first_cpu = first.workerCpus()[0];
+  const int second_cpu = second.workerCpus()[0];
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (first_cpu >= 0 && sched_getaffinity(0, sizeof(set), &set) == 0 &&
+      CPU_COUNT(&set) > 1) {
+    EXPECT_NE(first_cpu, second_cpu);
+  }
+#endif
+}
+
+std::atomic<int> op_counter;
+
+class WorkStealingTestOp final : public OperatorBase {
+ public:
+  using OperatorBase::OperatorBase;
+
+  bool Run(int /* unused */) override {
+    ++op_counter;
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(WorkStealingTest, WorkStealingTestOp);
+
+OPERATOR_SCHEMA(WorkStealingTest)
+    .NumInputs(0, INT_MAX)
+    .NumOutputs(0, INT_MAX);
+
+TEST(WorkStealingThreadPoolTest, RunsAsyncSchedulingNet) {
+  const auto spec = R"DOC(
+        name: "work_stealing"
+        type: "async_scheduling"
+        num_workers: 4
+        arg {
+          name: "work_stealing"
+          i: 1
+        }
+        external_input: "in"
+        op {
+          input: "in"
+          output: "a"
+          type: "WorkStealingTest"
+        }
+        op {
+          input: "in"
+          output: "b"
+          type: "WorkStealingTest"
+        }
+        op {
+          input: "in"
+          output: "c"
+          type: "WorkStealingTest"
+        }
+        op {
+          input: "a"
+          input: "b"
+          input: "c"
+          output: "out"
+          type: "WorkStealingTest"
+        }
+)DOC";
+
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      google::protobuf::TextFormat::ParseFromString(spec, &net_def));
+  Workspace ws;
+  ws.CreateBlob("in");
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  op_counter = 0;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+  EXPECT_EQ(op_counter.load(), 40);
+}
+
+} // namespace
+
+} // namespace caffe2
@@ -0,0 +1,307 @@
+#include "caffe2/observers/latency_histogram_observer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+int LatencyHistogram::bucket(uint64_t ns) {
+  constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+  if (ns < kSubBuckets) {
+    return ns;
+  }
+  if (ns >> kMaxValueBits) {
+    return kNumBuckets - 1;
+  }
+  int msb = 63;
+  while (!(ns >> msb)) {
+    --msb;
+  }
+  const int shift = msb - kSubBucketBits;
+  return ((shift + 1) << kSubBucketBits) + (ns >> shift) - kSubBuckets;
+}
+
+uint64_t LatencyHistogram::bucketLow(int b) {
+  constexpr int kSubBuckets = 1 << kSubBucketBits;
+  if (b < kSubBuckets) {
+    return b;
+  }
+  const int shift = (b >> kSubBucketBits) - 1;
+  return static_cast<uint64_t>(kSubBuckets + (b & (kSubBuckets - 1)))
+      << shift;
+}
+
+uint64_t LatencyHistogram::bucketHigh(int b) {
+  constexpr int kSubBuckets = 1 << kSubBucketBits;
+  if (b < kSubBuckets) {
+    return b;
+  }
+  const int shift = (b >> kSubBucketBits) - 1;
+  return bucketLow(b) + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::add(uint64_t ns, uint64_t n) {
+  addBucket(bucket(ns), n);
+  setMax(ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (int b = 0; b < kNumBuckets; ++b) {
+    counts_[b] += other.counts_[b];
+  }
+  count_ += other.count_;
+  setMax(other.max_);
+}
+
+double LatencyHistogram::percentile(double q) const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, std::min<uint64_t>(count_, std::ceil(q * count_)));
+  uint64_t seen = 0;
+  for (int b = 0; b < kNumBuckets; ++b) {
+    seen += counts_[b];
+    if (seen >= rank) {
+      // The middle of the bucket, but never more than was recorded.
+      const double middle = (bucketLow(b) + bucketHigh(b)) / 2.0;
+      return std::min(middle, static_cast<double>(max_));
+    }
+  }
+  return max_;
+}
+
+// Histograms recorded by one thread. Only that thread writes the counters,
+// so plain loads and stores suffice; they are atomic so that merging from
+// another thread sees whole values.
+struct LatencyHistogramObserver::Shard {
+  explicit Shard(int numHistograms)
+      : counts(new std::atomic<uint64_t>[numHistograms *
+                                          LatencyHistogram::kNumBuckets]),
+        maxima(new std::atomic<uint64_t>[numHistograms]) {
+    for (int i = 0; i < numHistograms * LatencyHistogram::kNumBuckets; ++i) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < numHistograms; ++i) {
+      maxima[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> counts;
+  std::unique_ptr<std::atomic<uint64_t>[]> maxima;
+};
+
+// The shards of the running threads, and the samples of the threads that
+// exited.
+struct LatencyHistogramObserver::Shards {
+  explicit Shards(int numHistograms)
+      : numHistograms(numHistograms), retired(numHistograms) {}
+
+  Shard* add() {
+    std::lock_guard<std::mutex> guard(mutex);
+    live.emplace_back(new Shard(numHistograms));
+    return live.back().get();
+  }
+
+  // Called when the thread that owns the shard exits.
+  void retire(Shard* shard) {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (int h = 0; h < numHistograms; ++h) {
+      const auto* counts = &shard->counts[h * LatencyHistogram::kNumBuckets];
+      for (int b = 0; b < LatencyHistogram::kNumBuckets; ++b) {
+        const auto n = counts[b].load(std::memory_order_relaxed);
+        if (n) {
+          retired[h].addBucket(b, n);
+        }
+      }
+      retired[h].setMax(shard->maxima[h].load(std::memory_order_relaxed));
+    }
+    live.erase(std::find_if(
+        live.begin(), live.end(), [shard](const std::unique_ptr<Shard>& s) {
+          return s.get() == shard;
+        }));
+  }
+
+  const int numHistograms;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Shard>> live;
+  std::vector<LatencyHistogram> retired;
+};
+
+namespace {
+
+std::atomic<uint64_t> nextObserverId{0};
+
+} // namespace
+
+LatencyHistogramOperatorObserver::LatencyHistogramOperatorObserver(
+    OperatorBase* subject,
+    LatencyHistogramObserver* netObserver)
+    : ObserverBase<OperatorBase>(subject),
+      netObserver_(netObserver),
+      position_(netObserver ? netObserver->nextOperatorPosition() : -1) {}
+
+void LatencyHistogramOperatorObserver::Start() {
+  timer_.Start();
+}
+
+void LatencyHistogramOperatorObserver::Stop() {
+  if (netObserver_) {
+    netObserver_->record(position_ + 1, timer_.NanoSeconds());
+  }
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>>
+LatencyHistogramOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* rnn_order */) const {
+  // The steps of a recurrent net are not operators of the observed net.
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new LatencyHistogramOperatorObserver(subject, nullptr));
+}
+
+LatencyHistogramObserver::LatencyHistogramObserver(NetBase* subject)
+    : OperatorAttachingNetObserver<
+          LatencyHistogramOperatorObserver,
+          LatencyHistogramObserver>(subject, this),
+      id_(nextObserverId++),
+      numHistograms_(operator_observers_.size() + 1),
+      shards_(std::make_shared<Shards>(numHistograms_)) {}
+
+LatencyHistogramObserver::~LatencyHistogramObserver() {}
+
+void LatencyHistogramObserver::Start() {
+  timer_.Start();
+}
+
+void LatencyHistogramObserver::Stop() {
+  record(0, timer_.NanoSeconds());
+}
+
+LatencyHistogramObserver::Shard* LatencyHistogramObserver::localShard() {
+  struct Entry {
+    std::weak_ptr<Shards> owner;
+    Shard* shard;
+  };
+  // Keyed by id rather than by address, which a later observer may reuse.
+  struct ThreadShards {
+    ~ThreadShards() {
+      for (auto& entry : entries) {
+        if (auto owner = entry.second.owner.lock()) {
+          owner->retire(entry.second.shard);
+        }
+      }
+    }
+
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t lastId = -1;
+    Shard* lastShard = nullptr;
+  };
+  thread_local ThreadShards local;
+  if (local.lastId == id_) {
+    return local.lastShard;
+  }
+  auto it = local.entries.find(id_);
+  if (it == local.entries.end()) {
+    // Forget the shards of the observers that were destroyed.
+    for (auto e = local.entries.begin(); e != local.entries.end();) {
+      if (e->second.owner.expired()) {
+        e = local.entries.erase(e);
+      } else {
+        ++e;
+      }
+    }
+    it = local.entries.emplace(id_, Entry{shards_, shards_->add()}).first;
+  }
+  local.lastId = id_;
+  local.lastShard = it->second.shard;
+  return local.lastShard;
+}
+
+void LatencyHistogramObserver::record(int histogram, uint64_t ns) {
+  auto* shard = localShard();
+  auto& count =
+      shard->counts
+          [histogram * LatencyHistogram::kNumBuckets +
+           LatencyHistogram::bucket(ns)];
+  count.store(
+      count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  auto& maximum = shard->maxima[histogram];
+  if (ns > maximum.load(std::memory_order_relaxed)) {
+    maximum.store(ns, std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram LatencyHistogramObserver::merged(int histogram) const {
+  std::lock_guard<std::mutex> guard(shards_->mutex);
+  LatencyHistogram result = shards_->retired[histogram];
+  for (const auto& shard : shards_->live) {
+    const auto* counts =
+        &shard->counts[histogram * LatencyHistogram::kNumBuckets];
+    for (int b = 0; b < LatencyHistogram::kNumBuckets; ++b) {
+      const auto n = counts[b].load(std::memory_order_relaxed);
+      if (n) {
+        result.addBucket(b, n);
+      }
+    }
+    result.setMax(shard->maxima[histogram].load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+size_t LatencyHistogramObserver::numThreadShards() const {
+  std::lock_guard<std::mutex> guard(shards_->mutex);
+  return shards_->live.size();
+}
+
+LatencyHistogram LatencyHistogramObserver::netHistogram() const {
+  return merged(0);
+}
+
+std::vector<LatencyHistogram> LatencyHistogramObserver::operatorHistograms()
+    const {
+  std::vector<LatencyHistogram> histograms;
+  histograms.reserve(numHistograms_ - 1);
+  for (int i = 1; i < numHistograms_; ++i) {
+    histograms.push_back(merged(i));
+  }
+  return histograms;
+}
+
+LatencyPercentiles LatencyHistogramObserver::percentiles(
+    const LatencyHistogram& histogram) {
+  LatencyPercentiles result;
+  result.count = histogram.count();
+  result.p50 = histogram.percentile(0.5) / 1e6;
+  result.p99 = histogram.percentile(0.99) / 1e6;
+  result.p999 = histogram.percentile(0.999) / 1e6;
+  return result;
+}
+
+LatencyPercentiles LatencyHistogramObserver::netPercentiles() const {
+  return percentiles(netHistogram());
+}
+
+std::vector<LatencyPercentiles> LatencyHistogramObserver::operatorPercentiles()
+    const {
+  std::vector<LatencyPercentiles> result;
+  for (const auto& histogram : operatorHistograms()) {
+    result.push_back(percentiles(histogram));
+  }
+  return result;
+}
+
+LatencyHistogramObserver* AttachLatencyHistogramObserver(Predictor* predictor) {
+  auto* net = predictor->ws()->GetNet(predictor->def().name());
+  CAFFE_ENFORCE(net, "Predictor net ", predictor->def().name(), " not found");
+  auto observer = std::make_unique<LatencyHistogramObserver>(net);
+  auto* result = observer.get();
+  net->AttachObserver(std::move(observer));
+  return result;
+}
+
+} // namespace caffe2
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+class Predictor;
+class LatencyHistogramObserver;
+
+// Log-linear latency histogram in the style of HdrHistogram. Values below
+// 2^kSubBucketBits nanoseconds get a bucket each; above that every power of
+// two is split into 2^kSubBucketBits buckets, so a value is known to within
+// 1/16 of itself. Values from 2^kMaxValueBits ns (about a minute) on are
+// counted in the last bucket.
+class CAFFE2_API LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kMaxValueBits = 36;
+  static constexpr int kNumBuckets = (kMaxValueBits - kSubBucketBits + 1)
+      << kSubBucketBits;
+
+  LatencyHistogram() : counts_(kNumBuckets, 0) {}
+
+  static int bucket(uint64_t ns);
+  // Smallest and largest value counted in bucket b.
+  static uint64_t bucketLow(int b);
+  static uint64_t bucketHigh(int b);
+
+  void add(uint64_t ns, uint64_t n = 1);
+  void addBucket(int b, uint64_t n) {
+    counts_[b] += n;
+    count_ += n;
+  }
+  void merge(const LatencyHistogram& other);
+
+  uint64_t count() const {
+    return count_;
+  }
+  uint64_t max() const {
+    return max_;
+  }
+  void setMax(uint64_t ns) {
+    max_ = std::max(max_, ns);
+  }
+  // Value in nanoseconds below which a fraction q of the samples lie, 0 if
+  // the histogram is empty.
+  double percentile(double q) const;
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t max_ = 0;
+};
+
+struct LatencyPercentiles {
+  uint64_t count = 0;
+  // In milliseconds.
+  double p50 = 0.0;
+  double p99 = 0.0;
+  double p999 = 0.0;
+};
+
+class CAFFE2_API LatencyHistogramOperatorObserver final
+    : public ObserverBase<OperatorBase> {
+ public:
+  explicit LatencyHistogramOperatorObserver(OperatorBase* subject) = delete;
+  explicit LatencyHistogramOperatorObserver(
+      OperatorBase* subject,
+      LatencyHistogramObserver* netObserver);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  LatencyHistogramObserver* netObserver_;
+  int position_;
+  Timer timer_;
+};
+
+// Keeps a latency histogram of the net and of every one of its operators.
+// Samples are recorded into histograms of the recording thread, so that
+// operators running in parallel never contend; the per-thread histograms are
+// only merged when the percentiles are asked for, which may happen while the
+// net is running. The histograms of a thread are folded into a common one
+// when the thread exits.
+class CAFFE2_API LatencyHistogramObserver final
+    : public OperatorAttachingNetObserver<
+          LatencyHistogramOperatorObserver,
+          LatencyHistogramObserver> {
+ public:
+  explicit LatencyHistogramObserver(NetBase* subject);
+  ~LatencyHistogramObserver() override;
+
+  LatencyHistogram netHistogram() const;
+  // Histograms of the operators, in the order of the net.
+  std::vector<LatencyHistogram> operatorHistograms() const;
+
+  LatencyPercentiles netPercentiles() const;
+  std::vector<LatencyPercentiles> operatorPercentiles() const;
+
+  static LatencyPercentiles percentiles(const LatencyHistogram& histogram);
+
+  // Number of running threads that recorded samples.
+  size_t numThreadShards() const;
+
+ private:
+  friend class LatencyHistogramOperatorObserver;
+  struct Shard;
+  struct Shards;
+
+  void Start() override;
+  void Stop() override;
+
+  // Called by the operator observers while the base class attaches them.
+  int nextOperatorPosition() const {
+    return operator_observers_.size();
+  }
+  // Histogram 0 is the net's, histogram i + 1 that of operator i.
+  void record(int histogram, uint64_t ns);
+  Shard* localShard();
+  LatencyHistogram merged(int histogram) const;
+
+  const uint64_t id_;
+  const int numHistograms_;
+  Timer timer_;
+  // Shared with the threads that record, which may exit after the observer
+  // is destroyed.
+  std::shared_ptr<Shards> shards_;
+};
+
+// Attaches a LatencyHistogramObserver to the net run by the predictor. The
+// observer is owned by the net.
+CAFFE2_API LatencyHistogramObserver* AttachLatencyHistogramObserver(
+    Predictor* predictor);
+
+} // namespace caffe2
@@ -0,0 +1,130 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "latency_histogram_observer.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+class LatencySleepOp final : public OperatorBase {
+ public:
+  LatencySleepOp(const OperatorDef& operator_def, Workspace* ws)
+      : OperatorBase(operator_def, ws),
+        ms_(OperatorBase::GetSingleArgument<int>("ms", 1)) {}
+  bool Run(int /* unused */) override {
+    StartAllObservers();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms_));
+    StopAllObservers();
+    return true;
+  }
+
+ private:
+  int ms_;
+};
+
+REGISTER_CPU_OPERATOR(LatencySleepOp, LatencySleepOp);
+
+OPERATOR_SCHEMA(LatencySleepOp).NumInputs(0, INT_MAX).NumOutputs(0, INT_MAX);
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws, const string& type) {
+  NetDef net_def;
+  net_def.set_type(type);
+  for (int ms : {2, 20}) {
+    auto& op = *(net_def.add_op());
+    op.set_type("LatencySleepOp");
+    auto& arg = *(op.add_arg());
+    arg.set_name("ms");
+    arg.set_i(ms);
+  }
+  return CreateNet(net_def, ws);
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0.0);
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.add(i * 1000);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_NEAR(histogram.percentile(0.5), 500000, 500000 / 16);
+  EXPECT_NEAR(histogram.percentile(0.99), 990000, 990000 / 16);
+  EXPECT_LE(histogram.percentile(0.999), 1000000);
+  EXPECT_NEAR(histogram.percentile(1.0), 1000000, 1000000 / 16);
+
+  LatencyHistogram other;
+  other.add(5, 1000);
+  histogram.merge(other);
+  EXPECT_EQ(histogram.count(), 2000);
+  EXPECT_EQ(histogram.percentile(0.5), 5);
+}
+
+TEST(LatencyHistogramTest, Buckets) {
+  for (int b = 1; b < LatencyHistogram::kNumBuckets; ++b) {
+    EXPECT_EQ(LatencyHistogram::bucket(LatencyHistogram::bucketLow(b)), b);
+    EXPECT_EQ(LatencyHistogram::bucket(LatencyHistogram::bucketHigh(b)), b);
+    EXPECT_EQ(
+        LatencyHistogram::bucketLow(b),
+        LatencyHistogram::bucketHigh(b - 1) + 1);
+  }
+  EXPECT_EQ(
+      LatencyHistogram::bucket(uint64_t(1) << 50),
+      LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogramObserverTest, RecordsNetAndOperators) {
+  for (const string type : {"simple", "async_scheduling"}) {
+    Workspace ws;
+    unique_ptr<NetBase> net(CreateNetTestHelper(&ws, type));
+    auto net_ob = std::make_unique<LatencyHistogramObserver>(net.get());
+    const auto* ob = net_ob.get();
+    net->AttachObserver(std::move(net_ob));
+    for (int i = 0; i < 5; ++i) {
+      net->Run();
+    }
+
+    const auto net_percentiles = ob->netPercentiles();
+    EXPECT_EQ(net_percentiles.count, 5);
+    EXPECT_GT(net_percentiles.p50, 22);
+    EXPECT_LT(net_percentiles.p50, 50);
+    EXPECT_GE(net_percentiles.p999, net_percentiles.p50);
+
+    const auto op_percentiles = ob->operatorPercentiles();
+    ASSERT_EQ(op_percentiles.size(), 2);
+    EXPECT_EQ(op_percentiles[0].count, 5);
+    EXPECT_GT(op_percentiles[0].p50, 2);
+    EXPECT_LT(op_percentiles[0].p50, 15);
+    EXPECT_EQ(op_percentiles[1].count, 5);
+    EXPECT_GT(op_percentiles[1].p50, 20);
+    EXPECT_LT(op_percentiles[1].p50, 45);
+  }
+}
+
+TEST(LatencyHistogramObserverTest, MergesThreads) {
+  Workspace ws;
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws, "simple"));
+  auto net_ob = std::make_unique<LatencyHistogramObserver>(net.get());
+  const auto* ob = net_ob.get();
+  net->AttachObserver(std::move(net_ob));
+  // Each thread records into its own histograms, which are folded into the
+  // observer's when the thread exits.
+  for (int i = 0; i < 3; ++i) {
+    std::thread([&net]() { net->Run(); }).join();
+  }
+  EXPECT_EQ(ob->numThreadShards(), 0);
+  net->Run();
+  EXPECT_EQ(ob->numThreadShards(), 1);
+  EXPECT_EQ(ob->netHistogram().count(), 4);
+  for (const auto& histogram : ob->operatorHistograms()) {
+    EXPECT_EQ(histogram.count(), 4);
+  }
+}
+
+} // namespace caffe2
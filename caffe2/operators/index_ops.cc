@@ -20,16 +20,20 @@ class IndexCreateOp : public Operator<CPUContext> {
       : Operator(std::forward<Args>(args)...),
         maxElements_(OperatorBase::GetSingleArgument<int>(
             "max_elements",
-            std::numeric_limits<int>::max())) {}
+            std::numeric_limits<int>::max())),
+        numShards_(OperatorBase::GetSingleArgument<int>("num_shards", 1)) {
+    CAFFE_ENFORCE_GT(numShards_, 0, "num_shards must be positive.");
+  }
 
   bool RunOnDevice() override {
     *OperatorBase::Output<std::unique_ptr<IndexBase>>(0) =
-        std::unique_ptr<IndexBase>(new Index<T>(maxElements_));
+        std::unique_ptr<IndexBase>(new Index<T>(maxElements_, numShards_));
     return true;
   }
 
  private:
   int64_tValue maxElements_;
+  int numShards_;
 };
 
 class IndexGetOp : public Operator<CPUContext> {
@@ -153,6 +157,10 @@ Creates a dictionary that maps int32 keys to consecutive integers
 from 1 to max_elements. Zero is reserved for unknown keys.
 )DOC")
     .Arg("max_elements", "Max number of elements, including the zero entry.")
+    .Arg(
+        "num_shards",
+        "Number of lock-striped shards the index is split into. Use more than "
+        "one when many nets call IndexGet on the same index concurrently.")
     .Output(0, "handler", "Pointer to an Index instance.")
     .ScalarType(TensorProto_DataType_UNDEFINED);
 
@@ -164,6 +172,10 @@ Creates a dictionary that maps int64 keys to consecutive integers
 from 1 to max_elements. Zero is reserved for unknown keys.
 )DOC")
     .Arg("max_elements", "Max number of elements, including the zero entry.")
+    .Arg(
+        "num_shards",
+        "Number of lock-striped shards the index is split into. Use more than "
+        "one when many nets call IndexGet on the same index concurrently.")
     .Output(0, "handler", "Pointer to an Index instance.")
     .ScalarType(TensorProto_DataType_UNDEFINED);
 
@@ -175,6 +187,10 @@ Creates a dictionary that maps string keys to consecutive integers
 from 1 to max_elements. Zero is reserved for unknown keys.
 )DOC")
     .Arg("max_elements", "Max number of elements, including the zero entry.")
+    .Arg(
+        "num_shards",
+        "Number of lock-striped shards the index is split into. Use more than "
+        "one when many nets call IndexGet on the same index concurrently.")
     .Output(0, "handle", "Pointer to an Index instance.")
     .ScalarType(TensorProto_DataType_UNDEFINED);
 
@@ -286,7 +302,8 @@ class IndexSerializer : public BlobSerializerBase {
     blob_proto.set_type("std::unique_ptr<caffe2::IndexBase>");
 
     std::ostringstream os;
-    os << base->maxElements() << " " << base->isFrozen();
+    os << base->maxElements() << " " << base->isFrozen() << " "
+       << base->numShards();
     blob_proto.set_content(os.str());
 
     acceptor(name, SerializeBlobProtoAsString_EnforceCheck(blob_proto));
@@ -312,16 +329,21 @@ class IndexDeserializer : public BlobDeserializerBase {
     int64_t maxElements{std::numeric_limits<int64_t>::max()};
     bool isFrozen{false};
     is >> maxElements >> isFrozen;
+    // Older blobs don't record the number of shards.
+    size_t numShards{1};
+    if (!(is >> numShards)) {
+      numShards = 1;
+    }
 
     auto& tensor_in = tensor_blob.template Get<Tensor>();
     auto* base = blob->template GetMutable<std::unique_ptr<IndexBase>>();
 
     if (tensor_in.IsType<std::string>()) {
-      doLoad<std::string>(base, maxElements, tensor_in);
+      doLoad<std::string>(base, maxElements, numShards, tensor_in);
     } else if (tensor_in.IsType<int32_t>()) {
-      doLoad<int32_t>(base, maxElements, tensor_in);
+      doLoad<int32_t>(base, maxElements, numShards, tensor_in);
     } else if (tensor_in.IsType<int64_t>()) {
-      doLoad<int64_t>(base, maxElements, tensor_in);
+      doLoad<int64_t>(base, maxElements, numShards, tensor_in);
     } else {
       CAFFE_THROW("Index of this type cannot be deserialized.");
     }
@@ -336,8 +358,9 @@ class IndexDeserializer : public BlobDeserializerBase {
   void doLoad(
       std::unique_ptr<IndexBase>* base,
       int64_t maxElements,
+      size_t numShards,
       const Tensor& tensor_in) {
-    base->reset(new Index<T>(maxElements));
+    base->reset(new Index<T>(maxElements, numShards));
     auto* dict = dynamic_cast_if_rtti<Index<T>*>(base->get());
     dict->Load(tensor_in.data<T>(), tensor_in.numel());
   }
@@ -1,10 +1,12 @@
 #ifndef CAFFE2_OPERATORS_INDEX_OPS_H_
 #define CAFFE2_OPERATORS_INDEX_OPS_H_
 
+#include <atomic>
+#include <deque>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <sstream>
-#include <unordered_map>
 #include <vector>
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/operator.h"
@@ -18,8 +20,13 @@ using int64_tValue = int64_t;
 
 struct IndexBase {
  public:
-  IndexBase(int64_tValue maxElements, const TypeMeta& type)
-      : maxElements_{maxElements}, meta_(type), frozen_{false} {}
+  IndexBase(int64_tValue maxElements, const TypeMeta& type, size_t numShards = 1)
+      : maxElements_{maxElements},
+        meta_(type),
+        frozen_{false},
+        numShards_(numShards) {
+    CAFFE_ENFORCE(numShards_ > 0, "Index needs at least one shard.");
+  }
 
   void Freeze() {
     frozen_ = true;
@@ -39,83 +46,236 @@ struct IndexBase {
     return meta_;
   }
 
+  size_t numShards() const {
+    return numShards_;
+  }
+
   int64_tValue Size() {
-    std::lock_guard<std::mutex> guard(dictMutex_);
-    return nextId_;
+    return nextId_.load();
   }
 
  protected:
   int64_t maxElements_;
   TypeMeta meta_;
-  int64_tValue nextId_{1}; // guarded by dictMutex_
+  // Only incremented under the lock of the shard receiving the new key.
+  std::atomic<int64_tValue> nextId_{1};
   std::atomic<bool> frozen_{false};
   std::mutex dictMutex_;
+  const size_t numShards_;
 };
 
+// The dictionary of an Index is split into numShards shards. Each shard is an
+// open-addressing hash table whose slots atomically point to immutable
+// entries, so looking up a known key takes no lock and writes no shared
+// memory. Inserts serialize on the mutex of the shard of the new key. A table
+// that would become more than half full is replaced by a copy twice as large;
+// the replaced tables stay alive until the index is reloaded or destroyed, so
+// readers still probing them remain valid.
+//
+// Get hashes a whole batch first and prefetches the bucket of the key
+// kPrefetchDistance positions ahead before probing the current one, so the
+// cache misses of the lookups overlap. New ids are still handed out in key
+// order.
 template <typename T>
 struct Index : IndexBase {
-  explicit Index(int64_tValue maxElements)
-      : IndexBase(maxElements, TypeMeta::Make<T>()) {}
+  explicit Index(int64_tValue maxElements, size_t numShards = 1)
+      : IndexBase(maxElements, TypeMeta::Make<T>(), numShards),
+        shards_(new Shard[numShards]) {}
 
   void Get(const T* keys, int64_tValue* values, size_t numKeys) {
-    if (frozen_) {
-      FrozenGet(keys, values, numKeys);
-      return;
+    const bool frozen = frozen_;
+    std::vector<uint64_t> hashes(numKeys);
+    for (size_t i = 0; i < numKeys; ++i) {
+      hashes[i] = hashOf(keys[i]);
     }
-    std::lock_guard<std::mutex> lock(dictMutex_);
-    for (int i = 0; i < numKeys; ++i) {
-      auto it = dict_.find(keys[i]);
-      if (it != dict_.end()) {
-        values[i] = it->second;
-      } else if (nextId_ < maxElements_) {
-        auto newValue = nextId_++;
-        dict_.insert({keys[i], newValue});
-        values[i] = newValue;
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < numKeys; ++i) {
+      if (i + kPrefetchDistance < numKeys) {
+        prefetchBucket(hashes[i + kPrefetchDistance]);
+      }
+      const Entry* entry = find(shardOf(hashes[i]), keys[i], hashes[i]);
+      if (entry != nullptr) {
+        values[i] = entry->id;
+      } else if (frozen) {
+        values[i] = 0;
       } else {
-        CAFFE_THROW("Dict max size reached");
+        misses.push_back(i);
       }
     }
+    // Insert the missing keys in key order, so that ids are assigned in the
+    // order of the batch when there is no concurrent Get.
+    for (const size_t i : misses) {
+      values[i] = insert(keys[i], hashes[i]);
+    }
   }
 
   bool Load(const T* keys, size_t numKeys) {
     CAFFE_ENFORCE(
         numKeys <= maxElements_,
         "Cannot load index: Tensor is larger than max_elements.");
-    decltype(dict_) dict;
-    for (int i = 0; i < numKeys; ++i) {
+    std::unique_ptr<Shard[]> shards(new Shard[numShards_]);
+    for (size_t i = 0; i < numKeys; ++i) {
+      const uint64_t hash = hashOf(keys[i]);
+      auto& shard = shards[shardIndex(hash)];
       CAFFE_ENFORCE(
-          dict.insert({keys[i], i + 1}).second,
+          find(shard, keys[i], hash) == nullptr,
           "Repeated elements found: cannot load into dictionary.");
+      add(shard, keys[i], hash, i + 1);
     }
     // assume no `get` is inflight while this happens
     {
       std::lock_guard<std::mutex> lock(dictMutex_);
+      auto shardLocks = lockAllShards();
       // let the old dict get destructed outside of the lock
-      dict_.swap(dict);
+      shards_.swap(shards);
       nextId_ = numKeys + 1;
     }
     return true;
   }
 
+  // Takes all the locks, so the stored keys are a consistent snapshot even
+  // with concurrent Gets.
   bool Store(Tensor* out) {
     std::lock_guard<std::mutex> lock(dictMutex_);
+    auto shardLocks = lockAllShards();
     out->Resize(nextId_ - 1);
     auto outData = out->template mutable_data<T>();
-    for (const auto& entry : dict_) {
-      outData[entry.second - 1] = entry.first;
+    for (size_t s = 0; s < numShards_; ++s) {
+      for (const auto& entry : shards_[s].entries) {
+        outData[entry.id - 1] = entry.key;
+      }
     }
     return true;
   }
 
  private:
-  void FrozenGet(const T* keys, int64_tValue* values, size_t numKeys) {
-    for (int i = 0; i < numKeys; ++i) {
-      auto it = dict_.find(keys[i]);
-      values[i] = it != dict_.end() ? it->second : 0;
+  static constexpr size_t kInitialCapacity = 16;
+  static constexpr size_t kPrefetchDistance = 8;
+
+  struct Entry {
+    T key;
+    int64_tValue id;
+  };
+
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<const Entry*>[capacity]) {
+      for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    const size_t mask;
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+  };
+
+  struct Shard {
+    Shard() {
+      tables.emplace_back(new Table(kInitialCapacity));
+      table.store(tables.back().get(), std::memory_order_relaxed);
+    }
+
+    // The table readers probe, always the last one of `tables`.
+    std::atomic<const Table*> table;
+    std::mutex mutex;
+    // Guarded by mutex. The deque keeps the addresses of the entries stable.
+    std::deque<Entry> entries;
+    std::vector<std::unique_ptr<Table>> tables;
+  };
+
+  static uint64_t hashOf(const T& key) {
+    // std::hash is the identity for integers, mix the bits so that both the
+    // shard and the bucket depend on all of them.
+    uint64_t h = std::hash<T>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // The buckets use the low bits of the hash, pick the shard from the high
+  // ones so that the keys of a shard do not cluster in its table.
+  size_t shardIndex(uint64_t hash) const {
+    return (hash >> 32) % numShards_;
+  }
+
+  Shard& shardOf(uint64_t hash) const {
+    return shards_[shardIndex(hash)];
+  }
+
+  static const Entry* find(const Shard& shard, const T& key, uint64_t hash) {
+    const Table* table = shard.table.load(std::memory_order_acquire);
+    // Tables are at most half full, so the probe always reaches an empty slot.
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+      const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+      if (entry == nullptr || entry->key == key) {
+        return entry;
+      }
+    }
+  }
+
+  void prefetchBucket(uint64_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+    const Table* table = shardOf(hash).table.load(std::memory_order_acquire);
+    __builtin_prefetch(&table->slots[hash & table->mask]);
+#endif
+  }
+
+  int64_tValue insert(const T& key, uint64_t hash) {
+    auto& shard = shardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (const Entry* entry = find(shard, key, hash)) {
+      // Inserted by an earlier key of this batch or another thread.
+      return entry->id;
+    }
+    auto newValue = nextId_.load();
+    do {
+      if (newValue >= maxElements_) {
+        CAFFE_THROW("Dict max size reached");
+      }
+    } while (!nextId_.compare_exchange_weak(newValue, newValue + 1));
+    add(shard, key, hash, newValue);
+    return newValue;
+  }
+
+  // Adds a key that is not in the shard yet, growing its table first if it
+  // would become more than half full. Called with the lock of the shard held,
+  // or on a shard no other thread can see yet.
+  static void add(Shard& shard, const T& key, uint64_t hash, int64_tValue id) {
+    shard.entries.push_back({key, id});
+    Table* table = shard.tables.back().get();
+    if (2 * shard.entries.size() <= table->mask + 1) {
+      place(*table, &shard.entries.back(), hash);
+      return;
+    }
+    std::unique_ptr<Table> grown(new Table(2 * (table->mask + 1)));
+    for (const auto& entry : shard.entries) {
+      place(*grown, &entry, hashOf(entry.key));
+    }
+    shard.table.store(grown.get(), std::memory_order_release);
+    shard.tables.push_back(std::move(grown));
+  }
+
+  static void place(Table& table, const Entry* entry, uint64_t hash) {
+    size_t i = hash & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(entry, std::memory_order_release);
+  }
+
+  std::vector<std::unique_lock<std::mutex>> lockAllShards() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(numShards_);
+    for (size_t s = 0; s < numShards_; ++s) {
+      locks.emplace_back(shards_[s].mutex);
     }
+    return locks;
   }
 
-  std::unordered_map<T, int64_tValue> dict_;
+  std::unique_ptr<Shard[]> shards_;
 };
 
 } // namespace caffe2
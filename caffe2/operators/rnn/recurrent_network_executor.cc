@@ -1,5 +1,7 @@
 #include "caffe2/operators/rnn/recurrent_network_executor.h"
 
+#include <algorithm>
+
 #include "caffe2/core/timer.h"
 
 namespace caffe2 {
@@ -23,10 +25,62 @@ std::unique_ptr<RecurrentNetworkExecutorBase> createRNNExecutor<CPUContext>(
     exec->setNumThreads(num_threads);
     LOG(INFO) << "Set num threads: " << num_threads;
   }
+  exec->setWavefrontScheduling(
+      rnn_args.GetSingleArgument<bool>("rnn_executor.sequence_parallel", false));
   exec->debug_ = rnn_args.GetSingleArgument<int>("rnn_executor_debug", 0);
   return std::unique_ptr<RecurrentNetworkExecutorBase>(exec);
 }
 
+void RNNTaskQueue::Push(const OpTask& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CAFFE_ENFORCE(!no_more_jobs_, "Cannot push to a closed queue.");
+    auto it = std::upper_bound(
+        tasks_.begin(),
+        tasks_.end(),
+        task,
+        [](const OpTask& a, const OpTask& b) { return a.wave < b.wave; });
+    tasks_.insert(it, task);
+  }
+  cv_.notify_one();
+}
+
+bool RNNTaskQueue::Pop(
+    OpTask* task,
+    const std::function<bool(const OpTask&)>& runnable) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = tasks_.end();
+  cv_.wait(lock, [&] {
+    it = std::find_if(tasks_.begin(), tasks_.end(), runnable);
+    return it != tasks_.end() || no_more_jobs_;
+  });
+  if (it == tasks_.end()) {
+    return false;
+  }
+  *task = *it;
+  tasks_.erase(it);
+  return true;
+}
+
+int RNNTaskQueue::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+void RNNTaskQueue::Notify() {
+  // Taking the mutex orders the change with the check of a waiting Pop
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  cv_.notify_all();
+}
+
+void RNNTaskQueue::NoMoreJobs() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    no_more_jobs_ = true;
+  }
+  cv_.notify_all();
+}
+
 /**
  * Run forwardpass with T timesteps.
  */
@@ -39,13 +93,14 @@ bool ThreadedRecurrentNetworkExecutor::Run(int T) {
   CAFFE_ENFORCE(timestep_ops_.size() >= T);
   countdown_ = T * timestep_ops_[0].size();
   finished_timesteps_ = 0;
+  ComputeWaves(T, 1);
 
   CHECK(task_queue_.size() == 0);
 
   for (auto& rnn_op : timestep_ops_[0]) {
     // Launch "frontier"-ops first.
     if (rnn_op.frontier) {
-      task_queue_.Push(OpTask(0, rnn_op.order, T, 1));
+      Schedule(OpTask(0, rnn_op.order, T, 1));
     }
   }
 
@@ -65,13 +120,14 @@ bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
   CAFFE_ENFORCE(timestep_ops_.size() >= T);
   countdown_ = T * timestep_ops_[0].size();
   finished_timesteps_ = 0;
+  ComputeWaves(T, -1);
 
   // Frontier
   CHECK(task_queue_.size() == 0);
 
   for (auto& rnn_op : timestep_ops_[T - 1]) {
     if (rnn_op.frontier) {
-      task_queue_.Push(OpTask(T - 1, rnn_op.order, T, -1));
+      Schedule(OpTask(T - 1, rnn_op.order, T, -1));
     }
   }
 
@@ -79,6 +135,45 @@ bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
   return true;
 }
 
+/**
+ * Computes the wave of every op for wavefront scheduling: the length of the
+ * longest dependency chain that leads to it over all timesteps. Visiting
+ * timesteps in execution order and ops in step net order follows the
+ * dependencies, as they only point to later ops or to the next timestep.
+ */
+void ThreadedRecurrentNetworkExecutor::ComputeWaves(int T, int direction) {
+  if (!wavefront_) {
+    return;
+  }
+  const int num_ops = timestep_ops_template_.size();
+  waves_.assign(T * num_ops, 0);
+  for (int step = 0; step < T; step++) {
+    int t = direction == 1 ? step : T - 1 - step;
+    for (const auto& rnn_op : timestep_ops_template_) {
+      int wave = waves_[t * num_ops + rnn_op.order];
+      for (int depidx : rnn_op.dependencies) {
+        int dep_t = t;
+        if (depidx <= rnn_op.order) {
+          if (step == T - 1) {
+            continue;
+          }
+          dep_t += direction;
+        }
+        int& dep_wave = waves_[dep_t * num_ops + depidx];
+        dep_wave = std::max(dep_wave, wave + 1);
+      }
+    }
+  }
+}
+
+void ThreadedRecurrentNetworkExecutor::Schedule(OpTask task) {
+  if (wavefront_) {
+    task.wave = waves_[task.timestep * timestep_ops_template_.size() +
+                       task.op_idx];
+  }
+  task_queue_.Push(task);
+}
+
 /**
  * Runs a single op and updates its dependencies when finished. If
  * dependent ops are ready to run, adds them to the task_queue.
@@ -134,7 +229,7 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
     }
 
     if (proc_inputs == num_req_inputs || num_req_inputs == 0) {
-      task_queue_.Push(OpTask(t, depidx, job.T, job.direction));
+      Schedule(OpTask(t, depidx, job.T, job.direction));
     }
   }
 
@@ -156,27 +251,30 @@ void ThreadedRecurrentNetworkExecutor::WorkerFunction() {
   static std::atomic<int> seq(0);
   int id = seq.fetch_add(1);
 
+  // Check for limited timestep parallelism: a task must not start too many
+  // timesteps ahead of the last finished one.
+  auto runnable = [this](const OpTask& job) {
+    if (max_parallel_timesteps_ <= 0) {
+      return true;
+    }
+    int t = (job.direction == 1 ? job.timestep : job.T - job.timestep + 1);
+    return t - finished_timesteps_ < max_parallel_timesteps_;
+  };
+
   while (!failed_) {
     OpTask job;
-    if (!task_queue_.Pop(&job)) {
+    if (!task_queue_.Pop(&job, runnable)) {
       break;
     }
 
-    // Check for limited timestep parallelism, and if too many timesteps would
-    // be started concurrently, return the task to task queue.
-    if (max_parallel_timesteps_ > 0) {
-      int t = (job.direction == 1 ? job.timestep : job.T - job.timestep + 1);
-      if (t - finished_timesteps_ >= max_parallel_timesteps_) {
-        // Return to queue
-        task_queue_.Push(job);
-        continue;
-      }
-    }
-
     try {
       RunOp(job, id);
       if (job.op_idx == timestep_ops_template_.size() - 1) {
         finished_timesteps_.fetch_add(1);
+        // Tasks of a later timestep may be runnable now
+        if (max_parallel_timesteps_ > 0) {
+          task_queue_.Notify();
+        }
       }
       num_jobs++;
     } catch (::caffe2::EnforceNotMet& enf) {
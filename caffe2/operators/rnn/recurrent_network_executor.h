@@ -1,7 +1,11 @@
 #ifndef CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_H_
 #define CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_H_
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
@@ -476,6 +480,33 @@ std::unique_ptr<RecurrentNetworkExecutorBase> createRNNExecutor(
     std::string timestep_blob,
     ArgumentHelper rnn_args);
 
+/**
+ * Task queue of ThreadedRecurrentNetworkExecutor. Hands out tasks in FIFO
+ * order, or in wavefront order when tasks are pushed with a wave: tasks of
+ * lower waves first, and tasks of the same wave in FIFO order.
+ */
+class CAFFE2_API RNNTaskQueue {
+ public:
+  void Push(const OpTask& task);
+
+  // Pops the first task for which runnable() holds, waiting until there is
+  // one. Returns false once NoMoreJobs() was called and no task is runnable.
+  bool Pop(OpTask* task, const std::function<bool(const OpTask&)>& runnable);
+
+  // Wakes the waiting Pop() calls after runnable() may have changed.
+  void Notify();
+
+  int size();
+
+  void NoMoreJobs();
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<OpTask> tasks_;
+  bool no_more_jobs_ = false;
+};
+
 class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecutorBase {
  public:
   ThreadedRecurrentNetworkExecutor(
@@ -505,6 +536,16 @@ class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecu
     num_threads_ = n;
   }
 
+  /**
+   * With wavefront scheduling, ready ops run in the order of the earliest
+   * step at which they could start on an unbounded number of threads, rather
+   * than in the order they became ready. For stacked layers this runs the
+   * diagonal of (timestep, layer) cells that is on the critical path first.
+   */
+  void setWavefrontScheduling(bool wavefront) {
+    wavefront_ = wavefront;
+  }
+
  private:
   void _ExecRange(int from, int to);
 
@@ -514,7 +555,11 @@ class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecu
 
   void RunOp(OpTask job, int thread_id);
 
-  SimpleQueue<OpTask> task_queue_;
+  void ComputeWaves(int T, int direction);
+
+  void Schedule(OpTask task);
+
+  RNNTaskQueue task_queue_;
   std::atomic<int> countdown_;
   std::atomic<bool> failed_;
   std::atomic<int> finished_timesteps_;
@@ -523,6 +568,9 @@ class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecu
   std::condition_variable cv_;
   std::vector<std::thread> workers_;
   int num_threads_ = 4;
+  bool wavefront_ = false;
+  // Wave of each op of each timestep, indexed by t * num ops + op.
+  std::vector<int> waves_;
 };
 
 } // namespace caffe2
@@ -54,6 +54,7 @@ struct OpTask {
   int T; // number of timesteps in this execution
   int direction; // +1 for forward, -1 for backward pass
   int stream_id = -1; // only used by gpu version
+  int wave = 0; // only used with wavefront scheduling on cpu
   OpTask() {}
   OpTask(int _timestep, int _op_idx, int _T, int _direction)
       : timestep(_timestep), op_idx(_op_idx), T(_T), direction(_direction) {
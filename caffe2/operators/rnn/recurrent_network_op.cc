@@ -1,4 +1,9 @@
 #include "caffe2/operators/rnn/recurrent_network_op.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "caffe2/core/workspace.h"
 #include "caffe2/utils/proto_utils.h"
 
@@ -149,6 +154,64 @@ void PrependOps(std::vector<OperatorDef> ops, NetDef* netdef) {
   }
 }
 
+namespace {
+
+OperatorDef ApplyLinkOpDef(
+    const Link& link,
+    const std::string& timestep,
+    const DeviceOption& device_option) {
+  OperatorDef opdef;
+  opdef.set_type("rnn_internal_apply_link");
+  opdef.add_input(timestep);
+  opdef.add_input(link.external);
+  opdef.add_output(link.internal);
+  opdef.add_output(link.external);
+  opdef.mutable_device_option()->CopyFrom(device_option);
+
+  Argument* offset_arg = opdef.add_arg();
+  offset_arg->set_name("offset");
+  offset_arg->set_i(link.offset);
+
+  Argument* window_arg = opdef.add_arg();
+  window_arg->set_name("window");
+  window_arg->set_i(link.window);
+  return opdef;
+}
+
+// Whether the op computes each row of the outermost dimension of its
+// sequence inputs independently of the other rows. is_sequence tells which
+// inputs are sequences, the others are the same for all timesteps.
+bool IsRowwiseOp(const OperatorDef& op, const std::vector<bool>& is_sequence) {
+  ArgumentHelper args(op);
+  const auto& type = op.type();
+  if (type == "FC" || type == "FCTransposed") {
+    // Flattening at axis 0 would mix the timesteps.
+    return args.GetSingleArgument<int>("axis", 1) >= 1 &&
+        std::find(is_sequence.begin() + 1, is_sequence.end(), true) ==
+        is_sequence.end();
+  }
+  if (type == "Relu" || type == "Sigmoid" || type == "Tanh" ||
+      type == "Scale" || type == "Sum") {
+    // Sum doesn't broadcast, all inputs have the same shape.
+    return std::all_of(
+               is_sequence.begin(),
+               is_sequence.end(),
+               [](bool s) { return s; }) ||
+        std::none_of(
+               is_sequence.begin(),
+               is_sequence.end(),
+               [](bool s) { return s; });
+  }
+  if (type == "Add" || type == "Sub" || type == "Mul") {
+    // Parameters are broadcast along the trailing dimensions, unless an
+    // explicit axis says otherwise.
+    return !args.HasArgument("axis");
+  }
+  return false;
+}
+
+} // namespace
+
 void AddApplyLinkOps(
     const vector<Link>& links,
     std::string timestep,
@@ -156,21 +219,7 @@ void AddApplyLinkOps(
     NetDef* netdef) {
   std::vector<OperatorDef> ops;
   for (auto& link : links) {
-    OperatorDef opdef;
-    opdef.set_type("rnn_internal_apply_link");
-    opdef.add_input(timestep);
-    opdef.add_input(link.external);
-    opdef.add_output(link.internal);
-    opdef.add_output(link.external);
-    opdef.mutable_device_option()->CopyFrom(device_option);
-
-    Argument* offset_arg = opdef.add_arg();
-    offset_arg->set_name("offset");
-    offset_arg->set_i(link.offset);
-
-    Argument* window_arg = opdef.add_arg();
-    window_arg->set_name("window");
-    window_arg->set_i(link.window);
+    OperatorDef opdef = ApplyLinkOpDef(link, timestep, device_option);
 
     // Find out if the linked blob is used first as an output: then we need
     // to add control_input to that op
@@ -194,6 +243,113 @@ void AddApplyLinkOps(
   detail::PrependOps(ops, netdef);
 }
 
+TimestepInvariantOps ExtractTimestepInvariantOps(
+    const std::vector<Link>& links,
+    const std::string& timestep,
+    NetDef* step_net) {
+  TimestepInvariantOps result;
+  result.net.set_name(step_net->name() + "_rnnexec_precompute");
+  result.net.set_type("simple");
+  if (step_net->has_device_option()) {
+    result.net.mutable_device_option()->CopyFrom(step_net->device_option());
+  }
+
+  std::unordered_map<std::string, int> num_writers;
+  for (const auto& op : step_net->op()) {
+    if (op.type() == "rnn_internal_apply_link") {
+      continue;
+    }
+    for (const auto& output : op.output()) {
+      num_writers[output]++;
+    }
+  }
+  std::unordered_set<std::string> linked;
+  std::unordered_set<std::string> states;
+  for (const auto& link : links) {
+    linked.insert(link.internal);
+    if (num_writers.count(link.internal)) {
+      states.insert(link.external);
+    }
+  }
+
+  // Step net blobs that are available for all timesteps at once, mapped to
+  // the blob that holds them.
+  std::unordered_map<std::string, std::string> sequences;
+  for (const auto& link : links) {
+    if (link.window != 1 || num_writers.count(link.internal) ||
+        states.count(link.external) || sequences.count(link.internal)) {
+      continue;
+    }
+    OffsetAlias input;
+    input.src = link.external;
+    input.dst = link.internal + "_rnnexec_seq";
+    input.offset = link.offset;
+    sequences[link.internal] = input.dst;
+    result.inputs.push_back(input);
+  }
+  // Outputs of moved ops that are the same for all timesteps.
+  std::unordered_set<std::string> invariant;
+
+  std::vector<OperatorDef> step_ops;
+  for (const auto& op : step_net->op()) {
+    bool movable = op.type() != "rnn_internal_apply_link" &&
+        op.control_input_size() == 0 && op.input_size() > 0;
+    std::vector<bool> is_sequence;
+    for (const auto& input : op.input()) {
+      is_sequence.push_back(sequences.count(input) > 0);
+      movable = movable &&
+          (is_sequence.back() ||
+           (input != timestep && !linked.count(input) &&
+            (!num_writers.count(input) || invariant.count(input))));
+    }
+    for (const auto& output : op.output()) {
+      movable = movable && num_writers[output] == 1 &&
+          !linked.count(output) && !HasInput(op, output);
+    }
+    if (!movable || !IsRowwiseOp(op, is_sequence)) {
+      step_ops.push_back(op);
+      continue;
+    }
+
+    if (std::none_of(
+            is_sequence.begin(), is_sequence.end(), [](bool s) {
+              return s;
+            })) {
+      for (const auto& output : op.output()) {
+        invariant.insert(output);
+      }
+      result.net.add_op()->CopyFrom(op);
+      continue;
+    }
+
+    OperatorDef sequence_op = op;
+    for (int i = 0; i < op.input_size(); ++i) {
+      if (is_sequence[i]) {
+        sequence_op.set_input(i, sequences[op.input(i)]);
+      }
+    }
+    for (int i = 0; i < op.output_size(); ++i) {
+      Link link;
+      link.internal = op.output(i);
+      link.external = op.output(i) + "_rnnexec_all";
+      sequence_op.set_output(i, link.external);
+      sequences[link.internal] = link.external;
+      result.outputs.push_back(link.external);
+
+      // The step net only picks the row of its timestep.
+      step_ops.push_back(ApplyLinkOpDef(link, timestep, op.device_option()));
+      step_net->add_external_input(link.external);
+    }
+    result.net.add_op()->CopyFrom(sequence_op);
+  }
+
+  step_net->mutable_op()->Clear();
+  for (const auto& op : step_ops) {
+    step_net->add_op()->CopyFrom(op);
+  }
+  return result;
+}
+
 void extractLinks(
     OperatorBase* op,
     const std::string& internalArg,
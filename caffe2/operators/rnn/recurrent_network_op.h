@@ -166,6 +166,34 @@ CAFFE2_API void AddApplyLinkOps(
     const DeviceOption& device_option,
     NetDef* netdef);
 
+/**
+ * Ops of the step net that are computed once for all timesteps before the
+ * step net runs, see ExtractTimestepInvariantOps.
+ */
+struct TimestepInvariantOps {
+  NetDef net;
+  // Views of the sequence inputs starting at timestep 0, read by `net`.
+  std::vector<OffsetAlias> inputs;
+  // Outputs of `net` that hold one step net blob for all timesteps.
+  std::vector<std::string> outputs;
+};
+
+/**
+ * Moves the ops of the step net that don't depend on the recurrent states
+ * into a separate net. Ops that read a sequence input (i.e. an input link
+ * that no op writes to) are rewritten to run on the whole sequence at once,
+ * and are replaced in the step net by a link to their timestep of the
+ * result. Ops that only read parameters are run once as they are.
+ *
+ * Only ops that compute each row of the outermost dimension independently
+ * are moved, so that running them on T x N x D inputs gives the same
+ * result as running them T times on 1 x N x D.
+ */
+CAFFE2_API TimestepInvariantOps ExtractTimestepInvariantOps(
+    const std::vector<Link>& links,
+    const std::string& timestep,
+    NetDef* step_net);
+
 CAFFE2_API void extractLinks(
     OperatorBase* op,
     const std::string& internalArg,
@@ -205,6 +233,14 @@ class RecurrentNetworkOp final : public Operator<Context> {
         links_, timestep_, operator_def.device_option(), &stepNetDef_);
 
     if (FLAGS_caffe2_rnn_executor && enable_rnn_executor_) {
+      // Sequence parallel mode: ops that don't depend on the recurrent
+      // states run once over the whole sequence instead of per timestep.
+      if (std::is_same<Context, CPUContext>::value &&
+          this->template GetSingleArgument<bool>(
+              "rnn_executor.sequence_parallel", false)) {
+        invariantOps_ = detail::ExtractTimestepInvariantOps(
+            links_, timestep_, &stepNetDef_);
+      }
       InitializeExecutor(operator_def);
     }
   }
@@ -321,6 +357,13 @@ class RecurrentNetworkOp final : public Operator<Context> {
     // have to be stored in step workspaces but can be shared.
     initializeBlobsToRecomputeOnBackward(sharedBlobsWs.get());
 
+    // Must run before the step ops are created, so that they find the
+    // precomputed blobs in the shared workspace.
+    if (seqLen > 0 && invariantOps_.net.op_size() > 0 &&
+        !RunTimestepInvariantOps<T>(seqLen, sharedBlobsWs.get())) {
+      return false;
+    }
+
     if (has_backward_pass && seqLen > stepWorkspaces.size()) {
       stepWorkspaces.resize(seqLen);
     }
@@ -403,6 +446,7 @@ class RecurrentNetworkOp final : public Operator<Context> {
   std::vector<detail::RecurrentInput> recurrentInputs_;
   std::string timestep_;
   OperatorDef operator_def_;
+  detail::TimestepInvariantOps invariantOps_;
 
  private:
   void InitializeExecutor(const OperatorDef& operator_def) {
@@ -412,6 +456,34 @@ class RecurrentNetworkOp final : public Operator<Context> {
     rnnExecutor_ = createRNNExecutor<Context>(
         stepNetDef_, recurrent_map, timestep_, ArgumentHelper(operator_def));
   }
+
+  template <typename T>
+  bool RunTimestepInvariantOps(int32_t seqLen, Workspace* ws) {
+    for (const auto& input : invariantOps_.inputs) {
+      ws->CreateBlob(input.dst);
+      detail::applyOffsetAlias<T, Context>(input, ws, &context_);
+    }
+    auto* net = ws->GetNet(invariantOps_.net.name());
+    if (net == nullptr) {
+      net = ws->CreateNet(invariantOps_.net);
+    }
+    CAFFE_ENFORCE(net, "Precompute net construction failure");
+    if (!net->Run()) {
+      return false;
+    }
+    for (const auto& output : invariantOps_.outputs) {
+      const auto& tensor = ws->GetBlob(output)->template Get<Tensor>();
+      CAFFE_ENFORCE(tensor.template IsType<T>(), output);
+      CAFFE_ENFORCE_GE(tensor.dim(), 1, output);
+      CAFFE_ENFORCE_GE(
+          tensor.size(0),
+          seqLen,
+          "Precomputed blob ",
+          output,
+          " doesn't have a row per timestep");
+    }
+    return true;
+  }
 };
 
 template <class Context>
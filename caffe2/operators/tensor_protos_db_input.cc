@@ -19,6 +19,12 @@ corresponding index in the TensorProtos objects in the DB.
   .Arg("batch_size", "(int, default 0) the number of samples in a batch. The "
        "default value of 0 means that the operator will attempt to insert the "
        "entire data in a single output blob.")
+  .Arg("readahead_batches", "(int, default 0) if positive, the number of "
+       "batches that are read and decoded ahead of their use by a set of "
+       "reader threads. The records are read from the shared cursor of the "
+       "DB reader, starting at its current position.")
+  .Arg("decode_threads", "(int, default 4) the number of reader threads "
+       "used with readahead_batches.")
   .Input(0, "data", "A pre-initialized DB reader. Typically, this is obtained "
          "by calling CreateDB operator with a db_name and a db_type. The "
          "resulting output blob is a DB Reader tensor")
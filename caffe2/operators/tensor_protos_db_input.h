@@ -1,10 +1,12 @@
 #ifndef CAFFE2_OPERATORS_TENSOR_PROTOS_DB_INPUT_H_
 #define CAFFE2_OPERATORS_TENSOR_PROTOS_DB_INPUT_H_
 
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 
 #include "caffe2/core/db.h"
+#include "caffe2/core/readahead_db_reader.h"
 #include "caffe2/operators/prefetch_op.h"
 
 namespace caffe2 {
@@ -23,12 +25,23 @@ class TensorProtosDBInput final : public PrefetchOperator<Context> {
   bool CopyPrefetched() override;
 
  private:
+  bool PrefetchReadahead();
+  void DecodeRecord(const string& value, vector<Tensor>* tensors) const;
+
   // Prefetch will always just happen on the CPU side.
   vector<Blob> prefetched_blobs_;
   int batch_size_;
   bool shape_inferred_ = false;
   string key_;
   string value_;
+
+  // With readahead_batches > 0, records are read and decoded by a
+  // ReadaheadDBReader into readahead_items_[slot][item].
+  int readahead_batches_;
+  int decode_threads_;
+  vector<vector<vector<Tensor>>> readahead_items_;
+  const db::DBReader* readahead_source_ = nullptr;
+  unique_ptr<db::ReadaheadDBReader> readahead_;
 };
 
 template <class Context>
@@ -38,10 +51,20 @@ TensorProtosDBInput<Context>::TensorProtosDBInput(
     : PrefetchOperator<Context>(operator_def, ws),
       prefetched_blobs_(operator_def.output_size()),
       batch_size_(
-          this->template GetSingleArgument<int>("batch_size", 0)) {}
+          this->template GetSingleArgument<int>("batch_size", 0)),
+      readahead_batches_(
+          this->template GetSingleArgument<int>("readahead_batches", 0)),
+      decode_threads_(
+          this->template GetSingleArgument<int>("decode_threads", 4)) {
+  CAFFE_ENFORCE_GE(readahead_batches_, 0);
+  CAFFE_ENFORCE_GT(decode_threads_, 0);
+}
 
 template <class Context>
 bool TensorProtosDBInput<Context>::Prefetch() {
+  if (readahead_batches_ > 0) {
+    return PrefetchReadahead();
+  }
   const db::DBReader& reader = this->template Input<db::DBReader>(0);
   TensorDeserializer deserializer;
   if (batch_size_ == 0) {
@@ -92,6 +115,79 @@ bool TensorProtosDBInput<Context>::Prefetch() {
   return true;
 }
 
+template <class Context>
+void TensorProtosDBInput<Context>::DecodeRecord(
+    const string& value,
+    vector<Tensor>* tensors) const {
+  TensorProtos protos;
+  CAFFE_ENFORCE(protos.ParseFromString(value));
+  CAFFE_ENFORCE(protos.protos_size() == OutputSize());
+  TensorDeserializer deserializer;
+  tensors->clear();
+  for (int i = 0; i < protos.protos_size(); ++i) {
+    if (protos.protos(i).has_device_detail()) {
+      protos.mutable_protos(i)->clear_device_detail();
+    }
+    tensors->push_back(deserializer.Deserialize(protos.protos(i)));
+  }
+}
+
+template <class Context>
+bool TensorProtosDBInput<Context>::PrefetchReadahead() {
+  const db::DBReader& reader = this->template Input<db::DBReader>(0);
+  const int batch_size = std::max(batch_size_, 1);
+  if (readahead_source_ != &reader) {
+    readahead_.reset();
+    readahead_items_.assign(
+        readahead_batches_, vector<vector<Tensor>>(batch_size));
+    readahead_.reset(new db::ReadaheadDBReader(
+        reader,
+        batch_size,
+        readahead_batches_,
+        decode_threads_,
+        [this](const string& /* key */,
+               const string& value,
+               int slot,
+               int item) {
+          DecodeRecord(value, &readahead_items_[slot][item]);
+        }));
+    readahead_source_ = &reader;
+  }
+
+  const int slot = readahead_->Next();
+  auto& items = readahead_items_[slot];
+  try {
+    for (int i = 0; i < OutputSize(); ++i) {
+      if (batch_size_ == 0) {
+        BlobSetTensor(&prefetched_blobs_[i], std::move(items[0][i]));
+        continue;
+      }
+      const Tensor& first = items[0][i];
+      vector<int64_t> dims = first.sizes().vec();
+      dims.insert(dims.begin(), batch_size_);
+      Tensor* dst = BlobGetMutableTensor(
+          &prefetched_blobs_[i], dims, at::dtype(first.dtype()).device(CPU));
+      for (int item_id = 0; item_id < batch_size_; ++item_id) {
+        const Tensor& src = items[item_id][i];
+        CAFFE_ENFORCE(
+            src.sizes() == first.sizes() && src.dtype() == first.dtype(),
+            "All records of a batch need the same shapes and types.");
+        this->context_.CopyItemsSameDevice(
+            src.dtype(),
+            src.numel(),
+            src.raw_data(),
+            static_cast<char*>(dst->raw_mutable_data(src.dtype())) +
+                src.nbytes() * item_id);
+      }
+    }
+  } catch (...) {
+    readahead_->Release(slot);
+    throw;
+  }
+  readahead_->Release(slot);
+  return true;
+}
+
 template <class Context>
 bool TensorProtosDBInput<Context>::CopyPrefetched() {
   for (int i = 0; i < OutputSize(); ++i) {
@@ -0,0 +1,64 @@
+#include "caffe2/opt/memory_planning.h"
+
+#include "caffe2/core/types.h"
+#include "caffe2/opt/bound_shape_inferencer.h"
+
+namespace caffe2 {
+
+BlobSizeMap InferBlobSizes(
+    const NetDef& net,
+    const ShapeInfoMap& input_info,
+    int64_t max_batch_size,
+    int64_t max_seq_size,
+    Workspace* ws) {
+  BoundShapeInferencer inferencer(BoundShapeSpec(max_batch_size, max_seq_size));
+  inferencer.InferBoundShapeAndType(net, input_info, ws);
+
+  BlobSizeMap sizes;
+  for (const auto& kv : inferencer.shape_info()) {
+    const auto& shape = kv.second.shape;
+    if (shape.unknown_shape() ||
+        shape.data_type() == TensorProto_DataType_UNDEFINED ||
+        shape.data_type() == TensorProto_DataType_ZERO_COLLISION_HASH) {
+      continue;
+    }
+    size_t numel = 1;
+    for (const auto dim : shape.dims()) {
+      numel *= dim;
+    }
+    const auto& dtype = DataTypeToTypeMeta(shape.data_type());
+    sizes[kv.first] = {dtype, numel * dtype.itemsize()};
+  }
+  return sizes;
+}
+
+std::shared_ptr<MemoryPlan> PlanNetMemory(
+    const NetDef& net,
+    const ShapeInfoMap& input_info,
+    const std::vector<int64_t>& max_batch_sizes,
+    int64_t max_seq_size,
+    Workspace* ws) {
+  std::string batch_blob;
+  for (const auto& input : net.external_input()) {
+    auto it = input_info.find(input);
+    if (it != input_info.end() && it->second.shape.dims_size() > 0 &&
+        it->second.getDimType(0) == TensorBoundShape_DimType_BATCH) {
+      batch_blob = input;
+      break;
+    }
+  }
+  CAFFE_ENFORCE(
+      !batch_blob.empty(),
+      "Net ",
+      net.name(),
+      " has no external input with a BATCH first dimension");
+
+  std::unordered_map<int64_t, BlobSizeMap> buckets;
+  for (const auto max_batch_size : max_batch_sizes) {
+    buckets[max_batch_size] =
+        InferBlobSizes(net, input_info, max_batch_size, max_seq_size, ws);
+  }
+  return std::make_shared<MemoryPlan>(net, ws, batch_blob, buckets);
+}
+
+} // namespace caffe2
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/memory_planner.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/shape_info.h"
+#include "caffe2/proto/caffe2_pb.h"
+
+namespace caffe2 {
+
+// Bounds the size of every blob of `net` by running bound shape inference
+// with the given max batch and sequence sizes.
+CAFFE2_API BlobSizeMap InferBlobSizes(
+    const NetDef& net,
+    const ShapeInfoMap& input_info,
+    int64_t max_batch_size,
+    int64_t max_seq_size,
+    Workspace* ws);
+
+// Builds a memory plan for `net` with one arena layout per max batch size in
+// `max_batch_sizes`. The batch size of a run is read from the first external
+// input of the net whose first dimension is of BATCH type in `input_info`.
+CAFFE2_API std::shared_ptr<MemoryPlan> PlanNetMemory(
+    const NetDef& net,
+    const ShapeInfoMap& input_info,
+    const std::vector<int64_t>& max_batch_sizes,
+    int64_t max_seq_size,
+    Workspace* ws);
+
+} // namespace caffe2
@@ -1,5 +1,6 @@
 #include "caffe2/perfkernels/adagrad.h"
 
+#include <cfloat>
 #include <cmath>
 
 #include "caffe2/perfkernels/common.h"
@@ -168,4 +169,90 @@ void adagrad_fp16_update_prefetch(
       lr);
 }
 
+void rowwise_adagrad_fused_nbit_update__base(
+    int bit_rate,
+    int block_size,
+    std::uint8_t* row,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr,
+    bool stochastic_rounding,
+    std::uint32_t* rng_state,
+    float* scratch) {
+  float scale, bias;
+  internal::fused_nbit_rowwise_get_range(
+      bit_rate, block_size, row, &scale, &bias);
+
+  float hs = 0.;
+  for (auto j = 0; j < block_size; ++j) {
+    hs += g[j] * g[j];
+  }
+  const float hi = *h = *h + hs / block_size;
+  const float step = lr / (std::sqrt(hi) + epsilon);
+
+  float minimum = FLT_MAX;
+  float maximum = -FLT_MAX;
+  for (auto j = 0; j < block_size; ++j) {
+    const int q =
+        bit_rate == 8 ? row[j] : (row[j / 2] >> ((j % 2) * 4)) & 0xf;
+    const float w = q * scale + bias + step * g[j];
+    scratch[j] = w;
+    minimum = std::min(minimum, w);
+    maximum = std::max(maximum, w);
+  }
+
+  const float inverse_scale = internal::fused_nbit_rowwise_set_range(
+      bit_rate, block_size, row, minimum, maximum, &bias);
+  internal::fused_nbit_rowwise_quantize(
+      bit_rate,
+      0,
+      block_size,
+      scratch,
+      row,
+      bias,
+      inverse_scale,
+      stochastic_rounding,
+      rng_state);
+}
+
+decltype(rowwise_adagrad_fused_nbit_update__base)
+    rowwise_adagrad_fused_nbit_update__avx2_fma;
+void rowwise_adagrad_fused_nbit_update(
+    int bit_rate,
+    int block_size,
+    std::uint8_t* row,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr,
+    bool stochastic_rounding,
+    std::uint32_t* rng_state,
+    float* scratch) {
+  AVX2_FMA_DO(
+      rowwise_adagrad_fused_nbit_update,
+      bit_rate,
+      block_size,
+      row,
+      g,
+      h,
+      epsilon,
+      lr,
+      stochastic_rounding,
+      rng_state,
+      scratch);
+  BASE_DO(
+      rowwise_adagrad_fused_nbit_update,
+      bit_rate,
+      block_size,
+      row,
+      g,
+      h,
+      epsilon,
+      lr,
+      stochastic_rounding,
+      rng_state,
+      scratch);
+}
+
 } // namespace caffe2
@@ -7,6 +7,11 @@
 #endif
 #include <c10/util/Half.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 namespace caffe2 {
 
 namespace internal {
@@ -177,6 +182,140 @@ void adagrad_update(
     float decay,
     float lr);
 
+// Number of random streams used for stochastic rounding by
+// rowwise_adagrad_fused_nbit_update, one per AVX2 lane.
+constexpr int kRowwiseAdagradRngStreams = 8;
+
+// Row-wise Adagrad update of one row of a fused n-bit row-wise quantized
+// table, in place. The row holds block_size quantized values followed by
+// their scale and bias:
+//  - bit_rate 8: block_size bytes, then a float scale and a float bias, as
+//    produced by FloatToFused8BitRowwiseQuantized;
+//  - bit_rate 4: (block_size + 1) / 2 bytes with two values each, the even
+//    one in the low nibble, then an at::Half scale and an at::Half bias.
+// The row is dequantized, updated with
+//    h += mean(square(g))
+//    w += lr * g / (sqrt(h) + epsilon)
+// and quantized again to the range of the updated values. With
+// stochastic_rounding a value is rounded up with probability equal to its
+// fractional part, so that steps smaller than the quantization step are kept
+// in expectation; value j uses and advances the xorshift32 stream
+// rng_state[j % kRowwiseAdagradRngStreams]. Otherwise values are rounded to
+// nearest. scratch holds block_size floats.
+void rowwise_adagrad_fused_nbit_update(
+    int bit_rate,
+    int block_size,
+    std::uint8_t* row,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr,
+    bool stochastic_rounding,
+    std::uint32_t* rng_state,
+    float* scratch);
+
+// Size in bytes of a row of block_size values in the above format.
+static inline int fused_nbit_rowwise_row_size(int bit_rate, int block_size) {
+  return bit_rate == 8 ? block_size + 2 * sizeof(float)
+                       : (block_size + 1) / 2 + 2 * sizeof(at::Half);
+}
+
+namespace internal {
+
+// Scalar pieces of rowwise_adagrad_fused_nbit_update shared by all
+// implementations, so that they agree on the random numbers and rounding.
+
+static inline float rowwise_adagrad_rng_uniform(std::uint32_t* state) {
+  std::uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline void fused_nbit_rowwise_get_range(
+    int bit_rate,
+    int block_size,
+    const std::uint8_t* row,
+    float* scale,
+    float* bias) {
+  if (bit_rate == 8) {
+    float scale_bias[2];
+    std::memcpy(scale_bias, row + block_size, sizeof(scale_bias));
+    *scale = scale_bias[0];
+    *bias = scale_bias[1];
+  } else {
+    at::Half scale_bias[2];
+    std::memcpy(scale_bias, row + (block_size + 1) / 2, sizeof(scale_bias));
+    *scale = scale_bias[0];
+    *bias = scale_bias[1];
+  }
+}
+
+// Stores the scale and bias quantizing [minimum, maximum] into the row, the
+// same way as FloatToFused8BitRowwiseQuantized for 8 bits. Returns the
+// inverse scale.
+static inline float fused_nbit_rowwise_set_range(
+    int bit_rate,
+    int block_size,
+    std::uint8_t* row,
+    float minimum,
+    float maximum,
+    float* bias) {
+  const float levels = (1 << bit_rate) - 1;
+  if (bit_rate == 8) {
+    constexpr float kEpsilon = 1e-8f;
+    const float range = maximum - minimum;
+    const float scale_bias[2] = {range / levels, minimum};
+    std::memcpy(row + block_size, scale_bias, sizeof(scale_bias));
+    *bias = minimum;
+    return levels / (range + kEpsilon);
+  }
+  const at::Half half_bias = minimum;
+  at::Half scale = std::max(maximum - half_bias, 0.0f) / levels;
+  if (static_cast<float>(scale) == 0.0f) {
+    // Any scale works when all values are equal.
+    scale = 1.0f;
+  }
+  const at::Half scale_bias[2] = {scale, half_bias};
+  std::memcpy(row + (block_size + 1) / 2, scale_bias, sizeof(scale_bias));
+  *bias = half_bias;
+  return 1.0f / scale;
+}
+
+// Quantizes values [begin, end) of w into the row. begin must be even.
+static inline void fused_nbit_rowwise_quantize(
+    int bit_rate,
+    int begin,
+    int end,
+    const float* w,
+    std::uint8_t* row,
+    float bias,
+    float inverse_scale,
+    bool stochastic_rounding,
+    std::uint32_t* rng_state) {
+  const float levels = (1 << bit_rate) - 1;
+  for (auto j = begin; j < end; ++j) {
+    const float r = stochastic_rounding
+        ? rowwise_adagrad_rng_uniform(
+              &rng_state[j % kRowwiseAdagradRngStreams])
+        : 0.5f;
+    const float q = std::min(
+        std::max(std::floor((w[j] - bias) * inverse_scale + r), 0.0f),
+        levels);
+    if (bit_rate == 8) {
+      row[j] = q;
+    } else if (j % 2 == 0) {
+      row[j / 2] = q;
+    } else {
+      row[j / 2] |= static_cast<std::uint8_t>(q) << 4;
+    }
+  }
+}
+
+} // namespace internal
+
 } // namespace caffe2
 
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
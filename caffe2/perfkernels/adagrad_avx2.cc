@@ -0,0 +1,166 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <immintrin.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace caffe2 {
+
+namespace {
+
+constexpr int kSize = 8;
+
+// Loads values j..j+7 of a fused row, j being a multiple of 8.
+inline __m256 load_nbit(int bit_rate, const std::uint8_t* row, int j) {
+  if (bit_rate == 8) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + j))));
+  }
+  std::int32_t packed;
+  std::memcpy(&packed, row + j / 2, sizeof(packed));
+  const __m128i bytes = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+  const __m128i lo = _mm_and_si128(bytes, _mm_set1_epi32(0xf));
+  const __m128i hi = _mm_srli_epi32(bytes, 4);
+  return _mm256_cvtepi32_ps(_mm256_insertf128_si256(
+      _mm256_castsi128_si256(_mm_unpacklo_epi32(lo, hi)),
+      _mm_unpackhi_epi32(lo, hi),
+      1));
+}
+
+// Stores values j..j+7 of a fused row, j being a multiple of 8.
+inline void store_nbit(int bit_rate, std::uint8_t* row, int j, __m256i q) {
+  const __m128i q16 = _mm_packus_epi32(
+      _mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+  if (bit_rate == 8) {
+    _mm_storel_epi64(
+        reinterpret_cast<__m128i*>(row + j), _mm_packus_epi16(q16, q16));
+    return;
+  }
+  // Every 32-bit lane holds values 2k and 2k + 1 in its 16-bit halves.
+  const __m128i pairs = _mm_or_si128(
+      _mm_and_si128(q16, _mm_set1_epi32(0xffff)), _mm_srli_epi32(q16, 12));
+  const __m128i bytes =
+      _mm_packus_epi16(_mm_packus_epi32(pairs, pairs), _mm_setzero_si128());
+  const std::int32_t packed = _mm_cvtsi128_si32(bytes);
+  std::memcpy(row + j / 2, &packed, sizeof(packed));
+}
+
+// Vector version of internal::rowwise_adagrad_rng_uniform, lane l advancing
+// stream l.
+inline __m256 rng_uniform(__m256i* state) {
+  __m256i x = *state;
+  x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+  x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+  *state = x;
+  return _mm256_mul_ps(
+      _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)),
+      _mm256_set1_ps(1.0f / 16777216.0f));
+}
+
+inline float reduce_add(__m256 v) {
+  alignas(32) float buf[kSize];
+  _mm256_store_ps(buf, v);
+  float sum = 0;
+  for (auto i = 0; i < kSize; ++i) {
+    sum += buf[i];
+  }
+  return sum;
+}
+
+} // namespace
+
+void rowwise_adagrad_fused_nbit_update__avx2_fma(
+    int bit_rate,
+    int block_size,
+    std::uint8_t* row,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr,
+    bool stochastic_rounding,
+    std::uint32_t* rng_state,
+    float* scratch) {
+  static_assert(
+      kRowwiseAdagradRngStreams == kSize, "One random stream per lane");
+  float scale, bias;
+  internal::fused_nbit_rowwise_get_range(
+      bit_rate, block_size, row, &scale, &bias);
+
+  __m256 hs_v = _mm256_setzero_ps();
+  auto j = 0;
+  for (; j + kSize <= block_size; j += kSize) {
+    const __m256 g_v = _mm256_loadu_ps(g + j);
+    hs_v = _mm256_fmadd_ps(g_v, g_v, hs_v);
+  }
+  float hs = reduce_add(hs_v);
+  for (; j < block_size; ++j) {
+    hs += g[j] * g[j];
+  }
+  const float hi = *h = *h + hs / block_size;
+  const float step = lr / (std::sqrt(hi) + epsilon);
+
+  // Dequantize and update.
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  const __m256 bias_v = _mm256_set1_ps(bias);
+  const __m256 step_v = _mm256_set1_ps(step);
+  __m256 min_v = _mm256_set1_ps(FLT_MAX);
+  __m256 max_v = _mm256_set1_ps(-FLT_MAX);
+  for (j = 0; j + kSize <= block_size; j += kSize) {
+    __m256 w_v = _mm256_fmadd_ps(load_nbit(bit_rate, row, j), scale_v, bias_v);
+    w_v = _mm256_fmadd_ps(step_v, _mm256_loadu_ps(g + j), w_v);
+    _mm256_storeu_ps(scratch + j, w_v);
+    min_v = _mm256_min_ps(min_v, w_v);
+    max_v = _mm256_max_ps(max_v, w_v);
+  }
+  alignas(32) float min_buf[kSize], max_buf[kSize];
+  _mm256_store_ps(min_buf, min_v);
+  _mm256_store_ps(max_buf, max_v);
+  float minimum = FLT_MAX;
+  float maximum = -FLT_MAX;
+  for (auto i = 0; i < kSize; ++i) {
+    minimum = std::min(minimum, min_buf[i]);
+    maximum = std::max(maximum, max_buf[i]);
+  }
+  for (; j < block_size; ++j) {
+    const int q =
+        bit_rate == 8 ? row[j] : (row[j / 2] >> ((j % 2) * 4)) & 0xf;
+    const float w = q * scale + bias + step * g[j];
+    scratch[j] = w;
+    minimum = std::min(minimum, w);
+    maximum = std::max(maximum, w);
+  }
+
+  // Quantize again.
+  const float inverse_scale = internal::fused_nbit_rowwise_set_range(
+      bit_rate, block_size, row, minimum, maximum, &bias);
+  const __m256 new_bias_v = _mm256_set1_ps(bias);
+  const __m256 inverse_scale_v = _mm256_set1_ps(inverse_scale);
+  const __m256 levels_v = _mm256_set1_ps((1 << bit_rate) - 1);
+  __m256i state_v =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rng_state));
+  for (j = 0; j + kSize <= block_size; j += kSize) {
+    const __m256 r_v =
+        stochastic_rounding ? rng_uniform(&state_v) : _mm256_set1_ps(0.5f);
+    __m256 q_v = _mm256_floor_ps(_mm256_fmadd_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(scratch + j), new_bias_v),
+        inverse_scale_v,
+        r_v));
+    q_v = _mm256_min_ps(_mm256_max_ps(q_v, _mm256_setzero_ps()), levels_v);
+    store_nbit(bit_rate, row, j, _mm256_cvtps_epi32(q_v));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(rng_state), state_v);
+  internal::fused_nbit_rowwise_quantize(
+      bit_rate,
+      j,
+      block_size,
+      scratch,
+      row,
+      bias,
+      inverse_scale,
+      stochastic_rounding,
+      rng_state);
+}
+
+} // namespace caffe2
@@ -0,0 +1,202 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace caffe2 {
+
+namespace {
+
+void copyItems(
+    const TypeMeta& meta,
+    int64_t n,
+    const void* src,
+    void* dst) {
+  if (meta.copy()) {
+    meta.copy()(src, dst, n);
+  } else {
+    memcpy(dst, src, n * meta.itemsize());
+  }
+}
+
+// Copies rows [begin, begin + n) of src into a new tensor.
+Tensor sliceRows(const Tensor& src, int64_t begin, int64_t n) {
+  auto dims = src.sizes().vec();
+  dims[0] = n;
+  Tensor dst(dims, CPU);
+  const auto rowSize = src.size_from_dim(1);
+  copyItems(
+      src.dtype(),
+      n * rowSize,
+      static_cast<const char*>(src.raw_data()) +
+          begin * rowSize * src.itemsize(),
+      dst.raw_mutable_data(src.dtype()));
+  return dst;
+}
+
+} // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::shared_ptr<Predictor> predictor,
+    BatchingPredictorOptions options)
+    : predictor_(std::move(predictor)),
+      options_(options),
+      stats_(predictor_->def().name()) {
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  CAFFE_ENFORCE_GE(options_.timeout_us, 0);
+  worker_ = std::thread([this]() { run(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> g(mutex_);
+    closing_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+bool BatchingPredictor::operator()(
+    const TensorList& inputs,
+    TensorList* outputs) {
+  CAFFE_ENFORCE(!inputs.empty(), "Batched requests need at least one input");
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  request.rows = -1;
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE_GT(input.dim(), 0, "Batched inputs need a batch dimension");
+    if (request.rows < 0) {
+      request.rows = input.size(0);
+    }
+    CAFFE_ENFORCE_EQ(
+        input.size(0),
+        request.rows,
+        "All inputs of a request need the same batch size");
+  }
+  auto done = request.done.get_future();
+  {
+    std::lock_guard<std::mutex> g(mutex_);
+    CAFFE_ENFORCE(!closing_);
+    request.enqueued = std::chrono::steady_clock::now();
+    pending_.push_back(&request);
+  }
+  cv_.notify_one();
+  return done.get();
+}
+
+bool BatchingPredictor::compatible(const Request& a, const Request& b) {
+  if (a.inputs->size() != b.inputs->size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.inputs->size(); ++i) {
+    const auto& x = (*a.inputs)[i];
+    const auto& y = (*b.inputs)[i];
+    if (x.dtype() != y.dtype() || x.sizes().slice(1) != y.sizes().slice(1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BatchingPredictor::run() {
+  std::vector<Request*> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> g(mutex_);
+      cv_.wait(g, [this]() { return closing_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      // The oldest request may have waited while the previous batch ran.
+      const auto deadline = pending_.front()->enqueued +
+          std::chrono::microseconds(options_.timeout_us);
+      batch.clear();
+      int64_t rows = 0;
+      for (;;) {
+        while (!pending_.empty() &&
+               (batch.empty() ||
+                (compatible(*batch[0], *pending_.front()) &&
+                 rows + pending_.front()->rows <= options_.max_batch_size))) {
+          rows += pending_.front()->rows;
+          batch.push_back(pending_.front());
+          pending_.pop_front();
+        }
+        // Stop at a request that does not fit, once the batch is full or
+        // when the first request has waited long enough.
+        if (!pending_.empty() || rows >= options_.max_batch_size ||
+            closing_ || std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+        cv_.wait_until(g, deadline);
+      }
+      CAFFE_EVENT(stats_, batch_requests, batch.size());
+      CAFFE_EVENT(stats_, batch_rows, rows);
+    }
+    runBatch(batch);
+  }
+}
+
+void BatchingPredictor::runBatch(const std::vector<Request*>& batch) {
+  try {
+    int64_t rows = 0;
+    for (auto* request : batch) {
+      CAFFE_EVENT(stats_, queue_time_us, request->queued.MicroSeconds());
+      rows += request->rows;
+    }
+
+    TensorList inputs;
+    const auto& first = *batch[0]->inputs;
+    for (size_t i = 0; i < first.size(); ++i) {
+      if (batch.size() == 1) {
+        inputs.emplace_back(first[i].UnsafeSharedInstance());
+        continue;
+      }
+      auto dims = first[i].sizes().vec();
+      dims[0] = rows;
+      Tensor input(dims, CPU);
+      auto* dst = static_cast<char*>(input.raw_mutable_data(first[i].dtype()));
+      for (auto* request : batch) {
+        const auto& src = (*request->inputs)[i];
+        copyItems(src.dtype(), src.numel(), src.raw_data(), dst);
+        dst += src.nbytes();
+      }
+      inputs.push_back(std::move(input));
+    }
+
+    TensorList outputs;
+    if (!(*predictor_)(inputs, &outputs)) {
+      for (auto* request : batch) {
+        request->done.set_value(false);
+      }
+      return;
+    }
+    for (const auto& output : outputs) {
+      CAFFE_ENFORCE(
+          output.dim() > 0 && output.size(0) == rows,
+          "Batched outputs need one row per input row, got ",
+          output.sizes(),
+          " for ",
+          rows,
+          " rows");
+    }
+    int64_t begin = 0;
+    for (auto* request : batch) {
+      request->outputs->clear();
+      for (const auto& output : outputs) {
+        request->outputs->push_back(sliceRows(output, begin, request->rows));
+      }
+      begin += request->rows;
+    }
+  } catch (...) {
+    for (auto* request : batch) {
+      request->done.set_exception(std::current_exception());
+    }
+    return;
+  }
+  for (auto* request : batch) {
+    request->done.set_value(true);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+struct CAFFE2_API BatchingPredictorOptions {
+  // Largest number of rows run at once. A single request with more rows is
+  // still run, on its own.
+  int64_t max_batch_size = 64;
+  // How long the first request of a batch waits for others to join it.
+  int64_t timeout_us = 1000;
+};
+
+/**
+ * Front end of a Predictor that batches concurrent requests.
+ *
+ * Requests are queued and run by a single thread, which gathers requests
+ * for up to timeout_us after the first one arrives, concatenates their
+ * inputs along the first dimension, runs the net once and splits every
+ * output along its first dimension again. Requests are compatible if they
+ * have the same number of inputs and each input has the same type and inner
+ * dimensions; a batch ends at the first request that is not compatible with
+ * it.
+ *
+ * Every input of a request must have the same first dimension, which is its
+ * number of rows, and every output of the net must have one row per input
+ * row. This holds for nets whose operators treat the rows independently.
+ *
+ * Unlike Predictor, the outputs are owned by the caller.
+ */
+class CAFFE2_API BatchingPredictor {
+ public:
+  using TensorList = Predictor::TensorList;
+
+  BatchingPredictor(
+      std::shared_ptr<Predictor> predictor,
+      BatchingPredictorOptions options = BatchingPredictorOptions());
+  ~BatchingPredictor();
+
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+
+  // Same as Predictor::operator(), may be called from several threads at
+  // once. Returns false if the net failed; errors thrown while running the
+  // batch are rethrown to all of its requests.
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+
+  const BatchingPredictorOptions& options() const {
+    return options_;
+  }
+
+ private:
+  struct Request {
+    const TensorList* inputs;
+    TensorList* outputs;
+    int64_t rows;
+    Timer queued;
+    std::chrono::steady_clock::time_point enqueued;
+    std::promise<bool> done;
+  };
+
+  void run();
+  void runBatch(const std::vector<Request*>& batch);
+  static bool compatible(const Request& a, const Request& b);
+
+  std::shared_ptr<Predictor> predictor_;
+  const BatchingPredictorOptions options_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request*> pending_;
+  bool closing_ = false;
+  std::thread worker_;
+
+  struct BatchingPredictorStats {
+    CAFFE_STAT_CTOR(BatchingPredictorStats);
+    CAFFE_AVG_EXPORTED_STAT(batch_requests);
+    CAFFE_AVG_EXPORTED_STAT(batch_rows);
+    CAFFE_AVG_EXPORTED_STAT(queue_time_us);
+  } stats_;
+};
+
+} // namespace caffe2
@@ -0,0 +1,164 @@
+#include "caffe2/core/context.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/utils/math.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "simple"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "simple"
+        op {
+          type: "GaussianFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+Tensor randomTensor(const std::vector<int64_t>& dims, CPUContext* ctx) {
+  Tensor t(dims, CPU);
+  math::RandUniform<float, CPUContext>(
+      t.numel(), -1.0, 1.0, t.mutable_data<float>(), ctx);
+  return t;
+}
+
+} // namespace
+
+class BatchingPredictorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    DeviceOption op;
+    op.set_random_seed(1701);
+    ctx_ = std::make_unique<CPUContext>(op);
+    p_ = std::make_shared<Predictor>(
+        makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)));
+  }
+
+  // Runs the predictor on the request alone.
+  std::vector<float> expected(const Tensor& input) {
+    Predictor::TensorList inputs, outputs;
+    inputs.emplace_back(input.Alias());
+    CAFFE_ENFORCE((*p_)(inputs, &outputs));
+    const auto& y = outputs[0];
+    return std::vector<float>(y.data<float>(), y.data<float>() + y.numel());
+  }
+
+  std::unique_ptr<CPUContext> ctx_;
+  std::shared_ptr<Predictor> p_;
+};
+
+TEST_F(BatchingPredictorTest, ConcurrentRequests) {
+  const int kNumThreads = 8;
+  const int kNumRequests = 20;
+  std::vector<std::vector<Tensor>> inputs(kNumThreads);
+  std::vector<std::vector<std::vector<float>>> results(kNumThreads);
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int r = 0; r < kNumRequests; ++r) {
+      inputs[t].push_back(randomTensor({1 + (t + r) % 5, 4}, ctx_.get()));
+    }
+  }
+
+  {
+    BatchingPredictorOptions options;
+    options.max_batch_size = 12;
+    options.timeout_us = 2000;
+    BatchingPredictor predictor(p_, options);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (const auto& input : inputs[t]) {
+          Predictor::TensorList in, out;
+          in.emplace_back(input.Alias());
+          EXPECT_TRUE(predictor(in, &out));
+          ASSERT_EQ(out.size(), 1);
+          EXPECT_EQ(out[0].size(0), input.size(0));
+          EXPECT_EQ(out[0].size(1), 10);
+          results[t].emplace_back(
+              out[0].data<float>(), out[0].data<float>() + out[0].numel());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int r = 0; r < kNumRequests; ++r) {
+      const auto reference = expected(inputs[t][r]);
+      ASSERT_EQ(results[t][r].size(), reference.size());
+      for (size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(results[t][r][i], reference[i], 1e-5);
+      }
+    }
+  }
+}
+
+TEST_F(BatchingPredictorTest, MismatchedRequestsRunSeparately) {
+  BatchingPredictor predictor(p_);
+  // A request with the wrong inner dimension fails on its own.
+  auto badInput = randomTensor({2, 3}, ctx_.get());
+  std::thread bad([&]() {
+    Predictor::TensorList in, out;
+    in.emplace_back(badInput.Alias());
+    EXPECT_ANY_THROW(predictor(in, &out));
+  });
+  auto input = randomTensor({3, 4}, ctx_.get());
+  Predictor::TensorList in, out;
+  in.emplace_back(input.Alias());
+  EXPECT_TRUE(predictor(in, &out));
+  bad.join();
+  ASSERT_EQ(out.size(), 1);
+  const auto reference = expected(input);
+  for (size_t i = 0; i < reference.size(); ++i) {
+    EXPECT_NEAR(out[0].data<float>()[i], reference[i], 1e-5);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,170 @@
+from __future__ import absolute_import, division, print_function
+
+import unittest
+
+import caffe2.python.hypothesis_test_util as hu
+import hypothesis.strategies as st
+import numpy as np
+from caffe2.python import core, workspace
+from hypothesis import given, settings
+
+
+def quantize_ref(data, bit_rate):
+    levels = 2 ** bit_rate - 1
+    minimum = data.min(axis=1, keepdims=True)
+    maximum = data.max(axis=1, keepdims=True)
+    if bit_rate == 8:
+        scale = (maximum - minimum) / levels
+        bias = minimum
+        inverse_scale = levels / (maximum - minimum + 1e-8)
+    else:
+        bias = minimum.astype(np.float16).astype(np.float32)
+        scale = (
+            (np.maximum(maximum - bias, 0) / levels)
+            .astype(np.float16)
+            .astype(np.float32)
+        )
+        scale[scale == 0] = 1.0
+        inverse_scale = 1.0 / scale
+    quantized = np.clip(
+        np.floor((data - bias) * inverse_scale + 0.5), 0, levels
+    ).astype(np.uint8)
+    if bit_rate == 8:
+        scale_bias = np.concatenate([scale, bias], axis=1).astype(np.float32)
+        return np.concatenate([quantized, scale_bias.view(np.uint8)], axis=1)
+    if quantized.shape[1] % 2:
+        quantized = np.pad(quantized, ((0, 0), (0, 1)), "constant")
+    packed = quantized[:, 0::2] | (quantized[:, 1::2] << 4)
+    scale_bias = np.concatenate([scale, bias], axis=1).astype(np.float16)
+    return np.concatenate([packed, scale_bias.view(np.uint8)], axis=1)
+
+
+def dequantize_ref(fused, bit_rate, block_size):
+    if bit_rate == 8:
+        scale_bias = fused[:, -8:].copy().view(np.float32)
+        quantized = fused[:, :block_size].astype(np.float32)
+    else:
+        scale_bias = fused[:, -4:].copy().view(np.float16).astype(np.float32)
+        packed = fused[:, :-4]
+        quantized = np.stack([packed & 0xF, packed >> 4], axis=2).reshape(
+            fused.shape[0], -1
+        )[:, :block_size].astype(np.float32)
+    return quantized * scale_bias[:, :1] + scale_bias[:, 1:], scale_bias[:, :1]
+
+
+OPS = {
+    8: "RowWiseSparseAdagradFused8BitRowwise",
+    4: "RowWiseSparseAdagradFused4BitRowwise",
+}
+
+
+class TestAdagradFusedNBitRowwise(hu.HypothesisTestCase):
+    @given(
+        bit_rate=st.sampled_from([8, 4]),
+        num_rows=st.integers(1, 20),
+        block_size=st.integers(1, 40),
+        lr=st.floats(min_value=0.01, max_value=0.99),
+        seed=st.integers(0, 1000),
+    )
+    @settings(deadline=None, max_examples=50)
+    def test_update_matches_dequantized_adagrad(
+        self, bit_rate, num_rows, block_size, lr, seed
+    ):
+        np.random.seed(seed)
+        param = quantize_ref(
+            np.random.randn(num_rows, block_size).astype(np.float32), bit_rate
+        )
+        moment = np.abs(np.random.randn(num_rows)).astype(np.float32)
+        indices = np.random.choice(
+            num_rows, np.random.randint(1, num_rows + 1), replace=False
+        ).astype(np.int64)
+        grad = np.random.randn(len(indices), block_size).astype(np.float32)
+        lr = np.array([lr], dtype=np.float32)
+        epsilon = 1e-5
+
+        workspace.FeedBlob("param", param)
+        workspace.FeedBlob("moment", moment)
+        workspace.FeedBlob("indices", indices)
+        workspace.FeedBlob("grad", grad)
+        workspace.FeedBlob("lr", lr)
+        op = core.CreateOperator(
+            OPS[bit_rate],
+            ["param", "moment", "indices", "grad", "lr"],
+            ["param", "moment"],
+            epsilon=epsilon,
+            stochastic_rounding=False,
+        )
+        workspace.RunOperatorOnce(op)
+        param_out = workspace.FetchBlob("param")
+        moment_out = workspace.FetchBlob("moment")
+
+        weights, _ = dequantize_ref(param, bit_rate, block_size)
+        weights_out, scale_out = dequantize_ref(param_out, bit_rate, block_size)
+        moment_ref = moment.copy()
+        moment_ref[indices] += np.mean(np.square(grad), axis=1)
+        np.testing.assert_allclose(moment_out, moment_ref, rtol=1e-5, atol=1e-5)
+
+        untouched = np.setdiff1d(np.arange(num_rows), indices)
+        np.testing.assert_array_equal(param_out[untouched], param[untouched])
+        step = lr[0] / (np.sqrt(moment_ref[indices]) + epsilon)
+        weights_ref = weights[indices] + step[:, np.newaxis] * grad
+        # Rounded to nearest, up to the float rounding of the kernels.
+        error = np.abs(weights_out[indices] - weights_ref)
+        self.assertTrue(
+            np.all(error <= 0.501 * scale_out[indices] + 1e-4), error
+        )
+
+    def test_stochastic_rounding_is_unbiased(self):
+        np.random.seed(0)
+        block_size = 37
+        for bit_rate in [8, 4]:
+            # A fixed range keeps the quantization step the same across runs.
+            data = np.random.uniform(0.2, 0.8, (1, block_size)).astype(
+                np.float32
+            )
+            data[0, 0] = 0.0
+            data[0, 1] = 1.0
+            param = quantize_ref(data, bit_rate)
+            weights, scale = dequantize_ref(param, bit_rate, block_size)
+            grad = np.zeros((1, block_size), dtype=np.float32)
+            grad[0, 2:] = np.random.choice([-1, 1], block_size - 2)
+            lr = np.array([0.1 * scale[0, 0]], dtype=np.float32)
+
+            net = core.Net("stochastic_rounding")
+            net.Proto().op.extend(
+                [
+                    core.CreateOperator(
+                        OPS[bit_rate],
+                        ["param", "moment", "indices", "grad", "lr"],
+                        ["param", "moment"],
+                        epsilon=0.0,
+                    )
+                ]
+            )
+            workspace.FeedBlob("indices", np.array([0], dtype=np.int32))
+            workspace.FeedBlob("grad", grad)
+            workspace.FeedBlob("lr", lr)
+            workspace.FeedBlob("param", param)
+            workspace.FeedBlob("moment", np.zeros(1, dtype=np.float32))
+            workspace.CreateNet(net, overwrite=True)
+            num_runs = 2000
+            total = np.zeros(block_size, dtype=np.float64)
+            for _ in range(num_runs):
+                workspace.FeedBlob("param", param)
+                workspace.FeedBlob("moment", np.zeros(1, dtype=np.float32))
+                workspace.RunNet(net.Proto().name)
+                weights_out, _ = dequantize_ref(
+                    workspace.FetchBlob("param"), bit_rate, block_size
+                )
+                total += weights_out[0]
+            # Every step is about a tenth of a quantization step, which
+            # rounding to nearest would always lose.
+            step = lr[0] / np.sqrt(np.mean(np.square(grad)))
+            expected = weights[0] + step * grad[0]
+            np.testing.assert_allclose(
+                total / num_runs, expected, atol=0.05 * scale[0, 0]
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -9,12 +9,13 @@ import tempfile
 
 
 class TestIndexOps(TestCase):
-    def _test_index_ops(self, entries, dtype, index_create_op):
+    def _test_index_ops(self, entries, dtype, index_create_op, num_shards=1):
         workspace.RunOperatorOnce(core.CreateOperator(
             index_create_op,
             [],
             ['index'],
-            max_elements=10))
+            max_elements=10,
+            num_shards=num_shards))
         my_entries = np.array(
             [entries[0], entries[1], entries[2]], dtype=dtype)
 
@@ -76,7 +77,8 @@ class TestIndexOps(TestCase):
         workspace.RunOperatorOnce(core.CreateOperator(
             index_create_op,
             [],
-            ['index2']))
+            ['index2'],
+            num_shards=num_shards))
 
         workspace.RunOperatorOnce(core.CreateOperator(
             'IndexLoad',
@@ -132,6 +134,43 @@ class TestIndexOps(TestCase):
     def test_long_index_ops(self):
         self._test_index_ops(list(range(8)), np.int64, 'LongIndexCreate')
 
+    def test_sharded_index_ops(self):
+        self._test_index_ops([
+            'entry1', 'entry2', 'entry3', 'new_entry1',
+            'new_entry2', 'miss1', 'miss2', 'miss3',
+        ], str, 'StringIndexCreate', num_shards=4)
+        self._test_index_ops(
+            list(range(8)), np.int64, 'LongIndexCreate', num_shards=3)
+
+    def test_sharded_index_concurrent_get(self):
+        num_threads = 8
+        keys = np.arange(1000, dtype=np.int64)
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'LongIndexCreate', [], ['index'], num_shards=16))
+        net = core.Net('concurrent_index_get')
+        for i in range(num_threads):
+            # Every op looks up the same keys in a different order.
+            query = np.random.permutation(keys)
+            workspace.FeedBlob('query_{}'.format(i), query)
+            net.IndexGet(['index', 'query_{}'.format(i)], ['result_{}'.format(i)])
+        net.Proto().type = 'async_scheduling'
+        net.Proto().num_workers = num_threads
+        workspace.RunNetOnce(net)
+
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'IndexSize', ['index'], ['index_size']))
+        self.assertEqual(workspace.FetchBlob('index_size'), len(keys) + 1)
+        # All ops must agree on the id of every key.
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'IndexStore', ['index'], ['stored']))
+        stored = workspace.FetchBlob('stored')
+        np.testing.assert_array_equal(np.sort(stored), keys)
+        ids = {key: i + 1 for i, key in enumerate(stored)}
+        for i in range(num_threads):
+            query = workspace.FetchBlob('query_{}'.format(i))
+            result = workspace.FetchBlob('result_{}'.format(i))
+            np.testing.assert_array_equal(result, [ids[k] for k in query])
+
 if __name__ == "__main__":
     import unittest
     unittest.main()
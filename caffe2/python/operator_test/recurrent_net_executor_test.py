@@ -4,7 +4,9 @@ from __future__ import print_function
 from __future__ import unicode_literals
 
 from caffe2.proto import caffe2_pb2
-from caffe2.python import model_helper, workspace, core, rnn_cell, test_util
+from caffe2.python import (
+    model_helper, workspace, core, recurrent, rnn_cell, test_util
+)
 from caffe2.python.attention import AttentionType
 
 import numpy as np
@@ -218,6 +220,98 @@ class TestRNNExecutor(test_util.TestCase):
             model, _ = self.init_lstm_model(T, num_layers, forward_only)
             self._compare(model, forward_only)
 
+    def init_stacked_rnn_model(self, forward_only, sequence_parallel):
+        model = model_helper.ModelHelper(name="stacked_rnn")
+        input_blob, h1_init, h2_init = model.net.AddExternalInputs(
+            "input", "h1_init", "h2_init")
+
+        step = model_helper.ModelHelper(name="step", param_model=model)
+        input_t, h1_prev, h2_prev = step.net.AddExternalInput(
+            "input_t", "h1_prev", "h2_prev")
+        params = ["W_in", "b_in", "W_1", "b_1", "W_12", "b_12", "W_2", "b_2"]
+        step.net.AddExternalInput(*params)
+
+        # The input projection of the first layer and the bias of the second
+        # don't depend on the recurrent states.
+        proj_t = step.net.FC([input_t, "W_in", "b_in"], "proj_t", axis=2)
+        act_t = step.net.Tanh(proj_t, "act_t")
+        rec1_t = step.net.FC([h1_prev, "W_1", "b_1"], "rec1_t", axis=2)
+        h1 = step.net.Tanh(step.net.Sum([act_t, rec1_t], "sum1_t"), "h1")
+        b_2_relu = step.net.Relu("b_2", "b_2_relu")
+        in2_t = step.net.FC([h1, "W_12", "b_12"], "in2_t", axis=2)
+        rec2_t = step.net.FC([h2_prev, "W_2", b_2_relu], "rec2_t", axis=2)
+        h2 = step.net.Tanh(step.net.Sum([in2_t, rec2_t], "sum2_t"), "h2")
+        step.net.AddExternalOutput(h1, h2)
+
+        _, _, output, _ = recurrent.recurrent_net(
+            net=model.net,
+            cell_net=step.net,
+            inputs=[(input_t, input_blob)],
+            initial_cell_inputs=[(h1_prev, h1_init), (h2_prev, h2_init)],
+            links={h1_prev: h1, h2_prev: h2},
+            scope="stacked_rnn",
+            outputs_with_grads=[2],
+            forward_only=forward_only,
+        )
+        for op in model.net.Proto().op:
+            if op.type.startswith("RecurrentNetwork"):
+                recurrent.set_rnn_executor_config(
+                    op, num_threads=4, sequence_parallel=sequence_parallel)
+
+        if not forward_only:
+            loss = model.AveragedLoss(output, "loss")
+            model.AddGradientOperators([loss])
+
+        np.random.seed(10022015)
+        dims = {
+            "W_in": [self.hidden_dim, self.input_dim],
+            "W_1": [self.hidden_dim, self.hidden_dim],
+            "W_12": [self.hidden_dim, self.hidden_dim],
+            "W_2": [self.hidden_dim, self.hidden_dim],
+        }
+        for p in params:
+            workspace.FeedBlob(p, np.random.randn(
+                *dims.get(p, [self.hidden_dim])).astype(np.float32))
+        for init in [h1_init, h2_init]:
+            workspace.FeedBlob(init, np.random.randn(
+                1, self.batch_size, self.hidden_dim).astype(np.float32))
+        return model
+
+    @given(
+        T=st.integers(1, 20),
+        forward_only=st.booleans(),
+        **hu.gcs_cpu_only)
+    def test_sequence_parallel_equal_executor(self, T, forward_only, gc, dc):
+        '''
+        Test that precomputing the ops that don't depend on the recurrent
+        states and wavefront scheduling don't change the results.
+        '''
+        Tseq = [T, T // 2 + 1, T]
+        results = []
+        for sequence_parallel in [False, True]:
+            workspace.ResetWorkspace()
+            model = self.init_stacked_rnn_model(
+                forward_only, sequence_parallel)
+            np.random.seed(2603)
+            ws = {}
+            for j, seq_len in enumerate(Tseq):
+                workspace.FeedBlob("input", np.random.rand(
+                    seq_len, self.batch_size, self.input_dim
+                ).astype(np.float32))
+                if j == 0:
+                    workspace.CreateNet(model.net, overwrite=True)
+                workspace.RunNet(model.net.Proto().name)
+                for k in workspace.Blobs():
+                    v = workspace.FetchBlob(k)
+                    if type(v) is np.ndarray:
+                        ws[k + "." + str(j)] = v
+            results.append(ws)
+
+        self.assertEqual(sorted(results[0].keys()), sorted(results[1].keys()))
+        for k, v in results[0].items():
+            np.testing.assert_allclose(
+                v, results[1][k], rtol=1e-4, atol=1e-5, err_msg=k)
+
     def _compare(self, model, forward_only):
         # Store list of blobs that exist in the beginning
         workspace.RunNetOnce(model.param_init_net)
@@ -286,7 +286,13 @@ def recurrent_net(
     return results[:-1]
 
 
-def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None):
+def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None,
+                            sequence_parallel=None):
+    '''
+    sequence_parallel: on CPU, computes the ops of the step net that don't
+    depend on the recurrent states for all timesteps at once, and schedules
+    the remaining ops in wavefront order.
+    '''
     from caffe2.proto import caffe2_pb2
     assert rnn_op.type in {'RecurrentNetwork', 'RecurrentNetworkGradient'}
 
@@ -300,6 +306,8 @@ def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None):
         add_arg('num_threads', num_threads)
     if max_cuda_streams is not None:
         add_arg('max_cuda_streams', max_cuda_streams)
+    if sequence_parallel is not None:
+        add_arg('sequence_parallel', int(sequence_parallel))
 
 
 def retrieve_step_blobs(net, prefix='rnn'):
@@ -1,7 +1,9 @@
 #include "caffe2/queue/blobs_queue.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -102,6 +104,55 @@ bool BlobsQueue::blockingRead(
   return true;
 }
 
+bool BlobsQueue::blockingReadBatch(
+    const std::vector<Blob*>& outputs,
+    size_t numRecords,
+    float timeout_secs) {
+  CAFFE_ENFORCE_GT(numRecords, 0);
+  CAFFE_ENFORCE_LE(
+      numRecords, queue_.size(), "Cannot read more records than capacity");
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  std::unique_lock<std::mutex> g(mutex_);
+  auto canRead = [this, numRecords]() {
+    CAFFE_ENFORCE_LE(reader_, writer_);
+    return writer_ - reader_ >= static_cast<int64_t>(numRecords);
+  };
+  CAFFE_EVENT(stats_, queue_balance, -1);
+  if (timeout_secs > 0) {
+    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
+    cv_.wait_for(
+        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
+  } else {
+    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
+  }
+  // Once closed, hand out whatever is left.
+  const auto n = std::min<int64_t>(writer_ - reader_, numRecords);
+  if (n == 0 || (!closing_ && !canRead())) {
+    if (timeout_secs > 0 && !closing_) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+    } else {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+    }
+    return false;
+  }
+  std::vector<const std::vector<Blob*>*> records;
+  records.reserve(n);
+  for (int64_t i = 0; i < n; ++i) {
+    records.push_back(&queue_[(reader_ + i) % queue_.size()]);
+  }
+  collate(records, outputs);
+  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
+  CAFFE_EVENT(stats_, queue_dequeued_records, n);
+  reader_ += n;
+  cv_.notify_all();
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return true;
+}
+
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   Timer writeTimer;
   auto keeper = this->shared_from_this();
@@ -148,6 +199,54 @@ void BlobsQueue::close() {
   cv_.notify_all();
 }
 
+void BlobsQueue::collate(
+    const std::vector<const std::vector<Blob*>*>& records,
+    const std::vector<Blob*>& outputs) {
+  CAFFE_ENFORCE(!records.empty());
+  CAFFE_ENFORCE(outputs.size() >= numBlobs_);
+  for (size_t col = 0; col < numBlobs_; ++col) {
+    const auto& first = (*records[0])[col]->Get<Tensor>();
+    int64_t rows = 0;
+    for (const auto* record : records) {
+      const auto* blob = (*record)[col];
+      CAFFE_ENFORCE(
+          BlobIsTensorType(*blob, CPU),
+          "Only CPU tensors can be dequeued in batches, column ",
+          col);
+      const auto& in = blob->Get<Tensor>();
+      CAFFE_ENFORCE(
+          in.dim() > 0,
+          "Empty tensor to dequeue at column ",
+          col,
+          " within ",
+          numBlobs_,
+          " total columns");
+      CAFFE_ENFORCE(
+          in.dtype() == first.dtype(), "Mismatched types at column ", col);
+      CAFFE_ENFORCE(
+          in.sizes().slice(1) == first.sizes().slice(1),
+          "Mismatched inner dimensions at column ",
+          col);
+      rows += in.size(0);
+      CAFFE_EVENT(stats_, queue_dequeued_bytes, BlobStat::sizeBytes(*blob), col);
+    }
+    auto dims = first.sizes().vec();
+    dims[0] = rows;
+    auto* out = BlobGetMutableTensor(outputs[col], CPU);
+    out->Resize(dims);
+    auto* dst = static_cast<char*>(out->raw_mutable_data(first.dtype()));
+    for (const auto* record : records) {
+      const auto& in = (*record)[col]->Get<Tensor>();
+      if (in.dtype().copy()) {
+        in.dtype().copy()(in.raw_data(), dst, in.numel());
+      } else {
+        memcpy(dst, in.raw_data(), in.nbytes());
+      }
+      dst += in.nbytes();
+    }
+  }
+}
+
 bool BlobsQueue::canWrite() {
   // writer is always within [reader, reader + size)
   // we can write if reader is within [reader, reader + size)
@@ -30,23 +30,41 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
       bool enforceUniqueName,
       const std::vector<std::string>& fieldNames = {});
 
-  ~BlobsQueue() {
+  virtual ~BlobsQueue() {
     close();
   }
 
-  bool blockingRead(
+  virtual bool blockingRead(
       const std::vector<Blob*>& inputs,
       float timeout_secs = 0.0f);
-  bool tryWrite(const std::vector<Blob*>& inputs);
-  bool blockingWrite(const std::vector<Blob*>& inputs);
-  void close();
+  // Dequeues up to numRecords records at once and concatenates the tensors
+  // of every column along their first dimension into the matching output.
+  // Waits until numRecords records are available; fewer are returned only
+  // once the queue is closed. Only CPU tensors can be collated.
+  virtual bool blockingReadBatch(
+      const std::vector<Blob*>& outputs,
+      size_t numRecords,
+      float timeout_secs = 0.0f);
+  // Whether blockingReadBatch() collates the records without blocking the
+  // writers. This queue copies them while holding its mutex.
+  virtual bool hasConcurrentBatchRead() const {
+    return false;
+  }
+  virtual bool tryWrite(const std::vector<Blob*>& inputs);
+  virtual bool blockingWrite(const std::vector<Blob*>& inputs);
+  virtual void close();
   size_t getNumBlobs() const {
     return numBlobs_;
   }
+  size_t getCapacity() const {
+    return queue_.size();
+  }
 
- private:
-  bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+ protected:
+  // Copies the records into outputs, see blockingReadBatch().
+  void collate(
+      const std::vector<const std::vector<Blob*>*>& records,
+      const std::vector<Blob*>& outputs);
 
   std::atomic<bool> closing_{false};
 
@@ -66,5 +84,9 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
     CAFFE_AVG_EXPORTED_STAT(write_time_ns);
   } stats_;
+
+ private:
+  bool canWrite();
+  void doWrite(const std::vector<Blob*>& inputs);
 };
 } // namespace caffe2
@@ -17,7 +17,16 @@ REGISTER_CPU_OPERATOR(
     WeightedSampleDequeueBlobs,
     WeightedSampleDequeueBlobsOp<CPUContext>);
 
-OPERATOR_SCHEMA(CreateBlobsQueue).NumInputs(0).NumOutputs(1);
+OPERATOR_SCHEMA(CreateBlobsQueue)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("capacity", "(default 1) Maximum number of records in the queue")
+    .Arg("num_blobs", "(default 1) Number of blobs in every record")
+    .Arg(
+        "lock_free",
+        "(default false) If true, readers and writers claim records without "
+        "taking a lock, which scales better with many producer or consumer "
+        "threads.");
 OPERATOR_SCHEMA(EnqueueBlobs)
     .NumInputsOutputs([](int inputs, int outputs) {
       return inputs >= 2 && outputs >= 1 && inputs == outputs + 1;
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include "blobs_queue.h"
+#include "ring_blobs_queue.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/math.h"
 
@@ -24,12 +25,18 @@ class CreateBlobsQueueOp final : public Operator<Context> {
         GetSingleArgument("enforce_unique_name", false);
     const auto fieldNames =
         OperatorBase::template GetRepeatedArgument<std::string>("field_names");
+    const auto lockFree = GetSingleArgument("lock_free", false);
     CAFFE_ENFORCE_EQ(this->OutputSize(), 1);
     auto queuePtr = Operator<Context>::Outputs()[0]
                         ->template GetMutable<std::shared_ptr<BlobsQueue>>();
     CAFFE_ENFORCE(queuePtr);
-    *queuePtr = std::make_shared<BlobsQueue>(
-        ws_, name, capacity, numBlobs, enforceUniqueName, fieldNames);
+    if (lockFree) {
+      *queuePtr = std::make_shared<RingBlobsQueue>(
+          ws_, name, capacity, numBlobs, enforceUniqueName, fieldNames);
+    } else {
+      *queuePtr = std::make_shared<BlobsQueue>(
+          ws_, name, capacity, numBlobs, enforceUniqueName, fieldNames);
+    }
     return true;
   }
 
@@ -130,6 +137,17 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
   bool dequeueMany(std::shared_ptr<BlobsQueue>& queue) {
     auto size = queue->getNumBlobs();
 
+    // CPU records of a lock-free queue are collated by the queue in one go,
+    // straight out of its slots. This waits for numRecords records, where the
+    // loop below returns what it read before the queue was closed.
+    if (std::is_same<Context, CPUContext>::value &&
+        queue->hasConcurrentBatchRead() &&
+        static_cast<size_t>(numRecords_) <= queue->getCapacity()) {
+      std::vector<Blob*> outputs(
+          this->Outputs().begin(), this->Outputs().begin() + size);
+      return queue->blockingReadBatch(outputs, numRecords_);
+    }
+
     if (blobs_.size() != size) {
       blobs_.resize(size);
       blobPtrs_.resize(size);
@@ -0,0 +1,301 @@
+#include "caffe2/queue/ring_blobs_queue.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "caffe2/core/blob_stats.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/timer.h"
+
+namespace caffe2 {
+
+// Constants for user tracepoints
+static constexpr int SDT_NONBLOCKING_OP = 0;
+static constexpr int SDT_BLOCKING_OP = 1;
+static constexpr uint64_t SDT_TIMEOUT = (uint64_t)-1;
+static constexpr uint64_t SDT_ABORT = (uint64_t)-2;
+static constexpr uint64_t SDT_CANCEL = (uint64_t)-3;
+
+RingBlobsQueue::RingBlobsQueue(
+    Workspace* ws,
+    const std::string& queueName,
+    size_t capacity,
+    size_t numBlobs,
+    bool enforceUniqueName,
+    const std::vector<std::string>& fieldNames)
+    : BlobsQueue(
+          ws,
+          queueName,
+          capacity,
+          numBlobs,
+          enforceUniqueName,
+          fieldNames),
+      capacity_(capacity),
+      sequences_(new std::atomic<int64_t>[capacity]),
+      ringStats_(queueName) {
+  CAFFE_ENFORCE_GT(capacity, 0);
+  // A slot waiting for the record of position p has sequence 2 * p, and
+  // 2 * p + 1 once it holds that record. Unlike p and p + 1 these stay
+  // distinct from the next lap even for a capacity of one.
+  for (int64_t i = 0; i < capacity_; ++i) {
+    sequences_[i].store(2 * i, std::memory_order_relaxed);
+  }
+}
+
+bool RingBlobsQueue::blockingRead(
+    const std::vector<Blob*>& inputs,
+    float timeout_secs) {
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  // Decrease queue balance before reading to indicate queue read pressure
+  // is being increased (-ve queue balance indicates more reads than writes)
+  CAFFE_EVENT(stats_, queue_balance, -1);
+  size_t n = 0;
+  auto pos = tryClaimRead(1, false, &n);
+  if (pos < 0) {
+    Timer waitTimer;
+    wait(notEmpty_, readWaiters_, timeout_secs, [&]() {
+      pos = tryClaimRead(1, false, &n);
+      return pos >= 0;
+    });
+    CAFFE_EVENT(ringStats_, read_wait_time_ns, waitTimer.NanoSeconds());
+  }
+  if (pos < 0) {
+    if (timeout_secs > 0 && !closing_) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+    } else {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+    }
+    return false;
+  }
+  auto& result = queue_[pos % capacity_];
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  publishRead(pos, 1);
+  const auto queueDepth = depth();
+  CAFFE_SDT(queue_read_end, name, (void*)this, queueDepth);
+  CAFFE_EVENT(stats_, queue_dequeued_records);
+  CAFFE_EVENT(ringStats_, queue_depth, queueDepth);
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return true;
+}
+
+bool RingBlobsQueue::blockingReadBatch(
+    const std::vector<Blob*>& outputs,
+    size_t numRecords,
+    float timeout_secs) {
+  CAFFE_ENFORCE_GT(numRecords, 0);
+  CAFFE_ENFORCE_LE(
+      numRecords, getCapacity(), "Cannot read more records than capacity");
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  CAFFE_EVENT(stats_, queue_balance, -1);
+  size_t n = 0;
+  auto pos = tryClaimRead(numRecords, false, &n);
+  if (pos < 0) {
+    Timer waitTimer;
+    // Once closed, hand out whatever is left.
+    wait(notEmpty_, readWaiters_, timeout_secs, [&]() {
+      pos = tryClaimRead(numRecords, closing_, &n);
+      return pos >= 0;
+    });
+    CAFFE_EVENT(ringStats_, read_wait_time_ns, waitTimer.NanoSeconds());
+  }
+  if (pos < 0) {
+    if (timeout_secs > 0 && !closing_) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+    } else {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+    }
+    return false;
+  }
+  std::vector<const std::vector<Blob*>*> records;
+  records.reserve(n);
+  for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+    records.push_back(&queue_[(pos + i) % capacity_]);
+  }
+  // The slots have to be handed back even if the records do not collate.
+  try {
+    collate(records, outputs);
+  } catch (...) {
+    publishRead(pos, n);
+    throw;
+  }
+  publishRead(pos, n);
+  const auto queueDepth = depth();
+  CAFFE_SDT(queue_read_end, name, (void*)this, queueDepth);
+  CAFFE_EVENT(stats_, queue_dequeued_records, n);
+  CAFFE_EVENT(ringStats_, queue_depth, queueDepth);
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return true;
+}
+
+bool RingBlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
+  Timer writeTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  const auto pos = tryClaimWrite();
+  if (pos < 0) {
+    CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+    return false;
+  }
+  // Increase queue balance before writing to indicate queue write pressure is
+  // being increased (+ve queue balance indicates more writes than reads)
+  CAFFE_EVENT(stats_, queue_balance, 1);
+  doWrite(pos, inputs);
+  CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
+  return true;
+}
+
+bool RingBlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
+  Timer writeTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  // Increase queue balance before writing to indicate queue write pressure is
+  // being increased (+ve queue balance indicates more writes than reads)
+  CAFFE_EVENT(stats_, queue_balance, 1);
+  auto pos = tryClaimWrite();
+  if (pos < 0) {
+    Timer waitTimer;
+    wait(notFull_, writeWaiters_, 0, [&]() {
+      pos = tryClaimWrite();
+      return pos >= 0;
+    });
+    CAFFE_EVENT(ringStats_, write_wait_time_ns, waitTimer.NanoSeconds());
+  }
+  if (pos < 0) {
+    CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+    return false;
+  }
+  doWrite(pos, inputs);
+  CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
+  return true;
+}
+
+void RingBlobsQueue::close() {
+  closing_ = true;
+
+  std::lock_guard<std::mutex> g(mutex_);
+  notEmpty_.notify_all();
+  notFull_.notify_all();
+}
+
+int64_t
+RingBlobsQueue::tryClaimRead(size_t numRecords, bool partial, size_t* claimed) {
+  auto pos = readPos_.load(std::memory_order_relaxed);
+  for (;;) {
+    int64_t n = 0;
+    while (n < static_cast<int64_t>(numRecords) &&
+           sequences_[(pos + n) % capacity_].load(std::memory_order_acquire) ==
+               2 * (pos + n) + 1) {
+      ++n;
+    }
+    if (n == 0 || (n < static_cast<int64_t>(numRecords) && !partial)) {
+      // Either the records are not there yet or another reader took them.
+      const auto current = readPos_.load(std::memory_order_relaxed);
+      if (current == pos) {
+        return -1;
+      }
+      pos = current;
+      continue;
+    }
+    // Full slots stay full until claimed, so a successful swap of the cursor
+    // hands all n of them to this reader.
+    if (readPos_.compare_exchange_weak(
+            pos, pos + n, std::memory_order_relaxed)) {
+      *claimed = n;
+      return pos;
+    }
+  }
+}
+
+int64_t RingBlobsQueue::tryClaimWrite() {
+  auto pos = writePos_.load(std::memory_order_relaxed);
+  for (;;) {
+    const auto seq =
+        sequences_[pos % capacity_].load(std::memory_order_acquire);
+    if (seq == 2 * pos) {
+      if (writePos_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        return pos;
+      }
+    } else if (seq < 2 * pos) {
+      // The slot still holds the record from one lap ago.
+      return -1;
+    } else {
+      pos = writePos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void RingBlobsQueue::doWrite(int64_t pos, const std::vector<Blob*>& inputs) {
+  auto& result = queue_[pos % capacity_];
+  for (auto i = 0; i < result.size(); ++i) {
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  publishWrite(pos);
+  CAFFE_SDT(
+      queue_write_end, name_.c_str(), (void*)this, capacity_ - depth());
+}
+
+void RingBlobsQueue::publishRead(int64_t pos, size_t n) {
+  for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+    sequences_[(pos + i) % capacity_].store(
+        2 * (pos + i + capacity_), std::memory_order_release);
+  }
+  wake(writeWaiters_, notFull_);
+}
+
+void RingBlobsQueue::publishWrite(int64_t pos) {
+  sequences_[pos % capacity_].store(2 * pos + 1, std::memory_order_release);
+  wake(readWaiters_, notEmpty_);
+}
+
+void RingBlobsQueue::wake(
+    std::atomic<int>& waiters,
+    std::condition_variable& cv) {
+  // Pairs with the fence in wait(): either the waiter sees the published
+  // slot, or this sees the waiter.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> g(mutex_);
+    cv.notify_all();
+  }
+}
+
+template <typename Claim>
+void RingBlobsQueue::wait(
+    std::condition_variable& cv,
+    std::atomic<int>& waiters,
+    float timeout_secs,
+    Claim claim) {
+  std::unique_lock<std::mutex> g(mutex_);
+  waiters.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto ready = [this, &claim]() { return claim() || closing_; };
+  if (timeout_secs > 0) {
+    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
+    cv.wait_for(g, timeout_ms, ready);
+  } else {
+    cv.wait(g, ready);
+  }
+  waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace caffe2
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+
+#include "caffe2/queue/blobs_queue.h"
+
+namespace caffe2 {
+
+// A BlobsQueue whose readers and writers claim slots without a lock.
+// Modelled as a bounded multi-producer multi-consumer ring: every slot keeps
+// a sequence number telling which position of the stream it holds and
+// whether it is full, so producers and consumers only race on a
+// compare-and-swap of their own cursor. The mutex is only taken to sleep
+// while the queue is full or empty.
+
+// Batch reads claim consecutive full slots at once and concatenate them
+// straight from the slots into the outputs.
+
+class CAFFE2_API RingBlobsQueue : public BlobsQueue {
+ public:
+  RingBlobsQueue(
+      Workspace* ws,
+      const std::string& queueName,
+      size_t capacity,
+      size_t numBlobs,
+      bool enforceUniqueName,
+      const std::vector<std::string>& fieldNames = {});
+
+  ~RingBlobsQueue() override {
+    close();
+  }
+
+  bool blockingRead(
+      const std::vector<Blob*>& inputs,
+      float timeout_secs = 0.0f) override;
+  bool blockingReadBatch(
+      const std::vector<Blob*>& outputs,
+      size_t numRecords,
+      float timeout_secs = 0.0f) override;
+  bool hasConcurrentBatchRead() const override {
+    return true;
+  }
+  bool tryWrite(const std::vector<Blob*>& inputs) override;
+  bool blockingWrite(const std::vector<Blob*>& inputs) override;
+  void close() override;
+
+ private:
+  // Claims up to numRecords consecutive full slots and returns the position
+  // of the first one, or -1 if none could be claimed. Fewer than numRecords
+  // slots are only claimed if partial is set.
+  int64_t tryClaimRead(size_t numRecords, bool partial, size_t* claimed);
+  // Claims an empty slot and returns its position, or -1 if the queue is
+  // full.
+  int64_t tryClaimWrite();
+  void doWrite(int64_t pos, const std::vector<Blob*>& inputs);
+  void publishRead(int64_t pos, size_t n);
+  void publishWrite(int64_t pos);
+  void wake(std::atomic<int>& waiters, std::condition_variable& cv);
+  // Sleeps on cv until claim() succeeds, the queue is closed or the timeout
+  // expires.
+  template <typename Claim>
+  void wait(
+      std::condition_variable& cv,
+      std::atomic<int>& waiters,
+      float timeout_secs,
+      Claim claim);
+  int64_t depth() const {
+    return writePos_.load(std::memory_order_relaxed) -
+        readPos_.load(std::memory_order_relaxed);
+  }
+
+  const int64_t capacity_;
+  std::unique_ptr<std::atomic<int64_t>[]> sequences_;
+
+  // The cursors are padded apart so that readers and writers do not share a
+  // cache line.
+  std::atomic<int64_t> readPos_{0};
+  char readPad_[64 - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> writePos_{0};
+  char writePad_[64 - sizeof(std::atomic<int64_t>)];
+
+  std::atomic<int> readWaiters_{0};
+  std::atomic<int> writeWaiters_{0};
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+
+  struct RingStats {
+    CAFFE_STAT_CTOR(RingStats);
+    CAFFE_AVG_EXPORTED_STAT(queue_depth);
+    CAFFE_AVG_EXPORTED_STAT(read_wait_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(write_wait_time_ns);
+  } ringStats_;
+};
+} // namespace caffe2
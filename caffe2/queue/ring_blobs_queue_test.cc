@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "caffe2/core/blob.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/queue/ring_blobs_queue.h"
+
+namespace caffe2 {
+
+namespace {
+
+void SetRecord(Blob* blob, const std::vector<int>& values) {
+  auto* tensor = BlobGetMutableTensor(blob, CPU);
+  tensor->Resize(values.size());
+  std::copy(values.begin(), values.end(), tensor->mutable_data<int>());
+}
+
+std::vector<int> GetRecord(const Blob& blob) {
+  const auto& tensor = blob.Get<TensorCPU>();
+  return std::vector<int>(
+      tensor.data<int>(), tensor.data<int>() + tensor.numel());
+}
+
+} // namespace
+
+TEST(RingBlobsQueueTest, ReadsBatches) {
+  Workspace ws;
+  auto queue = std::make_shared<RingBlobsQueue>(&ws, "ring", 4, 1, true);
+  Blob blob;
+  SetRecord(&blob, {1, 2});
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  SetRecord(&blob, {3});
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  SetRecord(&blob, {4, 5, 6});
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+
+  Blob out;
+  EXPECT_TRUE(queue->blockingReadBatch({&out}, 2));
+  EXPECT_EQ(GetRecord(out), (std::vector<int>{1, 2, 3}));
+  // Not enough records left for a batch.
+  EXPECT_FALSE(queue->blockingReadBatch({&out}, 2, 0.01f));
+  queue->close();
+  EXPECT_TRUE(queue->blockingReadBatch({&out}, 2));
+  EXPECT_EQ(GetRecord(out), (std::vector<int>{4, 5, 6}));
+  EXPECT_FALSE(queue->blockingReadBatch({&out}, 2));
+}
+
+TEST(RingBlobsQueueTest, RejectsWritesWhenFull) {
+  Workspace ws;
+  auto queue = std::make_shared<RingBlobsQueue>(&ws, "ring", 1, 1, true);
+  Blob blob;
+  SetRecord(&blob, {1});
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  SetRecord(&blob, {2});
+  EXPECT_FALSE(queue->tryWrite({&blob}));
+  Blob out;
+  EXPECT_TRUE(queue->blockingRead({&out}));
+  EXPECT_EQ(GetRecord(out), (std::vector<int>{1}));
+  EXPECT_TRUE(queue->tryWrite({&blob}));
+  EXPECT_TRUE(queue->blockingRead({&out}));
+  EXPECT_EQ(GetRecord(out), (std::vector<int>{2}));
+  EXPECT_FALSE(queue->blockingRead({&out}, 0.01f));
+}
+
+TEST(RingBlobsQueueTest, ManyProducersAndConsumers) {
+  const int kNumProducers = 6;
+  const int kNumConsumers = 4;
+  const int kNumRecords = 2000;
+  for (int batch : {1, 3}) {
+    Workspace ws;
+    auto queue = std::make_shared<RingBlobsQueue>(&ws, "ring", 3, 1, true);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kNumProducers; ++p) {
+      producers.emplace_back([&queue, p]() {
+        Blob blob;
+        for (int i = 0; i < kNumRecords; ++i) {
+          SetRecord(&blob, {p * kNumRecords + i});
+          EXPECT_TRUE(queue->blockingWrite({&blob}));
+        }
+      });
+    }
+    std::vector<std::vector<int>> read(kNumConsumers);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kNumConsumers; ++c) {
+      consumers.emplace_back([&queue, &read, batch, c]() {
+        Blob blob;
+        while (batch > 1 ? queue->blockingReadBatch({&blob}, batch)
+                         : queue->blockingRead({&blob})) {
+          const auto record = GetRecord(blob);
+          read[c].insert(read[c].end(), record.begin(), record.end());
+        }
+      });
+    }
+    for (auto& thread : producers) {
+      thread.join();
+    }
+    queue->close();
+    for (auto& thread : consumers) {
+      thread.join();
+    }
+
+    std::vector<int> all;
+    for (const auto& values : read) {
+      // Every consumer sees the records of a producer in order.
+      std::vector<int> last(kNumProducers, -1);
+      for (int value : values) {
+        EXPECT_GT(value, last[value / kNumRecords]);
+        last[value / kNumRecords] = value;
+      }
+      all.insert(all.end(), values.begin(), values.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), kNumProducers * kNumRecords);
+    for (int i = 0; i < all.size(); ++i) {
+      EXPECT_EQ(all[i], i);
+    }
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,67 @@
+#include "caffe2/sgd/adagrad_fused_nbit_rowwise_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(
+    RowWiseSparseAdagradFused8BitRowwise,
+    RowWiseSparseAdagradFusedNBitRowwiseOp<8, CPUContext>);
+OPERATOR_SCHEMA(RowWiseSparseAdagradFused8BitRowwise)
+    .NumInputs(5)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Runs the RowWiseSparseAdagrad update on a fused 8-bit row-wise quantized
+table, as produced by FloatToFused8BitRowwiseQuantized, without an fp32 copy
+of the table. Given inputs (param, moment, indices, grad, lr), each row
+param[indices[i]] is dequantized, updated with grad[i] and moment[indices[i]]
+exactly like in RowWiseSparseAdagrad, and quantized again with a new scale
+and bias fitted to the updated row. Rows not in indices are left untouched.
+
+By default the new values are rounded stochastically: a value is rounded up
+with probability equal to its distance from the lower quantization level, so
+that updates smaller than the quantization step still move the parameters in
+expectation.
+
+)DOC")
+    .Input(0, "param", "Fused 8-bit row-wise quantized parameters")
+    .Input(1, "moment", "Moment history, one per row of param")
+    .Input(2, "indices", "Sparse indices")
+    .Input(3, "grad", "Gradient computed")
+    .Input(4, "lr", "learning rate")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment_1", "Updated moment")
+    .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "stochastic_rounding",
+        "Default true. If false, the updated values are rounded to nearest.");
+
+REGISTER_CPU_OPERATOR(
+    RowWiseSparseAdagradFused4BitRowwise,
+    RowWiseSparseAdagradFusedNBitRowwiseOp<4, CPUContext>);
+OPERATOR_SCHEMA(RowWiseSparseAdagradFused4BitRowwise)
+    .NumInputs(5)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Same as RowWiseSparseAdagradFused8BitRowwise for a fused 4-bit row-wise
+quantized table. Every row holds two values per byte, the even one in the low
+nibble, followed by an fp16 scale and an fp16 bias.
+
+)DOC")
+    .Input(0, "param", "Fused 4-bit row-wise quantized parameters")
+    .Input(1, "moment", "Moment history, one per row of param")
+    .Input(2, "indices", "Sparse indices")
+    .Input(3, "grad", "Gradient computed")
+    .Input(4, "lr", "learning rate")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment_1", "Updated moment")
+    .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "stochastic_rounding",
+        "Default true. If false, the updated values are rounded to nearest.");
+
+SHOULD_NOT_DO_GRADIENT(RowWiseSparseAdagradFused8BitRowwise);
+SHOULD_NOT_DO_GRADIENT(RowWiseSparseAdagradFused4BitRowwise);
+} // namespace caffe2
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/adagrad.h"
+
+namespace caffe2 {
+
+// Row-wise sparse Adagrad directly on a fused BIT_RATE-bit row-wise quantized
+// table, see rowwise_adagrad_fused_nbit_update. Only the rows in indices are
+// dequantized, updated and quantized back, in place.
+template <int BIT_RATE, class Context>
+class RowWiseSparseAdagradFusedNBitRowwiseOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  RowWiseSparseAdagradFusedNBitRowwiseOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)),
+        stochastic_rounding_(this->template GetSingleArgument<bool>(
+            "stochastic_rounding",
+            true)) {
+    // xorshift32 never leaves a zero state.
+    for (auto& state : rng_state_) {
+      do {
+        state = context_.RandGenerator()();
+      } while (state == 0);
+    }
+  }
+
+  bool RunOnDevice() override {
+    // Enforce shapes
+    CAFFE_ENFORCE_EQ(Input(PARAM).dim(), 2);
+    CAFFE_ENFORCE_EQ(Input(PARAM).sizes()[0], Input(MOMENT_1).numel());
+    CAFFE_ENFORCE_EQ(Input(LR).numel(), 1);
+
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    const auto n = Input(INDICES).numel();
+    if (n == 0) {
+      return true;
+    }
+
+    const auto& param = Input(PARAM);
+    const int block_size = Input(GRAD).size_from_dim(Input(INDICES).dim());
+    const auto num_rows = param.size(0);
+    const auto row_size = param.size(1);
+    CAFFE_ENFORCE_EQ(
+        row_size,
+        fused_nbit_rowwise_row_size(BIT_RATE, block_size),
+        this->debug_def().input(PARAM),
+        " does not hold rows of ",
+        block_size,
+        " fused ",
+        BIT_RATE,
+        "-bit values");
+
+    const auto* lr = Input(LR).template data<float>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* gradIn = Input(GRAD).template data<float>();
+    auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<uint8_t>();
+    auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<float>();
+    scratch_.resize(block_size);
+
+    for (auto i = 0; i < n; ++i) {
+      const auto idx = indices[i];
+      CAFFE_ENFORCE(
+          0 <= idx && idx < num_rows,
+          this->debug_def().input(PARAM),
+          ", out of bound, idx:",
+          idx,
+          " for input i:",
+          i);
+      rowwise_adagrad_fused_nbit_update(
+          BIT_RATE,
+          block_size,
+          paramOut + idx * row_size,
+          gradIn + i * block_size,
+          momentOut + idx,
+          epsilon_,
+          lr[0],
+          stochastic_rounding_,
+          rng_state_.data(),
+          scratch_.data());
+    }
+    return true;
+  }
+
+ protected:
+  float epsilon_;
+  bool stochastic_rounding_;
+  std::array<std::uint32_t, kRowwiseAdagradRngStreams> rng_state_;
+  std::vector<float> scratch_;
+  INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR);
+  OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
+};
+
+} // namespace caffe2
@@ -8,6 +8,7 @@
 #include <c10/util/tempfile.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <iostream>
@@ -485,6 +486,89 @@ TEST(DataTest, StackTransformWorksForTensorExample) {
   ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
 }
 
+TEST(DataTest, PooledStackTransformMatchesStack) {
+  auto d = datasets::TensorDataset(torch::randn({6, 3}))
+               .map(transforms::PooledStack<TensorExample>());
+  auto expected = datasets::TensorDataset(d.dataset().tensor)
+                      .map(transforms::Stack<TensorExample>());
+
+  TensorExample batch = d.get_batch({0, 1, 2});
+  ASSERT_TRUE(batch.data.equal(expected.get_batch({0, 1, 2}).data));
+
+  // The last batch of an epoch may be smaller than the pooled buffers.
+  TensorExample smaller = d.get_batch({4, 5});
+  ASSERT_TRUE(smaller.data.equal(expected.get_batch({4, 5}).data));
+}
+
+TEST(DataTest, PooledStackTransformReusesReleasedBuffers) {
+  auto d = datasets::TensorDataset(torch::randn({8, 3}))
+               .map(transforms::PooledStack<TensorExample>(
+                   transforms::PooledStackOptions().capacity(2)));
+
+  void* first_buffer = nullptr;
+  {
+    TensorExample first = d.get_batch({0, 1});
+    first_buffer = first.data.data_ptr();
+    // Still held, so the next batch must get a different buffer.
+    TensorExample second = d.get_batch({2, 3});
+    ASSERT_NE(second.data.data_ptr(), first_buffer);
+  }
+  // Both batches were released, so their buffers are reused.
+  TensorExample third = d.get_batch({4, 5});
+  TensorExample fourth = d.get_batch({6, 7});
+  ASSERT_TRUE(
+      third.data.data_ptr() == first_buffer ||
+      fourth.data.data_ptr() == first_buffer);
+  ASSERT_TRUE(third.data.equal(d.dataset().tensor.slice(0, 4, 6)));
+  ASSERT_TRUE(fourth.data.equal(d.dataset().tensor.slice(0, 6, 8)));
+}
+
+TEST(DataTest, RingQueuePushAndPopFromDifferentThreads) {
+  torch::data::detail::RingQueue<int> queue(/*capacity=*/4);
+  const int count = 1000;
+  std::thread producer([&queue] {
+    for (int i = 0; i < count; ++i) {
+      queue.push(i);
+    }
+  });
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(queue.pop(), i);
+  }
+  producer.join();
+  ASSERT_THROWS_WITH(
+      queue.pop(10 * kMillisecond),
+      "Timeout in DataLoader queue while waiting for next batch "
+      "(timeout was 10 ms)");
+}
+
+TEST(DataTest, RingQueuePushBlocksWhileFull) {
+  torch::data::detail::RingQueue<int> queue(/*capacity=*/2);
+  queue.push(0);
+  queue.push(1);
+  std::atomic<bool> pushed{false};
+  std::thread producer([&queue, &pushed] {
+    queue.push(2);
+    pushed = true;
+    queue.push(3);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_FALSE(pushed);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(queue.pop(), i);
+  }
+  producer.join();
+  ASSERT_TRUE(pushed);
+
+  // Clearing the queue also wakes up waiting producers.
+  queue.push(4);
+  queue.push(5);
+  std::thread blocked([&queue] { queue.push(6); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const size_t cleared = queue.clear();
+  blocked.join();
+  ASSERT_EQ(cleared + queue.clear(), 3);
+}
+
 // Template classes cannot be nested in functions.
 template <typename Target>
 struct T : transforms::TensorTransform<Target> {
@@ -2302,4 +2386,74 @@ TEST(DataLoaderTest, CustomPreprocessPolicy) {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(DataLoaderTest, ChunkDatasetShardedBufferWithShuffleBuffer) {
+  const size_t total_example_count = 35;
+  const size_t batch_size = 5;
+  const size_t prefetch_count = 3;
+  const size_t buffer_shard_counts[] = {1, 2, 3};
+  const size_t shuffle_buffer_sizes[] = {0, 4, 50};
+
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+
+  for (auto buffer_shard_count : buffer_shard_counts) {
+    for (auto shuffle_buffer_size : shuffle_buffer_sizes) {
+      datasets::SharedBatchDataset<datasets::ChunkDataset<
+          DummyChunkDataReader,
+          samplers::SequentialSampler,
+          samplers::SequentialSampler>>
+          dataset = datasets::make_shared_dataset<datasets::ChunkDataset<
+              DummyChunkDataReader,
+              samplers::SequentialSampler,
+              samplers::SequentialSampler>>(
+              data_reader,
+              sampler,
+              sampler,
+              datasets::ChunkDatasetOptions(prefetch_count, batch_size)
+                  .buffer_shard_count(buffer_shard_count)
+                  .shuffle_buffer_size(shuffle_buffer_size));
+
+      auto data_loader = torch::data::make_data_loader(
+          dataset, DataLoaderOptions(batch_size).workers(0));
+
+      // Shards may return partial batches at the end of the epoch, but every
+      // example must be returned exactly once.
+      for (int epoch_index = 0; epoch_index < 2; ++epoch_index) {
+        std::vector<int> result;
+        for (auto iterator = data_loader->begin();
+             iterator != data_loader->end();
+             ++iterator) {
+          ASSERT_LE(iterator->size(), batch_size);
+          std::copy(
+              iterator->begin(), iterator->end(), std::back_inserter(result));
+        }
+        std::sort(result.begin(), result.end());
+        std::vector<int> expected(total_example_count);
+        std::iota(expected.begin(), expected.end(), 0);
+        ASSERT_EQ(result, expected);
+      }
+    }
+  }
+}
+
+TEST(DataTest, ChunkDataSetWithTooManyBufferShards) {
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+
+  datasets::ChunkDataset<
+      DummyChunkDataReader,
+      samplers::SequentialSampler,
+      samplers::SequentialSampler>
+      dataset(
+          data_reader,
+          sampler,
+          sampler,
+          datasets::ChunkDatasetOptions(/*preloader_count=*/1, 5)
+              .buffer_shard_count(2));
+  ASSERT_THROWS_WITH(
+      dataset.reset(),
+      "The number of batch buffer shards must be between 1 and the number of "
+      "preloaders.");
+}
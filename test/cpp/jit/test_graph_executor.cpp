@@ -2,6 +2,8 @@
 #include "test/cpp/jit/test_utils.h"
 #include "torch/csrc/jit/runtime/graph_executor.h"
 
+#include <thread>
+
 namespace torch {
 namespace jit {
 
@@ -28,5 +30,59 @@ void testGraphExecutor() {
   ASSERT_TRUE(almostEqual(stack[1].toTensor(), r1));
 }
 
+void testGraphExecutorPlanCache() {
+  constexpr int input_size = 16;
+  int hidden_size = 2 * input_size;
+
+  auto w_ih = t_def(at::randn({4 * hidden_size, input_size}, at::kCPU));
+  auto w_hh = t_def(at::randn({4 * hidden_size, hidden_size}, at::kCPU));
+  auto inputs = [&](int batch_size) {
+    return createStack(
+        {at::randn({batch_size, input_size}, at::kCPU),
+         at::randn({batch_size, hidden_size}, at::kCPU),
+         at::randn({batch_size, hidden_size}, at::kCPU),
+         w_ih,
+         w_hh});
+  };
+
+  // the plan cache belongs to the legacy executor
+  auto old_executor_mode = getExecutorMode().exchange(false);
+  auto old_profiling_mode = getProfilingMode().exchange(false);
+  GraphExecutor executor(build_lstm());
+  getExecutorMode() = old_executor_mode;
+  getProfilingMode() = old_profiling_mode;
+
+  constexpr int num_threads = 4;
+  constexpr int num_runs = 10;
+  auto stack = inputs(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < num_runs; ++i) {
+        auto s = stack;
+        executor.run(s);
+        ASSERT_EQ(s.size(), 2);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto stats = executor.getCacheStats();
+  ASSERT_EQ(stats.misses, 1);
+  ASSERT_EQ(stats.hits, num_threads * num_runs - 1);
+  ASSERT_GT(stats.compile_time_ns, 0);
+
+  // a new specialization is compiled once
+  for (int i = 0; i < 2; ++i) {
+    auto s = inputs(8);
+    executor.run(s);
+  }
+  stats = executor.getCacheStats();
+  ASSERT_EQ(stats.misses, 2);
+  ASSERT_EQ(stats.hits, num_threads * num_runs);
+  ASSERT_EQ(executor.getDebugState().execution_plans.size(), 2);
+}
+
 } // namespace jit
 } // namespace torch
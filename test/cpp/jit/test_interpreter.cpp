@@ -1,5 +1,12 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
+#include "torch/csrc/jit/runtime/interop_scheduler.h"
+
+#include <torch/script.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
 
 namespace torch {
 namespace jit {
@@ -27,5 +34,81 @@ void testInterp() {
   ASSERT_TRUE(exactlyEqual(outputs[0], hx));
   ASSERT_TRUE(exactlyEqual(outputs[1], cx));
 }
+void testInterOpScheduler() {
+  const auto text = R"JIT(
+def add_one(x):
+    return x + 1
+
+def fork_three(x):
+    a = torch.jit._fork(add_one, x)
+    b = torch.jit._fork(add_one, x)
+    c = torch.jit._fork(add_one, x)
+    return torch.jit._wait(a) + torch.jit._wait(b) + torch.jit._wait(c)
+)JIT";
+
+  auto cu = compile(text);
+  auto& fn = cu->get_function("fork_three");
+  InterOpSchedulerOptions options;
+  options.num_threads = 2;
+  InterOpScheduler scheduler(options);
+  ASSERT_EQ(scheduler.size(), 2);
+
+  auto x = at::randn({2, 3});
+  for (int i = 0; i < 5; ++i) {
+    Stack stack = {x};
+    fn.run(stack, scheduler.launcher(InterOpScheduler::Priority::High));
+    ASSERT_TRUE(almostEqual(stack.back().toTensor(), (x + 1) * 3));
+  }
+  auto stats = scheduler.stats();
+  // every fork went through the scheduler, queued or inline
+  ASSERT_GE(stats.tasks_queued + stats.tasks_inlined, 15);
+  ASSERT_LE(stats.tasks_started, stats.tasks_queued);
+  ASSERT_LE(stats.max_queue_delay_ns, stats.total_queue_delay_ns);
+
+  // nothing runs inline without inlining
+  options.max_inline_depth = 0;
+  InterOpScheduler queueing(options);
+  Stack stack = {x};
+  fn.run(stack, queueing.launcher());
+  ASSERT_TRUE(almostEqual(stack.back().toTensor(), (x + 1) * 3));
+  ASSERT_EQ(queueing.stats().tasks_inlined, 0);
+  ASSERT_GE(queueing.stats().tasks_queued, 3);
+
+  // With every worker busy, the continuation of a wait() runs inline on the
+  // thread completing the future, and resumes by reading its value
+  const auto wait_text = R"JIT(
+def wait_plus_one(fut: Future[Tensor]):
+    return torch.jit._wait(fut) + 1
+)JIT";
+  auto wait_cu = compile(wait_text);
+  options.num_threads = 1;
+  options.max_inline_depth = 1;
+  InterOpScheduler saturated(options);
+  Code code(wait_cu->get_function("wait_plus_one").optimized_graph());
+  InterpreterState interp(code, saturated.launcher());
+  auto fut = c10::make_intrusive<Future>(TensorType::get());
+  Stack wait_stack = {fut};
+  // suspends at the wait
+  auto done = interp.runAsync(wait_stack);
+  ASSERT_FALSE(done->completed());
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool> blocked{false};
+  saturated.launch([&blocked, released]() {
+    blocked = true;
+    released.wait();
+  });
+  while (!blocked) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(saturated.numIdle(), 0);
+  fut->markCompleted(x);
+  ASSERT_TRUE(done->completed());
+  ASSERT_TRUE(almostEqual(done->value().toTensor(), x + 1));
+  ASSERT_EQ(saturated.stats().tasks_inlined, 1);
+  release.set_value();
+}
+
 } // namespace jit
 } // namespace torch
@@ -1,4 +1,5 @@
 #include <test/cpp/jit/test_base.h>
+#include <ATen/core/op_registration/op_registration.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/mobile/import.h>
@@ -207,5 +208,34 @@ void testLiteInterpreterWrongMethodName() {
   ASSERT_THROWS_WITH(bc.run_method("forward", inputs), "is not defined");
 }
 
+void testLiteInterpreterLazyOperator() {
+  // aten::exp is not registered for the lite interpreter. Operators are only
+  // resolved when they first run, so the model still loads and the branch
+  // that does not use it runs fine.
+  script::Module m("m");
+  m.define(R"(
+    def forward(self, x, use_exp: bool):
+      if use_exp:
+        return torch.exp(x)
+      return x + 1
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+
+  std::vector<IValue> inputs({torch::ones({}), false});
+  auto output = bc.run_method("forward", inputs);
+  AT_ASSERT(output.toTensor().item<float>() == 2.0);
+
+  inputs = {torch::ones({}), true};
+  ASSERT_THROWS_WITH(bc.run_method("forward", inputs), "cannot be found");
+
+  // an operator registered after the model was loaded is found when it runs
+  auto ops = torch::RegisterOperators(
+      "_aten::exp", [](at::Tensor a) -> at::Tensor { return a.exp(); });
+  output = bc.run_method("forward", inputs);
+  AT_ASSERT(output.toTensor().equal(torch::ones({}).exp()));
+}
+
 } // namespace jit
 } // namespace torch
@@ -19,6 +19,8 @@
 #include "torch/csrc/jit/codegen/fuser/interface.h"
 #include "torch/csrc/jit/serialization/import.h"
 #include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/csrc/jit/runtime/profiling_cache.h"
+#include "torch/csrc/jit/runtime/profiling_graph_executor_impl.h"
 #include "torch/csrc/jit/ir/irparser.h"
 #include "torch/csrc/jit/passes/pass_manager.h"
 #include "torch/csrc/jit/ir/alias_analysis.h"
@@ -54,6 +56,7 @@
 #include "onnx/onnx_pb.h"
 
 #include <c10/util/Exception.h>
+#include <c10/util/tempfile.h>
 
 #include <algorithm>
 #include <cstddef>
@@ -1150,6 +1153,60 @@ void testInsertBailOuts() {
   }
 }
 
+void testProfilingCache() {
+  static const auto basic_example = R"JIT(
+  def basic(x, y):
+    a = x + y
+    b = x * y
+    return a - b
+  )JIT";
+
+  auto cu = compile(basic_example);
+  auto& fun = cu->get_function("basic");
+  auto countNodes = [](const ExecutionPlan& plan, Symbol kind) {
+    auto nodes = plan.graph->block()->nodes();
+    return std::count_if(nodes.begin(), nodes.end(), [kind](Node* n) {
+      return n->kind() == kind;
+    });
+  };
+  auto old_mode = getProfilingCacheMode().exchange(true);
+  auto old_num_runs = getNumProfiledRuns().exchange(1);
+  clearProfilingCache();
+
+  auto stack = createStack({at::randn({2, 3}), at::randn({2, 3})});
+  ProfilingGraphExecutorImpl profiled(fun.graph());
+  auto plan = profiled.getPlanFor(stack, 1);
+  ASSERT_GT(countNodes(plan, prim::profile), 0);
+  auto run_stack = stack;
+  InterpreterState(plan.code).run(run_stack);
+  auto optimized = profiled.getPlanFor(stack, 1);
+  ASSERT_EQ(countNodes(optimized, prim::profile), 0);
+  ASSERT_EQ(debugNumCachedProfiles(), 1);
+
+  auto tempfile = c10::make_tempfile();
+  saveProfilingCache(tempfile.name);
+  clearProfilingCache();
+  loadProfilingCache(tempfile.name);
+  ASSERT_EQ(debugNumCachedProfiles(), 1);
+
+  // the first run of a new executor already gets the optimized plan
+  ProfilingGraphExecutorImpl restored(fun.graph());
+  auto restored_plan = restored.getPlanFor(stack, 1);
+  ASSERT_EQ(countNodes(restored_plan, prim::profile), 0);
+  ASSERT_EQ(
+      countNodes(restored_plan, prim::BailOut),
+      countNodes(optimized, prim::BailOut));
+
+  // other input types are profiled again
+  auto other_stack = createStack({at::randn({4, 5}), at::randn({4, 5})});
+  ProfilingGraphExecutorImpl other(fun.graph());
+  ASSERT_GT(countNodes(other.getPlanFor(other_stack, 1), prim::profile), 0);
+
+  clearProfilingCache();
+  getNumProfiledRuns() = old_num_runs;
+  getProfilingCacheMode() = old_mode;
+}
+
 void testProfiler() {
   constexpr int batch_size = 4;
   constexpr int input_size = 256;
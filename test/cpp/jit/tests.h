@@ -51,6 +51,9 @@ namespace jit {
   _(Profiler)                          \
   _(InsertAndEliminateRedundantGuards) \
   _(InsertBailOuts)                    \
+  _(ProfilingCache)                    \
+  _(GraphExecutorPlanCache)            \
+  _(InterOpScheduler)                  \
   _(PeepholeOptimize)                  \
   _(RecordFunction)                    \
   _(ThreadLocalDebugInfo)              \
@@ -84,7 +87,8 @@ namespace jit {
   _(MobileTypeParser)                  \
   _(LiteInterpreterPrim)               \
   _(LiteInterpreterLoadOrigJit)        \
-  _(LiteInterpreterWrongMethodName)
+  _(LiteInterpreterWrongMethodName)    \
+  _(LiteInterpreterLazyOperator)
 
 #define TH_FORALL_TESTS_CUDA(_) \
   _(ArgumentSpec)               \
@@ -600,3 +600,39 @@ class TestFreezing(JitTestCase):
         out3 = smod(inp)
         self.assertNotEqual(out1, out2)
         self.assertEqual(out2, out3)
+
+    def test_freeze_module_fold_batch_norm(self):
+        for conv in [nn.Conv2d(3, 8, 3, padding=1), nn.Conv2d(3, 8, 3, bias=False)]:
+            bn = nn.BatchNorm2d(8)
+            bn.running_mean.uniform_()
+            bn.running_var.uniform_(0.5, 1.5)
+            bn.weight.data.uniform_()
+            bn.bias.data.uniform_()
+            mod = nn.Sequential(conv, bn, nn.ReLU())
+            smod = torch.jit.script(mod)
+            smod.eval()
+            fmod = torch._C._freeze_module(smod._c)
+            graph = fmod._get_method('forward').graph
+            self.assertTrue(torch._C._jit_pass_fold_frozen_batch_norm(graph))
+            torch._C._jit_pass_inplace_frozen_conv_activations(graph)
+            FileCheck().check("aten::conv2d").check_not("aten::batch_norm") \
+                       .check("aten::relu_").run(graph)
+            inp = torch.rand(2, 3, 8, 8)
+            self.assertEqual(fmod.forward(inp), smod(inp))
+
+    def test_freeze_module_fold_batch_norm_linear(self):
+        bn = nn.BatchNorm1d(5)
+        bn.running_mean.uniform_()
+        bn.running_var.uniform_(0.5, 1.5)
+        mod = nn.Sequential(nn.Linear(3, 5), bn)
+        smod = torch.jit.script(mod)
+        smod.eval()
+        fmod = torch._C._freeze_module(smod._c)
+        graph = fmod._get_method('forward').graph
+        # the input of the linear may not be 2-d
+        self.assertFalse(torch._C._jit_pass_fold_frozen_batch_norm(graph))
+        inp = torch.rand(4, 3)
+        list(graph.inputs())[1].inferTypeFrom(inp)
+        self.assertTrue(torch._C._jit_pass_fold_frozen_batch_norm(graph))
+        FileCheck().check("aten::linear").check_not("aten::batch_norm").run(graph)
+        self.assertEqual(fmod.forward(inp), smod(inp))
@@ -1661,6 +1661,129 @@ graph(%input, %weight):
             torch._C._jit_pass_fuse_linear(graph)
             FileCheck().run(input_str, graph)
 
+    def test_fuse_add_layer_norm(self):
+        input_strs = ["""
+graph(%input, %residual, %shape, %weight, %bias):
+    %alpha : int = prim::Constant[value=1]()
+    %eps : float = prim::Constant[value=1e-05]()
+    %cudnn : bool = prim::Constant[value=1]()
+    # CHECK-NOT: aten::add
+    # CHECK-NOT: aten::layer_norm
+    # CHECK: aten::_add_layer_norm
+    %x = aten::add(%input, %residual, %alpha)
+    %res = aten::layer_norm(%x, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)""", """
+graph(%input, %residual, %shape, %weight, %bias):
+    %alpha : int = prim::Constant[value=2]()
+    %eps : float = prim::Constant[value=1e-05]()
+    %cudnn : bool = prim::Constant[value=1]()
+    # CHECK-NOT: aten::_add_layer_norm
+    %x = aten::add(%input, %residual, %alpha)
+    %res = aten::layer_norm(%x, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)""", """
+graph(%input, %residual, %shape, %weight, %bias):
+    %alpha : int = prim::Constant[value=1]()
+    %eps : float = prim::Constant[value=1e-05]()
+    %cudnn : bool = prim::Constant[value=1]()
+    # CHECK-NOT: aten::_add_layer_norm
+    %x = aten::add(%input, %residual, %alpha)
+    %res = aten::layer_norm(%x, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res, %x)""", """
+graph(%input, %shape, %weight, %bias):
+    %residual : float = prim::Constant[value=0.5]()
+    %alpha : int = prim::Constant[value=1]()
+    %eps : float = prim::Constant[value=1e-05]()
+    %cudnn : bool = prim::Constant[value=1]()
+    # CHECK-NOT: aten::_add_layer_norm
+    %x = aten::add(%input, %residual, %alpha)
+    %res = aten::layer_norm(%x, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)"""]
+        for input_str in input_strs:
+            graph = parse_ir(input_str)
+            torch._C._jit_pass_fuse_add_layer_norm(graph)
+            FileCheck().run(input_str, graph)
+
+    def test_fuse_bias_gelu(self):
+        input_strs = ["""
+graph(%input, %bias):
+    %alpha : int = prim::Constant[value=1]()
+    # CHECK-NOT: aten::add
+    # CHECK-NOT: aten::gelu
+    # CHECK: aten::_bias_gelu
+    %x = aten::add(%input, %bias, %alpha)
+    %res = aten::gelu(%x)
+    return (%res)""", """
+graph(%input, %weight, %bias : Tensor):
+    # CHECK: aten::linear
+    # CHECK-NOT: aten::gelu
+    # CHECK: aten::_bias_gelu
+    %x = aten::linear(%input, %weight, %bias)
+    %res = aten::gelu(%x)
+    return (%res)""", """
+graph(%input, %weight):
+    %bias : Tensor? = prim::Constant()
+    # CHECK-NOT: aten::_bias_gelu
+    %x = aten::linear(%input, %weight, %bias)
+    %res = aten::gelu(%x)
+    return (%res)""", """
+graph(%input):
+    %bias : float = prim::Constant[value=1.]()
+    %alpha : int = prim::Constant[value=1]()
+    # CHECK-NOT: aten::_bias_gelu
+    %x = aten::add(%input, %bias, %alpha)
+    %res = aten::gelu(%x)
+    return (%res)"""]
+        for input_str in input_strs:
+            graph = parse_ir(input_str)
+            torch._C._jit_pass_fuse_bias_gelu(graph)
+            FileCheck().run(input_str, graph)
+
+    def test_fuse_masked_softmax(self):
+        input_strs = ["""
+graph(%input, %mask):
+    %value : float = prim::Constant[value=-10000.]()
+    %dim : int = prim::Constant[value=-1]()
+    %dtype : int? = prim::Constant()
+    # CHECK-NOT: aten::masked_fill
+    # CHECK-NOT: aten::softmax
+    # CHECK: aten::_masked_softmax
+    %x = aten::masked_fill(%input, %mask, %value)
+    %res = aten::softmax(%x, %dim, %dtype)
+    return (%res)""", """
+graph(%input, %mask):
+    %scale : float = prim::Constant[value=0.125]()
+    %value : float = prim::Constant[value=-10000.]()
+    %dim : int = prim::Constant[value=-1]()
+    %dtype : int? = prim::Constant()
+    # CHECK-NOT: aten::mul
+    # CHECK: aten::_masked_softmax(%input, %mask, %dim, %value, %scale)
+    %s = aten::mul(%input, %scale)
+    %x = aten::masked_fill(%s, %mask, %value)
+    %res = aten::softmax(%x, %dim, %dtype)
+    return (%res)""", """
+graph(%input, %mask):
+    %divisor : int = prim::Constant[value=8]()
+    %value : float = prim::Constant[value=-10000.]()
+    %dim : int = prim::Constant[value=-1]()
+    %dtype : int? = prim::Constant()
+    # CHECK-NOT: aten::div(%input
+    # CHECK: aten::_masked_softmax
+    %s = aten::div(%input, %divisor)
+    %x = aten::masked_fill(%s, %mask, %value)
+    %res = aten::softmax(%x, %dim, %dtype)
+    return (%res)""", """
+graph(%input, %mask, %value : Tensor):
+    %dim : int = prim::Constant[value=-1]()
+    %dtype : int? = prim::Constant()
+    # CHECK-NOT: aten::_masked_softmax
+    %x = aten::masked_fill(%input, %mask, %value)
+    %res = aten::softmax(%x, %dim, %dtype)
+    return (%res)"""]
+        for input_str in input_strs:
+            graph = parse_ir(input_str)
+            torch._C._jit_pass_fuse_masked_softmax(graph)
+            FileCheck().run(input_str, graph)
+
     @_tmp_donotuse_dont_inline_everything
     def test_fold_quantize(self):
         class M(torch.nn.Module):
@@ -48,7 +48,7 @@ from torch.testing._internal.common_nn import NNTestCase, ModuleTest, CriterionT
     module_tests, criterion_tests, new_criterion_tests, loss_reference_fns, \
     ctcloss_reference, new_module_tests
 from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes, \
-    dtypesIfCUDA, skipCUDAIfNoCudnn, skipCUDAIfCudnnVersionLessThan, onlyCUDA, \
+    dtypesIfCUDA, skipCUDAIfNoCudnn, skipCUDAIfCudnnVersionLessThan, onlyCUDA, onlyCPU, \
     skipCUDAIfRocm, skipCUDAIf, skipCUDAIfNotRocm, largeCUDATensorTest
 
 from torch.nn import MultiheadAttention
@@ -5986,6 +5986,38 @@ class TestNN(NNTestCase):
                 _test_gelu(n, m, torch.float64, True)
                 _test_gelu(n, m, torch.float64, False)
 
+    def test_bias_gelu(self):
+        for dtype in [torch.float32, torch.float64]:
+            for n, m in [(1, 1), (3, 7), (5, 33)]:
+                X = torch.randn(n, m, dtype=dtype)
+                b = torch.randn(m, dtype=dtype)
+                self.assertEqual(torch._bias_gelu(X, b), F.gelu(X + b))
+                # broadcasts like add
+                b = torch.randn(n, 1, dtype=dtype)
+                self.assertEqual(torch._bias_gelu(X, b), F.gelu(X + b))
+        # falls back to the differentiable ops
+        X = torch.randn(3, 5, dtype=torch.float64, requires_grad=True)
+        b = torch.randn(5, dtype=torch.float64, requires_grad=True)
+        gradcheck(torch._bias_gelu, [X, b])
+
+    def test_add_layer_norm(self):
+        for dtype in [torch.float32, torch.float64]:
+            for shape, normalized_shape in [((2, 3, 10), (10,)), ((4, 35), (35,)), ((2, 3, 4), (3, 4))]:
+                X = torch.randn(shape, dtype=dtype)
+                R = torch.randn(shape, dtype=dtype)
+                w = torch.randn(normalized_shape, dtype=dtype)
+                b = torch.randn(normalized_shape, dtype=dtype)
+                self.assertEqual(torch._add_layer_norm(X, R, normalized_shape, w, b, 1e-5),
+                                 F.layer_norm(X + R, normalized_shape, w, b, 1e-5))
+                self.assertEqual(torch._add_layer_norm(X, R, normalized_shape),
+                                 F.layer_norm(X + R, normalized_shape))
+                self.assertEqual(torch._add_layer_norm(X.transpose(0, 1), R.transpose(0, 1), shape[-1:]),
+                                 F.layer_norm(X.transpose(0, 1) + R.transpose(0, 1), shape[-1:]))
+        # falls back to the differentiable ops
+        X = torch.randn(3, 5, dtype=torch.float64, requires_grad=True)
+        R = torch.randn(3, 5, dtype=torch.float64, requires_grad=True)
+        gradcheck(lambda x, r: torch._add_layer_norm(x, r, (5,)), [X, R])
+
 
     def test_bce_loss_always_nonnegative(self):
         target = torch.ones(5)
@@ -7998,6 +8030,44 @@ class TestNN(NNTestCase):
         self.assertEqual(input.grad.dtype, dtype)
         self.assertEqual(input.grad, inputf.grad.to(dtype), prec=0.1)
 
+    def test_softmax_inner_dim_cpu(self):
+        # sizes of the inner dimensions around the vector width
+        for dtype in [torch.float, torch.double]:
+            for shape in [(2, 5, 3), (2, 5, 8), (3, 7, 17), (4, 3, 2, 9)]:
+                x = torch.randn(shape, dtype=dtype)
+                for dim in range(len(shape) - 1):
+                    ref = x.transpose(dim, -1).contiguous()
+                    self.assertEqual(F.softmax(x, dim),
+                                     F.softmax(ref, -1).transpose(dim, -1))
+                    self.assertEqual(F.log_softmax(x, dim),
+                                     F.log_softmax(ref, -1).transpose(dim, -1))
+        # bfloat16 is summed in float, over dims long enough to lose a
+        # bfloat16 sum; the results are within a bfloat16 rounding
+        for shape, dim in [((2, 1024, 9), 1), ((1024, 17), 0)]:
+            x = torch.randn(shape).bfloat16()
+            self.assertEqual(F.log_softmax(x, dim).float(),
+                             F.log_softmax(x.float(), dim).bfloat16().float(),
+                             prec=0.1)
+
+    def test_masked_softmax(self):
+        for dtype in [torch.float, torch.double]:
+            x = torch.randn(2, 3, 5, 7, dtype=dtype)
+            # attention masks broadcast over heads and queries
+            for mask_shape in [(2, 3, 5, 7), (2, 1, 1, 7), (2, 1, 5, 7), (5, 1)]:
+                mask = torch.rand(mask_shape) > 0.5
+                mask[..., 0] = False
+                for value, scale in [(float('-inf'), 1.), (-1e4, 0.125)]:
+                    self.assertEqual(torch._masked_softmax(x, mask, -1, value, scale),
+                                     F.softmax((x * scale).masked_fill(mask, value), -1))
+            mask = torch.rand(2, 3, 5, 7) > 0.5
+            self.assertEqual(torch._masked_softmax(x, mask, 1, -1e4),
+                             F.softmax(x.masked_fill(mask, -1e4), 1))
+        # falls back to the differentiable ops
+        x = torch.randn(3, 5, dtype=torch.double, requires_grad=True)
+        mask = torch.rand(3, 5) > 0.5
+        mask[:, 0] = False
+        gradcheck(lambda x: torch._masked_softmax(x, mask, -1, float('-inf'), 0.5), [x])
+
     def test_adaptive_log_softmax(self):
         # args validation
         with self.assertRaises(ValueError):
@@ -9388,7 +9458,8 @@ class TestNNDeviceType(NNTestCase):
     @dtypes(torch.float64)
     def test_embedding_backward(self, device, dtype):
         embedding = nn.Embedding(10, 3, sparse=True)
-        tensor = torch.tensor([[7, 1, 3]])
+        # sorted, since the CPU gradient is coalesced
+        tensor = torch.tensor([[1, 3, 7]])
         ones = torch.tensor(1.).expand(3, 3)
         tensorTwice = tensor.repeat(1, 2)
         onesTwice = torch.cat((ones, ones))
@@ -9412,12 +9483,49 @@ class TestNNDeviceType(NNTestCase):
 
         embedding.zero_grad()
         embedding(tensor[0]).sum().backward()
-        tensor[0, 0] = 8
+        tensor[0, 2] = 8
         embedding(tensor[0]).sum().backward()
-        tensorTwice[0, 3] = 8
+        tensorTwice[0, 5] = 8
         self.assertEqual(embedding.weight.grad._indices(), tensorTwice)
         self.assertEqual(embedding.weight.grad._values(), onesTwice)
 
+    def test_embedding_backward_duplicates(self, device):
+        indices = torch.tensor([[4, 2, 4, 9], [0, 4, 2, 4]], device=device)
+        grad = torch.randn(2, 4, 5, device=device, dtype=torch.double)
+        counts = torch.bincount(indices.view(-1), minlength=10)
+        for scale_grad_by_freq, sparse in [(False, False), (True, False), (False, True)]:
+            expected = torch.zeros(10, 5, device=device, dtype=torch.double)
+            for i, j in itertools.product(range(2), range(4)):
+                k = indices[i, j].item()
+                if k != 0:
+                    scale = 1. / counts[k].item() if scale_grad_by_freq else 1.
+                    expected[k] += grad[i, j] * scale
+            weight = torch.randn(10, 5, device=device, dtype=torch.double, requires_grad=True)
+            F.embedding(indices, weight, padding_idx=0, scale_grad_by_freq=scale_grad_by_freq,
+                        sparse=sparse).backward(grad)
+            if sparse:
+                if self.device_type == 'cpu':
+                    self.assertTrue(weight.grad.is_coalesced())
+                    self.assertEqual(weight.grad._indices(), torch.tensor([[2, 4, 9]]))
+                self.assertEqual(weight.grad.to_dense(), expected)
+            else:
+                self.assertEqual(weight.grad, expected)
+
+    @onlyCPU
+    def test_embedding_backward_bfloat16(self, device):
+        # THBlas has no bfloat16 axpy, so its rows are added with add_
+        indices = torch.tensor([[4, 2, 4, 9], [0, 4, 2, 4]], device=device)
+        grad = torch.randn(2, 4, 5, device=device).bfloat16()
+        for scale_grad_by_freq in [False, True]:
+            weight = torch.randn(10, 5, device=device, requires_grad=True)
+            weight_bf16 = weight.detach().bfloat16().requires_grad_()
+            F.embedding(indices, weight, padding_idx=0,
+                        scale_grad_by_freq=scale_grad_by_freq).backward(grad.float())
+            F.embedding(indices, weight_bf16, padding_idx=0,
+                        scale_grad_by_freq=scale_grad_by_freq).backward(grad)
+            self.assertEqual(weight_bf16.grad.dtype, torch.bfloat16)
+            self.assertEqual(weight_bf16.grad.float(), weight.grad, prec=0.05)
+
     def test_embedding_padding_idx(self, device):
         embedding = nn.Embedding(10, 20, padding_idx=0).to(device)
         input = torch.tensor([[0, 2, 4, 5], [4, 3, 0, 9]], dtype=torch.long).to(device)
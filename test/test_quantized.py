@@ -1,6 +1,7 @@
 from __future__ import division
 from builtins import round
 
+import io
 import numpy as np
 import unittest
 
@@ -1535,6 +1536,94 @@ class TestQuantizedLinear(unittest.TestCase):
                 np.testing.assert_equal(
                     W_q.q_zero_point(), W_q_origin.q_zero_point())
 
+    """Tests the serialization of backend-packed linear weights."""
+    @given(W=hu.tensor(shapes=hu.array_shapes(2, 2,),
+                       qparams=hu.qparams(dtypes=torch.qint8)),
+           qengine=st.sampled_from(("qnnpack", "fbgemm")))
+    def test_qlinear_prepack_serialize(self, W, qengine):
+        if qengine not in torch.backends.quantized.supported_engines:
+            return
+        if qengine == 'qnnpack':
+            if IS_PPC or TEST_WITH_UBSAN:
+                return
+
+        with override_quantized_engine(qengine):
+            W, (W_scale, W_zp, torch_type) = W
+            W = torch.from_numpy(W)
+            W_q = torch.quantize_per_tensor(W, scale=W_scale, zero_point=W_zp,
+                                            dtype=torch_type)
+            W_prepack = torch.ops.quantized.linear_prepack(W_q)
+            packed = torch.ops.quantized.linear_prepack_serialize(W_prepack)
+            self.assertEqual(packed.dtype, torch.uint8)
+
+            W_prepack_loaded = torch.ops.quantized.linear_prepack_deserialize(packed, W_q)
+            W_q_origin = torch.ops.quantized.linear_unpack(W_prepack_loaded)[0]
+            np.testing.assert_equal(W_q.int_repr(), W_q_origin.int_repr().numpy())
+
+            # A blob that was not produced for this engine and CPU falls back
+            # to prepacking the weight.
+            W_prepack_loaded = torch.ops.quantized.linear_prepack_deserialize(
+                torch.zeros(0, dtype=torch.uint8), W_q)
+            W_q_origin = torch.ops.quantized.linear_unpack(W_prepack_loaded)[0]
+            np.testing.assert_equal(W_q.int_repr(), W_q_origin.int_repr().numpy())
+
+    """Tests the serialization of fbgemm fp16 packed linear weights."""
+    @given(W=hu.tensor(shapes=hu.array_shapes(2, 2,),
+                       elements=st.floats(-10, 10, allow_nan=False, width=32)))
+    def test_qlinear_prepack_serialize_fp16(self, W):
+        if 'fbgemm' not in torch.backends.quantized.supported_engines:
+            return
+
+        with override_quantized_engine('fbgemm'):
+            W, _ = W
+            W = torch.from_numpy(W)
+            W_prepack = torch.ops.quantized.linear_prepack_fp16(W)
+            packed = torch.ops.quantized.linear_prepack_serialize(W_prepack)
+            self.assertEqual(packed.dtype, torch.uint8)
+            self.assertGreater(packed.numel(), 0)
+
+            W_prepack_loaded = torch.ops.quantized.linear_prepack_deserialize(packed, W)
+            np.testing.assert_equal(
+                torch.ops.quantized.linear_unpack_fp16(W_prepack)[0].numpy(),
+                torch.ops.quantized.linear_unpack_fp16(W_prepack_loaded)[0].numpy())
+
+            # A truncated blob is rejected rather than read past its end
+            with self.assertRaisesRegex(RuntimeError, "truncated packed weight"):
+                torch.ops.quantized.linear_prepack_deserialize(packed[:-1], W)
+
+    """Tests the TorchScript serialization of LinearPackedParams on fbgemm."""
+    def test_linear_packed_params_save_load(self):
+        if 'fbgemm' not in torch.backends.quantized.supported_engines:
+            return
+        from torch.nn.quantized.modules.linear import LinearPackedParams
+
+        with override_quantized_engine('fbgemm'):
+            W = torch.randn(5, 7)
+            b = torch.randn(5)
+            W_q = torch.quantize_per_tensor(W, scale=0.1, zero_point=2, dtype=torch.qint8)
+            for dtype, weight in [(torch.qint8, W_q), (torch.float16, W)]:
+                params = torch.jit.script(LinearPackedParams(dtype))
+                params.set_weight_bias(weight, b)
+                buffer = io.BytesIO()
+                torch.jit.save(params, buffer)
+                buffer.seek(0)
+                loaded = torch.jit.load(buffer)
+                (W_ref, b_ref), (W_loaded, b_loaded) = params._weight_bias(), loaded._weight_bias()
+                if dtype == torch.qint8:
+                    np.testing.assert_equal(W_ref.int_repr().numpy(), W_loaded.int_repr().numpy())
+                    self.assertEqual(W_ref.q_scale(), W_loaded.q_scale())
+                    self.assertEqual(W_ref.q_zero_point(), W_loaded.q_zero_point())
+                else:
+                    np.testing.assert_equal(W_ref.numpy(), W_loaded.numpy())
+                self.assertEqual(b_ref, b_loaded)
+
+            # The state of older versions has no packed weight
+            params = LinearPackedParams()
+            params.__setstate__((W_q, b, False, torch.qint8))
+            W_loaded, b_loaded = params._weight_bias()
+            np.testing.assert_equal(W_q.int_repr().numpy(), W_loaded.int_repr().numpy())
+            self.assertEqual(b, b_loaded)
+
 class TestQuantizedConv(unittest.TestCase):
     def _test_qconv_unpack_impl(
         self, qconv_prepack_fn, qconv_unpack_fn, inputs, strides, pads,
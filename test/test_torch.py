@@ -3758,6 +3758,40 @@ class _TestTorchMixin(object):
         g2_normal = q.normal_(generator=g2)
         self.assertEqual(g1_normal, g2_normal)
 
+    def test_generator_cpu_philox(self):
+        g = torch.Generator()
+        self.assertFalse(g.use_philox())
+        self.assertIs(g.set_use_philox(True), g)
+        self.assertTrue(g.use_philox())
+        with self.assertRaisesRegex(RuntimeError, "expected a bool"):
+            g.set_use_philox(1)
+
+        def sample(threads):
+            num_threads = torch.get_num_threads()
+            try:
+                torch.set_num_threads(threads)
+                g.manual_seed(12345)
+                return [torch.empty(10007).uniform_(generator=g),
+                        torch.empty(10007).normal_(generator=g),
+                        torch.empty(10007).bernoulli_(0.3, generator=g),
+                        torch.empty(10007).exponential_(generator=g)]
+            finally:
+                torch.set_num_threads(num_threads)
+
+        # Reseeding replays the stream, whatever the number of threads.
+        expected = sample(1)
+        self.assertEqual(sample(1), expected)
+        self.assertEqual(sample(4), expected)
+        self.assertTrue((expected[0] >= 0).all() and (expected[0] < 1).all())
+        self.assertNotEqual(expected[0], expected[1])
+
+        # Switching back restores the Mersenne Twister stream.
+        g.set_use_philox(False)
+        g.manual_seed(12345)
+        g_mt = torch.Generator().manual_seed(12345)
+        self.assertEqual(torch.empty(100).uniform_(generator=g),
+                         torch.empty(100).uniform_(generator=g_mt))
+
     def test_sobolengine_unscrambled_lowdim(self):
         engine_1d = torch.quasirandom.SobolEngine(1)
         expected_1d = torch.tensor([0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125, 0.1875, 0.6875, 0.9375])
@@ -10808,6 +10842,41 @@ class TestTorchDeviceType(TestCase):
                                               [1, 0, 0, 0],
                                               [0, 0, 0, 0]], device=device))
 
+    # index broadcast over the trailing dims, as in GNN message passing
+    def test_scatter_gather_expanded_index(self, device):
+        for dtype in [torch.float, torch.double, torch.long]:
+            for dim, shape, num_rows in [(0, (50, 16), 10), (0, (3, 2000), 5), (1, (4, 30, 3, 5), 7)]:
+                index_shape = shape[:dim + 1] + (1,) * (len(shape) - dim - 1)
+                index = torch.randint(num_rows, index_shape, device=device).expand(shape)
+                src = torch.randint(10, shape, device=device).to(dtype)
+                self_shape = list(shape)
+                self_shape[dim] = num_rows
+                self_ = torch.randint(10, self_shape, device=device).to(dtype)
+
+                self.assertEqual(self_.gather(dim, index), self_.gather(dim, index.contiguous()))
+                self.assertEqual(self_.scatter_add(dim, index, src),
+                                 self_.scatter_add(dim, index.contiguous(), src))
+                # scatter without duplicates, whose result does not depend on the order
+                perm = torch.randperm(shape[dim], device=device)
+                perm = perm.view((1,) * dim + (-1,) + (1,) * (len(shape) - dim - 1)).expand(shape)
+                self.assertEqual(torch.zeros_like(src).scatter(dim, perm, src),
+                                 torch.zeros_like(src).scatter(dim, perm.contiguous(), src))
+
+        # src aliasing self, on CPU each column is then updated in index order
+        if device == 'cpu':
+            x = torch.randint(10, (2000, 64), device=device)
+            index = torch.randint(x.size(0), (x.size(0), 1), device=device).expand_as(x)
+            expected = x.clone()
+            expected.scatter_add_(0, index.contiguous(), expected)
+            actual = x.clone()
+            actual.scatter_add_(0, index, actual)
+            self.assertEqual(actual, expected)
+            expected = x.clone()
+            expected.scatter_(0, index.contiguous(), expected)
+            actual = x.clone()
+            actual.scatter_(0, index, actual)
+            self.assertEqual(actual, expected)
+
     def test_scatter_bool(self, device):
         x = torch.tensor([[True, True, True], [True, True, True]], device=device)
         res = torch.zeros(3, 3, dtype=torch.bool, device=device)
@@ -13859,6 +13928,60 @@ class TestTorchDeviceType(TestCase):
         res6 = torch.baddbmm(res2, b1, b2, beta=.1, alpha=.5)
         self.assertEqual(res6, res2 * .1 + res * .5)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double, torch.int64)
+    def test_bmm_batched_gemm(self, device, dtype):
+        def make(*shape):
+            if dtype.is_floating_point:
+                return torch.randn(*shape, dtype=dtype, device=device)
+            return torch.randint(-10, 10, shape, dtype=dtype, device=device)
+
+        num_threads = torch.get_num_threads()
+        try:
+            for threads in [1, 4]:
+                torch.set_num_threads(threads)
+                # Few large batches split their rows across threads, many
+                # small ones run whole.
+                for num_batches, M, N, O in [(2, 37, 19, 23), (17, 9, 13, 11)]:
+                    for trans1, trans2 in product([False, True], repeat=2):
+                        b1 = make(num_batches, N, M).transpose(1, 2) if trans1 else make(num_batches, M, N)
+                        b2 = make(num_batches, O, N).transpose(1, 2) if trans2 else make(num_batches, N, O)
+                        # Every other column, neither contiguous nor transposed.
+                        b3 = make(num_batches, N, 2 * O)[:, :, ::2]
+                        expected = torch.stack([b1[i].mm(b2[i]) for i in range(num_batches)])
+                        self.assertEqual(torch.bmm(b1, b2), expected)
+                        self.assertEqual(
+                            torch.bmm(b1, b3),
+                            torch.stack([b1[i].mm(b3[i]) for i in range(num_batches)]))
+                        res = make(num_batches, M, O)
+                        self.assertEqual(
+                            torch.baddbmm(res, b1, b2, beta=2, alpha=3),
+                            res * 2 + expected * 3)
+
+                # Broadcast batches of matmul are not copied on CPU.
+                a = make(3, 1, 10, 6)
+                b = make(4, 6, 5)
+                expected = torch.stack([
+                    torch.stack([a[i, 0].mm(b[j]) for j in range(4)]) for i in range(3)])
+                self.assertEqual(torch.matmul(a, b), expected)
+        finally:
+            torch.set_num_threads(num_threads)
+
+    @onlyCPU
+    @dtypes(torch.bfloat16)
+    def test_bmm_bfloat16(self, device, dtype):
+        # Above the size of the naive kernel, BFloat16 runs as a series of
+        # matrix multiplications.
+        num_batches, M, N, O = 4, 12, 10, 9
+        b1 = torch.randn(num_batches, M, N, device=device).to(dtype)
+        b2 = torch.randn(num_batches, N, O, device=device).to(dtype)
+        expected = torch.stack([b1[i].mm(b2[i]) for i in range(num_batches)])
+        self.assertEqual(torch.bmm(b1, b2), expected)
+        res = torch.randn(num_batches, M, O, device=device).to(dtype)
+        self.assertEqual(
+            torch.baddbmm(res, b1, b2),
+            torch.stack([res[i].addmm(b1[i], b2[i]) for i in range(num_batches)]))
+
     def _test_cop(self, torchfn, mathfn, dtype, device):
         def reference_implementation(res2):
             for i, j in iter_indices(sm1):
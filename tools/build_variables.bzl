@@ -96,6 +96,7 @@ libtorch_sources = [
     "torch/csrc/jit/serialization/import_export_helpers.cpp",
     "torch/csrc/jit/runtime/instruction.cpp",
     "torch/csrc/jit/runtime/interpreter.cpp",
+    "torch/csrc/jit/runtime/interop_scheduler.cpp",
     "torch/csrc/jit/ir/ir.cpp",
     "torch/csrc/jit/ir/irparser.cpp",
     "torch/csrc/jit/jit_log.cpp",
@@ -104,6 +105,7 @@ libtorch_sources = [
     "torch/csrc/jit/ir/subgraph_matcher.cpp",
     "torch/csrc/jit/runtime/symbolic_script.cpp",
     "torch/csrc/jit/runtime/profiling_graph_executor_impl.cpp",
+    "torch/csrc/jit/runtime/profiling_cache.cpp",
     "torch/csrc/jit/runtime/profiling_record.cpp",
     "torch/csrc/jit/runtime/operator.cpp",
     "torch/csrc/jit/ir/alias_analysis.cpp",
@@ -136,7 +138,10 @@ libtorch_sources = [
     "torch/csrc/jit/passes/peephole.cpp",
     "torch/csrc/jit/serialization/python_print.cpp",
     "torch/csrc/jit/passes/quantization.cpp",
+    "torch/csrc/jit/passes/fold_frozen_batch_norm.cpp",
+    "torch/csrc/jit/passes/fuse_layer_norm.cpp",
     "torch/csrc/jit/passes/fuse_linear.cpp",
+    "torch/csrc/jit/passes/fuse_masked_softmax.cpp",
     "torch/csrc/jit/passes/remove_expands.cpp",
     "torch/csrc/jit/passes/requires_grad_analysis.cpp",
     "torch/csrc/jit/passes/shape_analysis.cpp",
@@ -0,0 +1,145 @@
+"""
+Generate the operator manifest for a selective build of the lite interpreter.
+
+The manifest lists every operator referenced by the bytecode of a set of
+models saved with `_save_for_mobile`. It uses the same yaml format as
+SELECTED_OP_LIST, so it can be passed straight to the build:
+
+python -m tools.jit.gen_mobile_op_manifest \
+       --model model1.ptl --model model2.ptl \
+       --output-yaml selected_ops.yaml
+
+SELECTED_OP_LIST=selected_ops.yaml scripts/build_mobile.sh
+
+When SELECTED_OP_LIST is set, the build also runs this script with --op-list
+and --output-header to generate the header consumed by
+torch/csrc/jit/mobile/register_mobile_ops.cpp, which then only registers the
+operators listed in the manifest.
+
+This script only depends on the Python standard library (plus yaml for
+--op-list) so it can run on the build host without an installed torch.
+"""
+
+import argparse
+import os
+import pickle
+import zipfile
+
+
+class _Opaque(object):
+    """Placeholder for any global referenced by bytecode.pkl (tensors,
+    script objects, ...). Only operator names matter for the manifest."""
+
+    def __init__(self, *args, **kwargs):
+        pass
+
+    def __setstate__(self, state):
+        pass
+
+
+class _BytecodeUnpickler(pickle.Unpickler):
+    def find_class(self, module, name):
+        return _Opaque
+
+    def persistent_load(self, pid):
+        return None
+
+
+def _bytecode_record(archive):
+    for name in archive.namelist():
+        if name == 'bytecode.pkl' or name.endswith('/bytecode.pkl'):
+            return name
+    raise RuntimeError(
+        '{} has no bytecode.pkl; save it with _save_for_mobile'.format(archive.filename))
+
+
+def _expect_field(table, expected_name, entry):
+    row = table[entry]
+    if row[0] != expected_name:
+        raise RuntimeError('Expected {} found {}'.format(expected_name, row[0]))
+    return row[1]
+
+
+def load_model_op_names(path):
+    """Returns the set of operator names ('aten::add.Tensor') used by the
+    bytecode of the model at `path`."""
+    with zipfile.ZipFile(path) as archive:
+        with archive.open(_bytecode_record(archive)) as f:
+            methods = _BytecodeUnpickler(f).load()
+
+    op_names = set()
+    for _, table in methods:
+        for name, overload_name in _expect_field(table, 'operators', 1):
+            # The lite interpreter registers its operators with a "_" prefix
+            # to avoid clashing with the full JIT registry; the manifest uses
+            # the canonical names, like SELECTED_OP_LIST does.
+            if name.startswith('_'):
+                name = name[1:]
+            op_names.add(name + '.' + overload_name if overload_name else name)
+    return op_names
+
+
+def load_op_list(path):
+    import yaml
+    with open(path, 'r') as f:
+        return set(yaml.safe_load(f) or [])
+
+
+def write_yaml(op_names, path):
+    with open(path, 'w') as f:
+        for name in sorted(op_names):
+            f.write('- {}\n'.format(name))
+
+
+def write_header(op_names, path):
+    lines = [
+        '#pragma once',
+        '',
+        '// Generated by tools/jit/gen_mobile_op_manifest.py; do not edit.',
+        '',
+        '#define TORCH_MOBILE_SELECTED_OPS \\',
+    ]
+    lines += ['  "{};" \\'.format(name) for name in sorted(op_names)]
+    lines += ['  ""', '']
+    contents = '\n'.join(lines)
+    # Only touch the header when the manifest changes to avoid rebuilds.
+    if os.path.exists(path):
+        with open(path, 'r') as f:
+            if f.read() == contents:
+                return
+    with open(path, 'w') as f:
+        f.write(contents)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate the operator manifest for a selective mobile build')
+    parser.add_argument('--model', action='append', default=[],
+                        help='path to a model saved with _save_for_mobile (repeatable)')
+    parser.add_argument('--op-list', action='append', default=[],
+                        help='path to an existing operator list yaml to merge (repeatable)')
+    parser.add_argument('--output-yaml',
+                        help='path to write the operator manifest yaml to')
+    parser.add_argument('--output-header',
+                        help='path to write the C++ header for register_mobile_ops.cpp to')
+    args = parser.parse_args()
+
+    if not args.model and not args.op_list:
+        parser.error('at least one of --model or --op-list is required')
+    if not args.output_yaml and not args.output_header:
+        parser.error('at least one of --output-yaml or --output-header is required')
+
+    op_names = set()
+    for path in args.model:
+        op_names |= load_model_op_names(path)
+    for path in args.op_list:
+        op_names |= load_op_list(path)
+
+    if args.output_yaml:
+        write_yaml(op_names, args.output_yaml)
+    if args.output_header:
+        write_header(op_names, args.output_header)
+
+
+if __name__ == '__main__':
+    main()
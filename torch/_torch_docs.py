@@ -7521,6 +7521,42 @@ Example::
 """)
 
 
+add_docstr(torch._C.Generator.set_use_philox,
+           r"""
+Generator.set_use_philox(use_philox) -> Generator
+
+Switches a CPU Generator between the default Mersenne Twister engine and the
+counter based Philox engine. In Philox mode the random sampling kernels fill
+their output in parallel, and the values they draw for a given seed do not
+depend on the number of threads. Returns a `torch.Generator` object.
+
+Arguments:
+    use_philox (bool): Whether to draw random numbers from Philox.
+
+Returns:
+    Generator: An torch.Generator object.
+
+Example::
+
+    >>> g_cpu = torch.Generator()
+    >>> g_cpu.set_use_philox(True).manual_seed(2147483647)
+""")
+
+
+add_docstr(torch._C.Generator.use_philox,
+           r"""
+Generator.use_philox() -> bool
+
+Returns whether a CPU Generator draws random numbers from the Philox engine.
+
+Example::
+
+    >>> g_cpu = torch.Generator()
+    >>> g_cpu.use_philox()
+    False
+""")
+
+
 add_docstr(torch._C.Generator.seed,
            r"""
 Generator.seed() -> int
@@ -151,6 +151,31 @@ static PyObject * THPGenerator_initialSeed(THPGenerator *self, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * THPGenerator_setUsePhilox(THPGenerator *self, PyObject *use_philox)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyBool_Check(use_philox), "set_use_philox expected a bool, "
+          "but got %s", THPUtils_typename(use_philox));
+  auto generator = at::check_generator<CPUGenerator>(self->cdata);
+  // See Note [Acquire lock when using random generators]
+  std::lock_guard<std::mutex> lock(generator->mutex_);
+  generator->set_use_philox(use_philox == Py_True);
+  Py_INCREF(self);
+  return (PyObject*)self;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPGenerator_usePhilox(THPGenerator *self, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  auto generator = at::check_generator<CPUGenerator>(self->cdata);
+  if (generator->use_philox()) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * THPGenerator_get_device(THPGenerator *self, void *unused) {
   HANDLE_TH_ERRORS
   return THPDevice_New(self->cdata->device());
@@ -168,6 +193,8 @@ static PyMethodDef THPGenerator_methods[] = {
   {"manual_seed",     (PyCFunction)THPGenerator_manualSeed,     METH_O,       nullptr},
   {"seed",            (PyCFunction)THPGenerator_seed,           METH_NOARGS,  nullptr},
   {"initial_seed",    (PyCFunction)THPGenerator_initialSeed,    METH_NOARGS,  nullptr},
+  {"set_use_philox",  (PyCFunction)THPGenerator_setUsePhilox,   METH_O,       nullptr},
+  {"use_philox",      (PyCFunction)THPGenerator_usePhilox,      METH_NOARGS,  nullptr},
   {nullptr}
 };
 
@@ -37,6 +37,9 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
+        // At most `max_jobs` jobs are in flight, plus one quit message per
+        // worker when joining.
+        shuttle_(options_.max_jobs + options_.workers),
         sequencer_(new_sequencer()) {}
 
   virtual ~DataLoaderBase() {
@@ -4,8 +4,11 @@
 #include <torch/csrc/utils/memory.h>
 #include <torch/data/datasets/stateful.h>
 #include <torch/data/samplers.h>
+#include <functional>
 #include <queue>
+#include <random>
 #include <thread>
+#include <type_traits>
 
 #include <torch/serialize.h>
 
@@ -55,10 +58,15 @@ class BatchDataBuffer {
   BatchDataBuffer(
       size_t batch_size,
       ExampleSampler& example_sampler,
-      size_t queue_capacity)
+      size_t queue_capacity,
+      size_t shuffle_buffer_size = 0,
+      std::function<void()> on_ready = std::function<void()>())
       : batch_size_(batch_size),
         example_sampler_(example_sampler),
-        queue_capacity_(queue_capacity) {}
+        queue_capacity_(queue_capacity),
+        shuffle_buffer_size_(shuffle_buffer_size),
+        shuffle_generator_(std::random_device{}()),
+        on_ready_(std::move(on_ready)) {}
 
   /// Return batch data from the queue. Called from the ChunkDataset main
   /// thread.
@@ -90,9 +98,83 @@ class BatchDataBuffer {
     return batch.batch_data;
   }
 
+  /// Non-blocking version of get_batch. Returns a batch if one is ready, and
+  /// nullopt otherwise, in which case `exhausted` tells whether no more
+  /// batches will ever become ready.
+  BatchType try_get_batch(bool& exhausted) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    exhausted = false;
+    if (total_example_count_in_queue_ < batch_size_ && !stop_) {
+      return nullopt;
+    }
+    if (batch_queue_.empty()) {
+      exhausted = stop_;
+      return nullopt;
+    }
+
+    UnwrappedBatchData batch = std::move(batch_queue_.front());
+    batch_queue_.pop();
+    if (batch.exception) {
+      throw WorkerException(batch.exception);
+    }
+
+    total_example_count_in_queue_ -= batch.batch_data.size();
+    lock.unlock();
+    cv_write_.notify_all();
+
+    return batch.batch_data;
+  }
+
   /// Push preloaded chunks to batch queue. Called from the ChunkDataset worker
   /// threads.
   void add_chunk_data(UnwrappedBatchType data) {
+    if (shuffle_buffer_size_ > 0) {
+      data = shuffle_through_buffer(std::move(data));
+      if (data.empty()) {
+        // Everything went into the shuffle buffer.
+        return;
+      }
+    }
+    enqueue_chunk_data(std::move(data));
+  }
+
+  /// Flush the examples left in the shuffle buffer into the queue, then stop.
+  /// Called once all the workers feeding this buffer are done.
+  void finish() {
+    UnwrappedBatchType remaining;
+    {
+      std::lock_guard<std::mutex> lock(shuffle_mutex_);
+      std::shuffle(
+          shuffle_buffer_.begin(), shuffle_buffer_.end(), shuffle_generator_);
+      std::swap(remaining, shuffle_buffer_);
+    }
+    if (!remaining.empty()) {
+      enqueue_chunk_data(std::move(remaining));
+    }
+    stop();
+  }
+
+  /// Bounded-memory shuffle across chunks: the first shuffle_buffer_size_
+  /// examples fill the buffer, after that every incoming example replaces a
+  /// random one in the buffer, which is emitted instead. Examples from
+  /// different chunks thus get mixed without loading several chunks at once.
+  UnwrappedBatchType shuffle_through_buffer(UnwrappedBatchType data) {
+    UnwrappedBatchType emitted;
+    std::lock_guard<std::mutex> lock(shuffle_mutex_);
+    for (auto& example : data) {
+      if (shuffle_buffer_.size() < shuffle_buffer_size_) {
+        shuffle_buffer_.emplace_back(std::move(example));
+        continue;
+      }
+      std::uniform_int_distribution<size_t> slot(0, shuffle_buffer_size_ - 1);
+      auto& replaced = shuffle_buffer_[slot(shuffle_generator_)];
+      emitted.emplace_back(std::move(replaced));
+      replaced = std::move(example);
+    }
+    return emitted;
+  }
+
+  void enqueue_chunk_data(UnwrappedBatchType data) {
     std::unique_lock<std::mutex> lock(queue_mutex_);
     cv_write_.wait(lock, [this] {
       // stop loading if we have preloaded enough data.
@@ -149,6 +231,9 @@ class BatchDataBuffer {
     total_example_count_in_queue_ += data_size;
     lock.unlock();
     cv_read_.notify_all();
+    if (on_ready_) {
+      on_ready_();
+    }
   }
 
   /// Push exceptions thrown during preloading into batch queue. Called from
@@ -171,6 +256,9 @@ class BatchDataBuffer {
     batch_queue_.emplace(e_ptr);
     lock.unlock();
     cv_read_.notify_all();
+    if (on_ready_) {
+      on_ready_();
+    }
   }
 
   void stop(){
@@ -194,6 +282,9 @@ class BatchDataBuffer {
     cv_write_.notify_all();
     // notify all readers too.
     cv_read_.notify_all();
+    if (on_ready_) {
+      on_ready_();
+    }
   }
   /// The batch size is needed to create batches from the chunk data. Similar to
   /// regular dataloader where the batches are created with prefetches,
@@ -240,7 +331,164 @@ class BatchDataBuffer {
   // preloader could be still waiting for the conditional variable, thus cause
   // the program to hang. This boolean is used to break this waiting condition.
   bool stop_ = false;
+
+  // number of examples kept for shuffling across chunks. 0 disables it.
+  size_t shuffle_buffer_size_;
+
+  // examples waiting to be shuffled into later chunks, guarded by
+  // shuffle_mutex_ rather than queue_mutex_ so that mixing a chunk does not
+  // block readers.
+  UnwrappedBatchType shuffle_buffer_;
+  std::mutex shuffle_mutex_;
+  std::mt19937 shuffle_generator_;
+
+  // called after batches are added or the buffer is stopped, so that a
+  // reader waiting on several buffers can be woken up.
+  std::function<void()> on_ready_;
 };
+
+/// ShardedBatchDataBuffer spreads the ChunkDataset workers over several
+/// BatchDataBuffers, each with its own lock and condition variables, so that
+/// many workers do not all contend on a single queue. Worker `i` feeds shard
+/// `i % shard_count`. get_batch takes batches from the shards in round-robin
+/// order and only sleeps when none of them has a batch ready. Every shard
+/// ends with its own partial batch, if any.
+template <
+    typename UnwrappedBatch,
+    typename ExampleSampler = samplers::RandomSampler>
+class ShardedBatchDataBuffer {
+ public:
+  using ShardType = BatchDataBuffer<UnwrappedBatch, ExampleSampler>;
+  using UnwrappedBatchType = UnwrappedBatch;
+  using BatchType = torch::optional<UnwrappedBatchType>;
+
+  /// `example_samplers` holds one sampler per shard, and `worker_count` is the
+  /// number of workers that will feed the shards.
+  ShardedBatchDataBuffer(
+      size_t batch_size,
+      std::vector<ExampleSampler*> example_samplers,
+      size_t queue_capacity,
+      size_t shuffle_buffer_size,
+      size_t worker_count) {
+    const size_t shard_count = example_samplers.size();
+    TORCH_CHECK(
+        shard_count > 0 && shard_count <= worker_count,
+        "The number of batch buffer shards must be between 1 and the number "
+        "of preloaders.");
+    for (size_t i = 0; i < shard_count; ++i) {
+      shards_.emplace_back(torch::make_unique<ShardType>(
+          batch_size,
+          *example_samplers[i],
+          queue_capacity,
+          shuffle_buffer_size,
+          [this] { this->notify_ready(); }));
+      running_workers_.push_back(
+          worker_count / shard_count + (i < worker_count % shard_count));
+    }
+  }
+
+  BatchType get_batch() {
+    if (shards_.size() == 1) {
+      return shards_[0]->get_batch();
+    }
+    while (true) {
+      size_t seen_ready_count;
+      {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        seen_ready_count = ready_count_;
+      }
+      size_t exhausted_count = 0;
+      for (size_t i = 0; i < shards_.size(); ++i) {
+        const size_t shard = (next_shard_ + i) % shards_.size();
+        bool exhausted = false;
+        if (auto batch = shards_[shard]->try_get_batch(exhausted)) {
+          next_shard_ = (shard + 1) % shards_.size();
+          return batch;
+        }
+        exhausted_count += exhausted;
+      }
+      if (exhausted_count == shards_.size()) {
+        return nullopt;
+      }
+      std::unique_lock<std::mutex> lock(ready_mutex_);
+      cv_ready_.wait(lock, [&] { return ready_count_ != seen_ready_count; });
+    }
+  }
+
+  void add_chunk_data(size_t worker_id, UnwrappedBatchType data) {
+    shard_for(worker_id).add_chunk_data(std::move(data));
+  }
+
+  void add_chunk_data(size_t worker_id, std::exception_ptr e_ptr) {
+    shard_for(worker_id).add_chunk_data(e_ptr);
+  }
+
+  /// Called by each worker when it has no more chunks to load. The shard is
+  /// flushed and stopped once all of its workers are done.
+  void worker_done(size_t worker_id) {
+    const size_t shard = worker_id % shards_.size();
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lock(ready_mutex_);
+      AT_ASSERT(running_workers_[shard] > 0);
+      last = --running_workers_[shard] == 0;
+    }
+    if (last) {
+      shards_[shard]->finish();
+    }
+  }
+
+  void stop() {
+    for (auto& shard : shards_) {
+      shard->stop();
+    }
+  }
+
+ private:
+  ShardType& shard_for(size_t worker_id) {
+    return *shards_[worker_id % shards_.size()];
+  }
+
+  void notify_ready() {
+    {
+      std::lock_guard<std::mutex> lock(ready_mutex_);
+      ++ready_count_;
+    }
+    cv_ready_.notify_all();
+  }
+
+  std::vector<std::unique_ptr<ShardType>> shards_;
+
+  // shard to try first in the next get_batch call. Only used by the reader.
+  size_t next_shard_ = 0;
+
+  // number of workers still feeding each shard, guarded by ready_mutex_.
+  std::vector<size_t> running_workers_;
+
+  // bumped whenever any shard gets new batches or stops, so that the reader
+  // can sleep until something changed without holding the shard locks.
+  size_t ready_count_ = 0;
+  std::mutex ready_mutex_;
+  std::condition_variable cv_ready_;
+};
+
+/// Copies the example sampler for an additional batch buffer shard.
+template <
+    typename ExampleSampler,
+    typename std::enable_if<std::is_copy_constructible<ExampleSampler>::value, int>::type = 0>
+std::unique_ptr<ExampleSampler> clone_example_sampler(const ExampleSampler& sampler) {
+  return torch::make_unique<ExampleSampler>(sampler);
+}
+
+template <
+    typename ExampleSampler,
+    typename std::enable_if<!std::is_copy_constructible<ExampleSampler>::value, int>::type = 0>
+std::unique_ptr<ExampleSampler> clone_example_sampler(const ExampleSampler& sampler) {
+  TORCH_CHECK(
+      false,
+      "buffer_shard_count > 1 requires a copy-constructible example sampler.");
+  return nullptr;
+}
 } // namespace detail
 
 /// Options to configure a `ChunkDataset`.
@@ -292,6 +540,25 @@ struct ChunkDatasetOptions {
   // penalty when this value is greater than 1, as we need to do extra merge
   // between multiple chunks before performing example sampling.
   TORCH_ARG(size_t, cross_chunk_shuffle_count) = 1;
+
+  // The number of independent batch buffers the preloaders write into.
+  // Default to 1, meaning all preloaders share one buffer. With n shards,
+  // preloader i writes into shard i % n, each shard having its own lock and a
+  // copy of the example sampler, and `get_batch` reads from the shards in
+  // round-robin order. This removes the contention on the buffer when many
+  // preloaders are used. Must not exceed `preloader_count`; `cache_size` is
+  // split evenly across the shards. Each shard batches its own examples, so
+  // an epoch may end with up to n batches smaller than `batch_size`, one per
+  // shard, instead of one.
+  TORCH_ARG(size_t, buffer_shard_count) = 1;
+
+  // The number of examples kept in a shuffle buffer to mix examples across
+  // chunks with bounded memory. Default to 0 meaning disabled. Once the buffer
+  // is full, each incoming example replaces a random one in the buffer, which
+  // goes on to be batched instead. Unlike `cross_chunk_shuffle_count`, this
+  // does not need several chunks to be loaded and merged at once. Each shard
+  // has its own shuffle buffer.
+  TORCH_ARG(size_t, shuffle_buffer_size) = 0;
 };
 
 /// A stateful dataset that support hierarchical sampling and prefetching of
@@ -383,11 +650,21 @@ class ChunkDataset final
 
     // Throw out any existing cached batch in the buffer and re-creates a new
     // chunk buffer.
+    const size_t shard_count = options_.buffer_shard_count();
+    std::vector<ExampleSamplerType*> example_samplers{&example_sampler_};
+    shard_example_samplers_.clear();
+    for (size_t i = 1; i < shard_count; ++i) {
+      shard_example_samplers_.push_back(
+          detail::clone_example_sampler(example_sampler_));
+      example_samplers.push_back(shard_example_samplers_.back().get());
+    }
     batch_buffer_ = torch::make_unique<
-        detail::BatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>(
+        detail::ShardedBatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>(
         options_.batch_size(),
-        example_sampler_,
-        options_.cache_size());
+        std::move(example_samplers),
+        std::max(options_.cache_size() / shard_count, options_.batch_size()),
+        options_.shuffle_buffer_size(),
+        options_.preloader_count());
 
     // create new workers for this new epoch.
     quit_worker_ = false;
@@ -445,18 +722,17 @@ class ChunkDataset final
           preprocessing_policy_(data);
         }
         if (!data.empty()) { // skip empty chunks.
-          batch_buffer_->add_chunk_data(std::move(data));
+          batch_buffer_->add_chunk_data(id, std::move(data));
         }
       } catch (...) {
-        batch_buffer_->add_chunk_data(std::current_exception());
+        batch_buffer_->add_chunk_data(id, std::current_exception());
       }
     }
     AT_ASSERT(running_preloaders_.load() > 0);
     --running_preloaders_;
-    if (running_preloaders_.load() == 0) {
-      // all preloaders are completed, so we can notify the batch_buffer.
-      batch_buffer_->stop();
-    }
+    // once all preloaders of its shard are completed, the shard flushes its
+    // shuffle buffer and notifies its readers.
+    batch_buffer_->worker_done(id);
   }
 
   /// Block the current thread until the workers finish execution and exit.
@@ -482,9 +758,12 @@ class ChunkDataset final
   ExampleSamplerType example_sampler_;
 
   // batch data buffer which holds chunk data from preloading thread.
-  std::shared_ptr<detail::BatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>
+  std::shared_ptr<detail::ShardedBatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>
       batch_buffer_;
 
+  // copies of example_sampler_ for the additional batch buffer shards.
+  std::vector<std::unique_ptr<ExampleSamplerType>> shard_example_samplers_;
+
   // worker thread pool
   std::vector<std::thread> preload_threads_;
 
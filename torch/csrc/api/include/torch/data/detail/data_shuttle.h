@@ -1,6 +1,6 @@
 #pragma once
 
-#include <torch/data/detail/queue.h>
+#include <torch/data/detail/ring_queue.h>
 #include <torch/types.h>
 
 #include <c10/util/Exception.h>
@@ -25,6 +25,11 @@ namespace detail {
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  /// `capacity` bounds the number of jobs, and of results, that can be queued
+  /// at any one time.
+  explicit DataShuttle(size_t capacity = 1024)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
@@ -74,12 +79,12 @@ class DataShuttle {
 
  private:
   /// The queue for jobs that are not yet in flight.
-  Queue<Job> new_jobs_;
+  RingQueue<Job> new_jobs_;
   /// The number of in-flight jobs.
   /// NOTE: Not atomic because only manipulated by the main thread.
   size_t in_flight_jobs_ = 0;
   /// The queue for results of finished jobs.
-  Queue<Result> results_;
+  RingQueue<Result> results_;
 };
 
 } // namespace detail
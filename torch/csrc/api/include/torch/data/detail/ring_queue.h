@@ -0,0 +1,223 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A bounded, lock-free MPMC queue with blocking `pop`.
+///
+/// Elements live in a ring of slots, each tagged with a sequence number that
+/// tells producers and consumers whose turn it is to use the slot, so `push`
+/// and `pop` only ever contend on a compare-and-swap of the head or tail index.
+/// The mutex and condition variables are only touched when a consumer has run
+/// out of elements, or a producer out of slots, and goes to sleep; the other
+/// side only notifies when there is such a sleeping thread.
+///
+/// The capacity is rounded up to a power of two. `push` blocks until a slot
+/// frees up if the queue is full, so the capacity should be chosen to bound
+/// the number of elements that can ever be in the queue at once, as the
+/// `DataLoader` does based on its number of jobs and workers.
+template <typename T>
+class RingQueue {
+ public:
+  explicit RingQueue(size_t capacity = 1024) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    mask_ = size - 1;
+    slots_.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  RingQueue(const RingQueue&) = delete;
+  RingQueue& operator=(const RingQueue&) = delete;
+
+  /// Pushes a new value to the back of the queue and wakes up a consumer if
+  /// one is waiting inside a call to `pop()`. Blocks while the queue is full.
+  void push(T value) {
+    if (!try_push(value)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      producer_sleepers_.fetch_add(1, std::memory_order_relaxed);
+      // Pairs with the fence in `notify_producers()`.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      not_full_.wait(lock, [this, &value] { return this->try_push(value); });
+      producer_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    // Pairs with the fence in `pop()`: either the sleeping consumer sees the
+    // new element when it re-checks the queue, or we see it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+      // Taking the lock makes sure the consumer is either still before its
+      // re-check or already waiting on the condition variable.
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      cv_.notify_one();
+    }
+  }
+
+  /// Blocks until at least one element is ready to be popped from the front of
+  /// the queue. An optional `timeout` in seconds can be used to limit the time
+  /// spent waiting for an element. If the wait times out, an exception is
+  /// raised.
+  T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
+    T value;
+    // Elements usually arrive shortly after the consumer asks for them, so
+    // spin for a little while before paying for a sleep.
+    for (size_t spin = 0; spin < kSpinCount; ++spin) {
+      if (try_pop(value)) {
+        notify_producers(/*all=*/false);
+        return value;
+      }
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleepers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto ready = [this, &value] { return this->try_pop(value); };
+    bool popped = true;
+    if (timeout) {
+      popped = cv_.wait_for(lock, *timeout, ready);
+    } else {
+      cv_.wait(lock, ready);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    lock.unlock();
+    if (popped) {
+      notify_producers(/*all=*/false);
+    } else {
+      // clang-format off
+      AT_ERROR(
+          "Timeout in DataLoader queue while waiting for next batch"
+          " (timeout was ", timeout->count(), " ms)");
+      // clang-format on
+    }
+    return value;
+  }
+
+  /// Empties the queue and returns the number of elements that were removed.
+  /// Only producers waiting for a slot are notified; consumers are not, as it
+  /// is assumed to be used to drain the queue during shutdown of a
+  /// `DataLoader`.
+  size_t clear() {
+    size_t size = 0;
+    T value;
+    while (try_pop(value)) {
+      ++size;
+    }
+    if (size > 0) {
+      notify_producers(/*all=*/true);
+    }
+    return size;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t kSpinCount = 64;
+
+  /// Wakes up one, or all, of the producers waiting in `push()` for a slot.
+  void notify_producers(bool all) {
+    // Pairs with the fence in `push()`: either the sleeping producer finds the
+    // free slot when it re-checks the queue, or we see it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producer_sleepers_.load(std::memory_order_relaxed) > 0) {
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      if (all) {
+        not_full_.notify_all();
+      } else {
+        not_full_.notify_one();
+      }
+    }
+  }
+
+  bool try_push(T& value) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & mask_];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+          static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (tail_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        // The slot still holds an element from the previous lap: full.
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T& value) {
+    size_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & mask_];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+          static_cast<std::ptrdiff_t>(position + 1);
+      if (difference == 0) {
+        if (head_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(slot.value);
+          slot.value = T();
+          slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        // Nothing has been pushed into this slot yet: empty.
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+
+  /// Producers and consumers update different indices, keep them on separate
+  /// cache lines. Padding rather than `alignas` since the queue is heap
+  /// allocated as part of the `DataLoader`.
+  char pad0_[64];
+  std::atomic<size_t> tail_{0};
+  char pad1_[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_{0};
+  char pad2_[64 - sizeof(std::atomic<size_t>)];
+
+  /// The number of consumers waiting on `cv_`.
+  std::atomic<size_t> sleepers_{0};
+  /// The number of producers waiting on `not_full_`.
+  std::atomic<size_t> producer_sleepers_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable not_full_;
+};
+
+template <typename T>
+constexpr size_t RingQueue<T>::kSpinCount;
+} // namespace detail
+} // namespace data
+} // namespace torch
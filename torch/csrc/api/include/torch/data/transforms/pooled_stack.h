@@ -0,0 +1,185 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/example.h>
+#include <torch/data/transforms/collate.h>
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/numa.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace transforms {
+
+/// Options to configure a `PooledStack` collation.
+struct PooledStackOptions {
+  /// The maximum number of batch buffers kept in each pool. Should be at least
+  /// the number of batches alive at once, i.e. those in flight in the
+  /// `DataLoader` plus those held by the consumer. When all buffers are in use,
+  /// batches fall back to freshly allocated tensors.
+  TORCH_ARG(size_t, capacity) = 8;
+
+  /// Whether to allocate the batch buffers in pinned (page-locked) memory, so
+  /// that they can be copied to CUDA devices asynchronously. Requires CUDA.
+  /// Pinned batches are not pooled: a `non_blocking` copy may still be reading
+  /// a batch after its last reference is gone. They are allocated from the
+  /// CUDA caching host allocator instead, which recycles pinned memory only
+  /// once the copies recorded on it have completed.
+  TORCH_ARG(bool, pin_memory) = false;
+
+  /// The NUMA node to place the batch buffers on, e.g. the node closest to the
+  /// device consuming the batches.
+  TORCH_ARG(optional<int>, numa_node);
+};
+
+namespace detail {
+/// A thread-safe pool of preallocated batch tensors.
+///
+/// A buffer handed out by `acquire` (or a view of it) is owned by the consumer
+/// of the batch. It is returned to the pool implicitly when the consumer
+/// releases all references to it, which the pool detects from the reference
+/// counts of the buffer and of its storage. Pinned buffers are not pooled, see
+/// `PooledStackOptions::pin_memory`.
+class BatchBufferPool {
+ public:
+  explicit BatchBufferPool(PooledStackOptions options)
+      : options_(std::move(options)) {}
+
+  /// Returns a tensor of the given `sizes` and `options` to collate a batch
+  /// into. The tensor reuses a free buffer of the pool when there is one whose
+  /// first dimension is large enough and whose other sizes match.
+  Tensor acquire(IntArrayRef sizes, const TensorOptions& options) {
+    TORCH_CHECK(!sizes.empty(), "Cannot pool a zero-dimensional batch");
+    if (options_.pin_memory()) {
+      // reference counts cannot tell when an asynchronous copy is done
+      return allocate(sizes, options);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    optional<size_t> evictable;
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      auto& buffer = buffers_[i];
+      if (!is_free(buffer)) {
+        continue;
+      }
+      if (fits(buffer, sizes, options)) {
+        if (buffer.size(0) == sizes[0]) {
+          return buffer;
+        }
+        return buffer.narrow(/*dim=*/0, /*start=*/0, /*length=*/sizes[0]);
+      }
+      evictable = i;
+    }
+
+    auto buffer = allocate(sizes, options);
+    if (buffers_.size() < options_.capacity()) {
+      buffers_.push_back(buffer);
+    } else if (evictable) {
+      buffers_[*evictable] = buffer;
+    }
+    return buffer;
+  }
+
+ private:
+  static bool is_free(const Tensor& buffer) {
+    return buffer.use_count() == 1 && buffer.storage().use_count() == 1;
+  }
+
+  static bool fits(
+      const Tensor& buffer,
+      IntArrayRef sizes,
+      const TensorOptions& options) {
+    return buffer.dtype() == options.dtype() &&
+        buffer.device() == options.device() &&
+        buffer.dim() == static_cast<int64_t>(sizes.size()) &&
+        buffer.size(0) >= sizes[0] &&
+        buffer.sizes().slice(1) == sizes.slice(1);
+  }
+
+  Tensor allocate(IntArrayRef sizes, const TensorOptions& options) const {
+    auto buffer =
+        torch::empty(sizes, options.pinned_memory(options_.pin_memory()));
+    if (options_.numa_node()) {
+      c10::NUMAMove(buffer.data_ptr(), buffer.nbytes(), *options_.numa_node());
+    }
+    return buffer;
+  }
+
+  const PooledStackOptions options_;
+  std::vector<Tensor> buffers_;
+  std::mutex mutex_;
+};
+
+/// Stacks `tensors` into a buffer acquired from `pool`.
+inline Tensor stack_into_pool(
+    const std::vector<Tensor>& tensors,
+    BatchBufferPool& pool) {
+  TORCH_CHECK(!tensors.empty(), "Cannot collate an empty batch");
+  std::vector<int64_t> sizes = tensors.front().sizes().vec();
+  sizes.insert(sizes.begin(), tensors.size());
+  auto batch = pool.acquire(sizes, tensors.front().options());
+  torch::stack_out(batch, tensors);
+  return batch;
+}
+} // namespace detail
+
+template <typename T = Example<>>
+struct PooledStack;
+
+/// A `Collation` for `Example<Tensor, Tensor>` types that, like `Stack`, stacks
+/// all data tensors into one tensor and all target tensors into another, but
+/// writes them straight into batch buffers recycled from a pool instead of
+/// allocating new tensors for every batch. Copies of the collation, such as
+/// the ones held by the `DataLoader` workers, share the same pools.
+template <>
+struct PooledStack<Example<>> : public Collation<Example<>> {
+  explicit PooledStack(PooledStackOptions options = PooledStackOptions())
+      : data_pool_(std::make_shared<detail::BatchBufferPool>(options)),
+        target_pool_(std::make_shared<detail::BatchBufferPool>(options)) {}
+
+  Example<> apply_batch(std::vector<Example<>> examples) override {
+    std::vector<torch::Tensor> data, targets;
+    data.reserve(examples.size());
+    targets.reserve(examples.size());
+    for (auto& example : examples) {
+      data.push_back(std::move(example.data));
+      targets.push_back(std::move(example.target));
+    }
+    return {detail::stack_into_pool(data, *data_pool_),
+            detail::stack_into_pool(targets, *target_pool_)};
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferPool> data_pool_;
+  std::shared_ptr<detail::BatchBufferPool> target_pool_;
+};
+
+/// A `Collation` for `Example<Tensor, NoTarget>` types that stacks all data
+/// tensors into one tensor recycled from a pool, like `PooledStack<Example<>>`.
+template <>
+struct PooledStack<TensorExample>
+    : public Collation<Example<Tensor, example::NoTarget>> {
+  explicit PooledStack(PooledStackOptions options = PooledStackOptions())
+      : data_pool_(std::make_shared<detail::BatchBufferPool>(options)) {}
+
+  TensorExample apply_batch(std::vector<TensorExample> examples) override {
+    std::vector<torch::Tensor> data;
+    data.reserve(examples.size());
+    for (auto& example : examples) {
+      data.push_back(std::move(example.data));
+    }
+    return detail::stack_into_pool(data, *data_pool_);
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferPool> data_pool_;
+};
+} // namespace transforms
+} // namespace data
+} // namespace torch
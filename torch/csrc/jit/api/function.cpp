@@ -36,6 +36,10 @@ void Function::run(Stack&& stack) {
   run(stack);
 }
 
+void Function::run(Stack& stack, TaskLauncher taskLauncher) {
+  get_executor().run(stack, std::move(taskLauncher));
+}
+
 IValue Function::operator()(
     std::vector<IValue> stack,
     const Kwargs& kwargs) {
@@ -29,6 +29,9 @@ struct TORCH_API Function {
 
   void run(Stack&& stack);
 
+  // Forks in the function are launched with taskLauncher
+  void run(Stack& stack, TaskLauncher taskLauncher);
+
   IValue operator()(
       std::vector<IValue> stack,
       const Kwargs& kwargs = Kwargs());
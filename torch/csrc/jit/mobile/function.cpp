@@ -4,11 +4,56 @@
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 #include <ATen/core/op_registration/op_registration.h>
 
+#include <atomic>
+
 namespace torch{
 namespace jit{
 
 char const * toString(OpCode op);
 namespace mobile {
+namespace {
+// An operator that is looked up in the dispatcher the first time it runs, so
+// that loading a model does not pay for the lookups of operators that never
+// run, and does not fail on them. Code may be shared by several
+// InterpreterStates running on different threads; once resolved, a call only
+// loads the cached handle.
+class LazyOperator {
+ public:
+  explicit LazyOperator(c10::OperatorName opname)
+      : opname_(std::move(opname)) {}
+
+  ~LazyOperator() {
+    delete op_.load();
+  }
+
+  const c10::OperatorHandle& handle() {
+    const c10::OperatorHandle* op = op_.load(std::memory_order_acquire);
+    if (C10_LIKELY(op != nullptr)) {
+      return *op;
+    }
+    return resolve();
+  }
+
+ private:
+  const c10::OperatorHandle& resolve() {
+    auto found = c10::Dispatcher::singleton().findSchema(opname_);
+    TORCH_CHECK(found.has_value(), opname_.name, ".", opname_.overload_name, " cannot be found.");
+    auto op = new c10::OperatorHandle(std::move(*found));
+    const c10::OperatorHandle* expected = nullptr;
+    // another thread may have resolved it first
+    if (!op_.compare_exchange_strong(
+            expected, op, std::memory_order_acq_rel)) {
+      delete op;
+      return *expected;
+    }
+    return *op;
+  }
+
+  c10::OperatorName opname_;
+  std::atomic<const c10::OperatorHandle*> op_{nullptr};
+};
+} // namespace
+
 Function::Function(c10::QualifiedName name)
     : name_(name), code_(std::make_shared<Code>()) {}
 
@@ -28,12 +73,11 @@ void Function::append_operator(const std::string& name,
   if (opname.name != "aten::Int") {
     opname.name = "_" + opname.name;
   }
-  auto op = c10::Dispatcher::singleton().findSchema(opname);
-  TORCH_CHECK(op.has_value(), opname.name, ".", opname.overload_name, " cannot be found.");
+  auto op = std::make_shared<LazyOperator>(std::move(opname));
   // TODO: operator.h now does not depend on Node* so we can also look up operators from
   // that registry for use in mobile as a way to share implementations.
   auto fn = [op](Stack& stack) {
-    c10::Dispatcher::singleton().callBoxed(*op, &stack);
+    c10::Dispatcher::singleton().callBoxed(op->handle(), &stack);
   };
   code_->operators_.emplace_back(fn);
 }
@@ -2,6 +2,12 @@
 #include <ATen/ATen.h>
 #include <ATen/core/stack.h>
 
+#if defined(TORCH_MOBILE_SELECTED_OPS_HEADER)
+// Generated by tools/jit/gen_mobile_op_manifest.py from SELECTED_OP_LIST.
+// Defines TORCH_MOBILE_SELECTED_OPS as a ";"-separated list of operator names.
+#include TORCH_MOBILE_SELECTED_OPS_HEADER
+#endif
+
 using Stack = std::vector<c10::IValue>;
 using torch::jit::peek;
 using torch::jit::drop;
@@ -173,7 +179,41 @@ void listAppend(const c10::OperatorHandle& op, Stack* stack) {
   push(*stack, std::move(list));
 }
 
-static auto registry = torch::RegisterOperators().op(
+// Returns whether the operator with the given schema is part of a selective
+// build. The schema name carries the "_" prefix used by the lite interpreter,
+// which is stripped before looking it up in the manifest.
+bool isSelectedOp(const std::string& schema) {
+#if defined(TORCH_MOBILE_SELECTED_OPS)
+  auto name = schema.substr(0, schema.find('('));
+  if (!name.empty() && name[0] == '_') {
+    name = name.substr(1);
+  }
+  static const std::string selected = ";" TORCH_MOBILE_SELECTED_OPS ";";
+  return selected.find(";" + name + ";") != std::string::npos;
+#else
+  return true;
+#endif
+}
+
+// Wraps torch::RegisterOperators and drops the registrations of operators
+// that are not in the selective-build manifest, so that the lite interpreter
+// does not pay at startup for operators none of the shipped models use.
+class SelectiveRegisterOperators final {
+ public:
+  SelectiveRegisterOperators&& op(
+      const std::string& schema,
+      torch::RegisterOperators::Options&& options) && {
+    if (isSelectedOp(schema)) {
+      std::move(registry_).op(schema, std::move(options));
+    }
+    return std::move(*this);
+  }
+
+ private:
+  torch::RegisterOperators registry_;
+};
+
+static auto registry = SelectiveRegisterOperators().op(
   "_aten::add.Tensor",
   torch::RegisterOperators::options().kernel(c10::DispatchKey::CPUTensorId,
   [](at::Tensor a, at::Tensor b, at::Scalar c) -> at::Tensor {
@@ -0,0 +1,158 @@
+#include <torch/csrc/jit/passes/fold_frozen_batch_norm.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isConvOrLinear(const Node* n) {
+  return n->kind() == aten::conv1d || n->kind() == aten::conv2d ||
+      n->kind() == aten::conv3d || n->kind() == aten::linear;
+}
+
+// Whether user is the only node that reads the values of v; the checks of
+// the rank of the input in the forward of BatchNorm2d and the like only read
+// its shape, which folding or running in place does not change
+bool onlyValueUse(const Value* v, const Node* user) {
+  for (const Use& use : v->uses()) {
+    if (use.user != user && use.user->kind() != aten::dim &&
+        use.user->kind() != aten::size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+c10::optional<at::Tensor> constantTensor(const Value* v) {
+  auto ivalue = toIValue(v);
+  if (!ivalue || !ivalue->isTensor()) {
+    return c10::nullopt;
+  }
+  return ivalue->toTensor();
+}
+
+// A None weight or bias of batch_norm is ones or zeros
+c10::optional<at::Tensor> constantTensorOr(
+    const Value* v,
+    const at::Tensor& like,
+    double fill) {
+  if (v->mustBeNone()) {
+    return at::full_like(like, fill);
+  }
+  return constantTensor(v);
+}
+
+// aten::batch_norm(input, weight, bias, running_mean, running_var, training,
+//                  momentum, eps, cudnn_enabled)
+bool tryFold(Node* bn) {
+  Value* input = bn->input(0);
+  Node* conv = input->node();
+  if (!isConvOrLinear(conv) || !onlyValueUse(input, bn)) {
+    return false;
+  }
+  if (conv->kind() == aten::linear) {
+    auto type = conv->input(0)->type()->cast<TensorType>();
+    if (!type || type->dim() != 2) {
+      return false;
+    }
+  }
+  auto training = constant_as<bool>(bn->input(5));
+  auto eps = constant_as<double>(bn->input(7));
+  auto rm = constantTensor(bn->input(3));
+  auto rv = constantTensor(bn->input(4));
+  auto w = constantTensor(conv->input(1));
+  if (!training || *training || !eps || !rm || !rv || !w) {
+    return false;
+  }
+  auto bn_w = constantTensorOr(bn->input(1), *rm, 1);
+  auto bn_b = constantTensorOr(bn->input(2), *rm, 0);
+  auto b = constantTensorOr(conv->input(2), *rm, 0);
+  if (!bn_w || !bn_b || !b) {
+    return false;
+  }
+
+  // same as FoldConvBatchNorm2d, for any rank of weight
+  at::NoGradGuard no_grad;
+  std::vector<int64_t> shape(w->dim(), 1);
+  shape[0] = -1;
+  at::Tensor bn_var_rsqrt = at::rsqrt(*rv + *eps);
+  at::Tensor new_w = *w * (*bn_w * bn_var_rsqrt).reshape(shape);
+  at::Tensor new_b = (*b - *rm) * bn_var_rsqrt * *bn_w + *bn_b;
+
+  Graph* graph = bn->owningGraph();
+  WithInsertPoint guard(conv);
+  conv->replaceInput(1, graph->insertConstant(new_w));
+  conv->replaceInput(2, graph->insertConstant(new_b));
+  bn->output()->replaceAllUsesWith(conv->output());
+  GRAPH_UPDATE("Folded ", *bn, "into ", *conv);
+  bn->destroy();
+  return true;
+}
+
+bool foldBatchNorms(Block* b) {
+  bool changed = false;
+  for (auto it = b->nodes().begin(); it != b->nodes().end();) {
+    Node* n = *it++;
+    for (Block* ib : n->blocks()) {
+      changed |= foldBatchNorms(ib);
+    }
+    if (n->kind() == aten::batch_norm) {
+      changed |= tryFold(n);
+    }
+  }
+  return changed;
+}
+
+void inplaceActivations(Block* b) {
+  for (auto it = b->nodes().begin(); it != b->nodes().end();) {
+    Node* n = *it++;
+    for (Block* ib : n->blocks()) {
+      inplaceActivations(ib);
+    }
+    Symbol inplace;
+    if (n->kind() == aten::relu) {
+      inplace = aten::relu_;
+    } else if (n->kind() == aten::clamp) {
+      inplace = aten::clamp_;
+    } else {
+      continue;
+    }
+    Value* input = n->input(0);
+    if (!isConvOrLinear(input->node()) || !onlyValueUse(input, n)) {
+      continue;
+    }
+    Graph* graph = n->owningGraph();
+    Node* activation =
+        graph->create(inplace, n->inputs(), 1)->insertBefore(n);
+    activation->output()->copyMetadata(n->output());
+    activation->setScope(n->scope());
+    n->output()->replaceAllUsesWith(activation->output());
+    GRAPH_UPDATE("Replaced ", *n, "with ", *activation);
+    n->destroy();
+  }
+}
+
+} // namespace
+
+bool FoldFrozenBatchNorm(std::shared_ptr<Graph>& graph) {
+  bool changed = foldBatchNorms(graph->block());
+  if (changed) {
+    // the weights of the convolutions that were folded
+    EliminateDeadCode(graph);
+  }
+  GRAPH_DUMP("After FoldFrozenBatchNorm: ", graph);
+  return changed;
+}
+
+void InplaceFrozenConvActivations(std::shared_ptr<Graph>& graph) {
+  inplaceActivations(graph->block());
+  GRAPH_DUMP("After InplaceFrozenConvActivations: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,33 @@
+/** \brief Folding of inference-mode batch norms into the convolutions and
+ * linear layers of frozen modules
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Fold eval-mode aten::batch_norm into a preceding aten::conv1d,
+ * aten::conv2d, aten::conv3d or aten::linear
+ *
+ * Meant to run on the graphs of freeze_module, where the weights are
+ * constants. A batch norm is folded when nothing else reads the values of
+ * its input and the weights of both nodes, and training = False, are
+ * constants. The batch norm after a linear is only folded when the input of
+ * the linear is known to be 2-d, otherwise it may not normalize the output
+ * features.
+ * Returns true if anything was folded.
+ */
+TORCH_API bool FoldFrozenBatchNorm(std::shared_ptr<Graph>& graph);
+
+/** \brief Make an aten::relu or aten::clamp that is the only node reading
+ * the output of a convolution or linear layer run in place on that output
+ *
+ * None of the float convolutions reachable from the JIT take a post-op, so
+ * this saves the allocation of the activation rather than its pass.
+ */
+TORCH_API void InplaceFrozenConvActivations(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,107 @@
+#include <torch/csrc/jit/passes/fuse_layer_norm.h>
+
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/subgraph_matcher.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/subgraph_rewrite.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// The fused ops have no alpha, so only add(a, b, 1) can be fused
+bool alphaIsOne(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap) {
+  auto alpha = toIValue(match.values_map.at(vmap.at("alpha")));
+  if (!alpha) {
+    return false;
+  }
+  return (alpha->isInt() && alpha->toInt() == 1) ||
+      (alpha->isDouble() && alpha->toDouble() == 1.0);
+}
+
+// The fused ops take Tensors, so add.Scalar and optional biases are left alone
+bool isTensor(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap,
+    const std::string& name) {
+  return match.values_map.at(vmap.at(name))
+      ->type()
+      ->isSubtypeOf(TensorType::get());
+}
+
+} // namespace
+
+void FuseAddLayerNorm(std::shared_ptr<Graph>& graph) {
+  std::string add_layer_norm_pattern = R"IR(
+    graph(%input, %residual, %alpha, %shape, %weight, %bias, %eps, %cudnn_enable):
+        %x = aten::add(%input, %residual, %alpha)
+        %res = aten::layer_norm(%x, %shape, %weight, %bias, %eps, %cudnn_enable)
+        return (%res))IR";
+  std::string fused_add_layer_norm = R"IR(
+    graph(%input, %residual, %alpha, %shape, %weight, %bias, %eps, %cudnn_enable):
+        %res = aten::_add_layer_norm(%input, %residual, %shape, %weight, %bias, %eps)
+        return (%res))IR";
+
+  SubgraphRewriter add_layer_norm;
+  add_layer_norm.RegisterRewritePattern(
+      add_layer_norm_pattern, fused_add_layer_norm);
+  add_layer_norm.runOnGraph(
+      graph,
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        return isTensor(match, vmap, "residual") && alphaIsOne(match, vmap);
+      });
+  GRAPH_DUMP("After FuseAddLayerNorm: ", graph);
+}
+
+void FuseBiasGelu(std::shared_ptr<Graph>& graph) {
+  std::string add_gelu_pattern = R"IR(
+    graph(%input, %bias, %alpha):
+        %x = aten::add(%input, %bias, %alpha)
+        %res = aten::gelu(%x)
+        return (%res))IR";
+  std::string fused_add_gelu = R"IR(
+    graph(%input, %bias, %alpha):
+        %res = aten::_bias_gelu(%input, %bias)
+        return (%res))IR";
+
+  // the bias of a linear is added by the GEMM as an extra pass over its
+  // output, which _bias_gelu does for free
+  std::string linear_gelu_pattern = R"IR(
+    graph(%input, %weight, %bias):
+        %x = aten::linear(%input, %weight, %bias)
+        %res = aten::gelu(%x)
+        return (%res))IR";
+  std::string linear_bias_gelu = R"IR(
+    graph(%input, %weight, %bias):
+        %none : Tensor? = prim::Constant()
+        %x = aten::linear(%input, %weight, %none)
+        %res = aten::_bias_gelu(%x, %bias)
+        return (%res))IR";
+
+  SubgraphRewriter add_gelu;
+  add_gelu.RegisterRewritePattern(add_gelu_pattern, fused_add_gelu);
+  add_gelu.runOnGraph(
+      graph,
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        return isTensor(match, vmap, "bias") && alphaIsOne(match, vmap);
+      });
+
+  // _bias_gelu takes a Tensor, not a Tensor?
+  SubgraphRewriter linear_gelu;
+  linear_gelu.RegisterRewritePattern(linear_gelu_pattern, linear_bias_gelu);
+  linear_gelu.runOnGraph(
+      graph,
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        return isTensor(match, vmap, "bias");
+      });
+  GRAPH_DUMP("After FuseBiasGelu: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,26 @@
+/** \brief Fusing the pointwise ops around layer norms and GELUs of
+ * transformer blocks into the fused CPU ops of ATen
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Replace aten::add followed by aten::layer_norm, the residual add
+ * of a transformer block, with a single aten::_add_layer_norm
+ */
+TORCH_API void FuseAddLayerNorm(std::shared_ptr<Graph>& graph);
+
+/** \brief Replace aten::add followed by aten::gelu with aten::_bias_gelu, and
+ * move the bias of an aten::linear followed by aten::gelu into an
+ * aten::_bias_gelu
+ *
+ * The fused ops take the unfused path when a gradient is needed, so this is
+ * only useful for inference.
+ */
+TORCH_API void FuseBiasGelu(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
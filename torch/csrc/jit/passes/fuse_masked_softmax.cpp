@@ -0,0 +1,93 @@
+#include <torch/csrc/jit/passes/fuse_masked_softmax.h>
+
+#include <torch/csrc/jit/ir/subgraph_matcher.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/subgraph_rewrite.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using ValueMap = std::unordered_map<std::string, Value*>;
+
+Value* matched(const Match& match, const ValueMap& vmap, const char* name) {
+  return match.values_map.at(vmap.at(name));
+}
+
+// softmax with a dtype converts its input first, and masked_fill with a
+// Tensor value is a different overload
+bool isFusable(const Match& match, const ValueMap& vmap) {
+  return matched(match, vmap, "dtype")->mustBeNone() &&
+      matched(match, vmap, "value")->type()->isSubtypeOf(NumberType::get());
+}
+
+} // namespace
+
+void FuseMaskedSoftmax(std::shared_ptr<Graph>& graph) {
+  std::string masked_softmax_pattern = R"IR(
+    graph(%input, %mask, %value, %dim, %dtype):
+        %x = aten::masked_fill(%input, %mask, %value)
+        %res = aten::softmax(%x, %dim, %dtype)
+        return (%res))IR";
+  std::string fused_masked_softmax = R"IR(
+    graph(%input, %mask, %value, %dim, %dtype):
+        %scale : float = prim::Constant[value=1.]()
+        %res = aten::_masked_softmax(%input, %mask, %dim, %value, %scale)
+        return (%res))IR";
+
+  std::string mul_masked_softmax_pattern = R"IR(
+    graph(%input, %scale, %mask, %value, %dim, %dtype):
+        %s = aten::mul(%input, %scale)
+        %x = aten::masked_fill(%s, %mask, %value)
+        %res = aten::softmax(%x, %dim, %dtype)
+        return (%res))IR";
+  std::string fused_mul_masked_softmax = R"IR(
+    graph(%input, %scale, %mask, %value, %dim, %dtype):
+        %res = aten::_masked_softmax(%input, %mask, %dim, %value, %scale)
+        return (%res))IR";
+
+  std::string div_masked_softmax_pattern = R"IR(
+    graph(%input, %divisor, %mask, %value, %dim, %dtype):
+        %s = aten::div(%input, %divisor)
+        %x = aten::masked_fill(%s, %mask, %value)
+        %res = aten::softmax(%x, %dim, %dtype)
+        return (%res))IR";
+  std::string fused_div_masked_softmax = R"IR(
+    graph(%input, %divisor, %mask, %value, %dim, %dtype):
+        %one : float = prim::Constant[value=1.]()
+        %scale : float = aten::div(%one, %divisor)
+        %res = aten::_masked_softmax(%input, %mask, %dim, %value, %scale)
+        return (%res))IR";
+
+  // the scaled patterns go first, since the unscaled one matches their tail
+  SubgraphRewriter mul_masked_softmax;
+  mul_masked_softmax.RegisterRewritePattern(
+      mul_masked_softmax_pattern, fused_mul_masked_softmax);
+  mul_masked_softmax.runOnGraph(
+      graph, [](const Match& match, const ValueMap& vmap) {
+        // _masked_softmax takes the scale as a float
+        return isFusable(match, vmap) &&
+            matched(match, vmap, "scale")->type()->isSubtypeOf(
+                FloatType::get());
+      });
+
+  SubgraphRewriter div_masked_softmax;
+  div_masked_softmax.RegisterRewritePattern(
+      div_masked_softmax_pattern, fused_div_masked_softmax);
+  div_masked_softmax.runOnGraph(
+      graph, [](const Match& match, const ValueMap& vmap) {
+        return isFusable(match, vmap) &&
+            matched(match, vmap, "divisor")->type()->isSubtypeOf(
+                NumberType::get());
+      });
+
+  SubgraphRewriter masked_softmax;
+  masked_softmax.RegisterRewritePattern(
+      masked_softmax_pattern, fused_masked_softmax);
+  masked_softmax.runOnGraph(graph, isFusable);
+  GRAPH_DUMP("After FuseMaskedSoftmax: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,21 @@
+/** \brief Fusing the masking and scaling of attention scores into their
+ * softmax
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Replace aten::masked_fill followed by aten::softmax, optionally
+ * preceded by a multiplication or division by a number, with a single
+ * aten::_masked_softmax
+ *
+ * The fused op takes the unfused path when a gradient is needed, so this is
+ * only useful for inference.
+ */
+TORCH_API void FuseMaskedSoftmax(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
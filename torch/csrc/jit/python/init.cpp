@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/ir/irparser.h>
 #include <torch/csrc/jit/runtime/operator.h>
+#include <torch/csrc/jit/runtime/profiling_cache.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -18,7 +19,10 @@
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/decompose_ops.h>
 #include <torch/csrc/jit/passes/erase_number_types.h>
+#include <torch/csrc/jit/passes/fold_frozen_batch_norm.h>
+#include <torch/csrc/jit/passes/fuse_layer_norm.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
+#include <torch/csrc/jit/passes/fuse_masked_softmax.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/inline_fork_wait.h>
 #include <torch/csrc/jit/passes/inliner.h>
@@ -205,7 +209,14 @@ void initJITBindings(PyObject* module) {
             return freeze_module(module);
           },
           py::arg("module"))
+      .def("_jit_pass_fold_frozen_batch_norm", &FoldFrozenBatchNorm)
+      .def(
+          "_jit_pass_inplace_frozen_conv_activations",
+          &InplaceFrozenConvActivations)
       .def("_jit_pass_fuse_linear", &FuseLinear)
+      .def("_jit_pass_fuse_add_layer_norm", &FuseAddLayerNorm)
+      .def("_jit_pass_fuse_bias_gelu", &FuseBiasGelu)
+      .def("_jit_pass_fuse_masked_softmax", &FuseMaskedSoftmax)
       .def(
           "_jit_pass_fold_quantize",
           [](script::Module& module, const std::string& method_name) {
@@ -379,6 +390,16 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_profiling_cache_mode",
+          [](bool enabled) {
+            bool old_state = getProfilingCacheMode();
+            getProfilingCacheMode() = enabled;
+            return old_state;
+          })
+      .def("_jit_save_profiling_cache", saveProfilingCache)
+      .def("_jit_load_profiling_cache", loadProfilingCache)
+      .def("_jit_clear_profiling_cache", clearProfilingCache)
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { script::getInlineEverythingMode() = enabled; })
@@ -2,6 +2,7 @@
 
 #include <ATen/core/ivalue.h>
 #include <c10/util/Exception.h>
+#include <c10/util/LeftRight.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/jit/runtime/argument_spec.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
@@ -41,6 +42,8 @@
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/jit/runtime/logging.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <iterator>
 #include <memory>
@@ -465,7 +468,7 @@ GraphExecutor* getGradExecutor(Operation& op) {
 }
 } // namespace detail
 
-void GraphExecutorImplBase::run(Stack& stack) {
+void GraphExecutorImplBase::run(Stack& stack, TaskLauncher taskLauncher) {
   TORCH_CHECK(
       stack.size() >= num_inputs,
       "expected ",
@@ -479,7 +482,7 @@ void GraphExecutorImplBase::run(Stack& stack) {
 
   ExecutionPlan plan =
       getPlanFor(stack, GraphExecutor::getDefaultNumBailOuts());
-  InterpreterState(plan.code).run(stack);
+  InterpreterState(plan.code, std::move(taskLauncher)).run(stack);
   last_executed_optimized_graph = plan.graph;
 }
 
@@ -504,47 +507,91 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
   GraphExecutorState getDebugState() override {
     GraphExecutorState state;
     state.graph = graph.get();
-    if (fallback) {
+    if (fallback_ready) {
       state.fallback = fallback;
     }
-    for (auto& entry : plan_cache) {
-      state.execution_plans.emplace(entry.first, entry.second);
-    }
+    plan_cache.read([&](const PlanCache& cache) {
+      for (auto& entry : cache) {
+        state.execution_plans.emplace(entry.first, entry.second);
+      }
+    });
     return state;
   }
 
+  GraphExecutorCacheStats getCacheStats() override {
+    GraphExecutorCacheStats stats;
+    stats.hits = cache_hits.load(std::memory_order_relaxed);
+    stats.misses = cache_misses.load(std::memory_order_relaxed);
+    stats.compile_time_ns = compile_time_ns.load(std::memory_order_relaxed);
+    return stats;
+  }
+
  protected:
   friend struct GraphExecutor;
 
+  using PlanCache = std::unordered_map<ArgumentSpec, ExecutionPlan>;
+
   const ExecutionPlan& getOrCompileFallback() {
-    std::lock_guard<std::mutex> lock(compile_mutex);
-    if (!fallback) {
-      auto graph_ = graph->copy();
-      runRequiredPasses(graph_);
-      fallback = ExecutionPlan(graph_);
+    // fallback is only written once, before fallback_ready is set
+    if (!fallback_ready.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(compile_mutex);
+      if (!fallback_ready.load(std::memory_order_relaxed)) {
+        auto graph_ = graph->copy();
+        runRequiredPasses(graph_);
+        fallback = ExecutionPlan(graph_);
+        fallback_ready.store(true, std::memory_order_release);
+      }
     }
     return fallback;
   }
 
-  const ExecutionPlan& getOrCompile(const Stack& stack) {
-    // outside lock guard, to minimize the time holding the lock on the fast
-    // path ArgumentSpec even computes its hashCode here.
+  c10::optional<ExecutionPlan> lookupPlan(const ArgumentSpec& spec) const {
+    return plan_cache.read(
+        [&](const PlanCache& cache) -> c10::optional<ExecutionPlan> {
+          auto it = cache.find(spec);
+          if (it == cache.end()) {
+            return c10::nullopt;
+          }
+          return it->second;
+        });
+  }
+
+  ExecutionPlan getOrCompile(const Stack& stack) {
+    // ArgumentSpec even computes its hashCode here, and a plan that was
+    // already compiled is found without taking compile_mutex
     ArgumentSpec spec =
         arg_spec_creator_.create(autograd::GradMode::is_enabled(), stack);
-    {
-      std::lock_guard<std::mutex> lock(compile_mutex);
-      auto it = plan_cache.find(spec);
-      if (it != plan_cache.end()) {
-        logging::getLogger()->addStatValue(
-            logging::runtime_counters::EXECUTION_PLAN_CACHE_HIT, 1.0);
-        return it->second;
-      }
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      logging::getLogger()->addStatValue(
-          logging::runtime_counters::EXECUTION_PLAN_CACHE_MISS, 1.0);
-      return r.first->second;
+    if (auto plan = lookupPlan(spec)) {
+      recordHit();
+      return std::move(*plan);
+    }
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    // another thread may have compiled it while we were waiting
+    if (auto plan = lookupPlan(spec)) {
+      recordHit();
+      return std::move(*plan);
     }
+    auto start = std::chrono::steady_clock::now();
+    auto plan = compileSpec(spec);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    plan_cache.write([&](PlanCache& cache) { cache.emplace(spec, plan); });
+    cache_misses.fetch_add(1, std::memory_order_relaxed);
+    compile_time_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    logging::getLogger()->addStatValue(
+        logging::runtime_counters::EXECUTION_PLAN_CACHE_MISS, 1.0);
+    logging::getLogger()->addStatValue(
+        logging::runtime_counters::EXECUTION_PLAN_COMPILE_TIME, elapsed);
+    return plan;
+  }
+
+  void recordHit() {
+    // a static name, so that hits do not allocate a string for the logger
+    static const std::string hit_stat =
+        logging::runtime_counters::EXECUTION_PLAN_CACHE_HIT;
+    cache_hits.fetch_add(1, std::memory_order_relaxed);
+    logging::getLogger()->addStatValue(hit_stat, 1.0);
   }
 
   ExecutionPlan compileSpec(const ArgumentSpec& spec) {
@@ -617,10 +664,16 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
   // Populated only when optimize is false (and in that case plan_cache will be
   // unused). The compiled version of graph.
   ExecutionPlan fallback;
+  std::atomic<bool> fallback_ready{false};
 
   // Mapping from argument configurations to optimized versions of the graph
-  // that are specialized to the spec.
-  std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
+  // that are specialized to the spec. Plans are only ever added, under
+  // compile_mutex; LeftRight keeps the lookups wait-free.
+  c10::LeftRight<PlanCache> plan_cache;
+
+  std::atomic<size_t> cache_hits{0};
+  std::atomic<size_t> cache_misses{0};
+  std::atomic<int64_t> compile_time_ns{0};
 };
 
 GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph)
@@ -630,8 +683,8 @@ GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph)
                             : dynamic_cast<GraphExecutorImplBase*>(
                                   new GraphExecutorImpl(graph))) {}
 
-void GraphExecutor::run(Stack& inputs) {
-  return pImpl->run(inputs);
+void GraphExecutor::run(Stack& inputs, TaskLauncher taskLauncher) {
+  return pImpl->run(inputs, std::move(taskLauncher));
 }
 
 size_t GraphExecutor::getDefaultNumBailOuts() {
@@ -652,6 +705,10 @@ GraphExecutorState GraphExecutor::getDebugState() {
   return pImpl->getDebugState();
 }
 
+GraphExecutorCacheStats GraphExecutor::getCacheStats() {
+  return pImpl->getCacheStats();
+}
+
 void runRequiredPasses(const std::shared_ptr<Graph>& g) {
   // implicit inserted expand nodes are not necessarily always valid
   // when used inside script methods that might have unstable shapes
@@ -39,11 +39,21 @@ struct GraphExecutorState {
   std::unordered_map<ArgumentSpec, ExecutionPlan> execution_plans;
 };
 
+// Counters of the specialized plans of a GraphExecutor, see
+// GraphExecutor::getCacheStats
+struct GraphExecutorCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  // total time spent compiling the plans of the misses
+  int64_t compile_time_ns = 0;
+};
+
 struct GraphExecutorImplBase;
 struct TORCH_API GraphExecutor {
   GraphExecutor() = default;
   GraphExecutor(std::shared_ptr<Graph> graph);
-  void run(Stack& inputs);
+  // Forks in the graph are launched with taskLauncher
+  void run(Stack& inputs, TaskLauncher taskLauncher = at::launch);
   // `remaining_bailout_depth` stands for the maximum number of profiled and
   // specialized recompilations allowed for the current `GraphExecutor`. if
   // remaining_bailout_depth is equal to 0, `GraphExecutor` won't perform any
@@ -59,6 +69,8 @@ struct TORCH_API GraphExecutor {
   }
   std::shared_ptr<Graph> graph() const;
   GraphExecutorState getDebugState();
+  // Only counted by the legacy (non-profiling) executor
+  GraphExecutorCacheStats getCacheStats();
 
   static size_t getDefaultNumBailOuts();
 
@@ -62,12 +62,15 @@ struct GraphExecutorImplBase {
         num_outputs(this->graph->outputs().size()) {}
 
   // entry point where execution begins
-  void run(Stack& stack);
+  void run(Stack& stack, TaskLauncher taskLauncher = at::launch);
 
   virtual ExecutionPlan getPlanFor(
       Stack& stack,
       size_t remaining_bailout_depth) = 0;
   virtual GraphExecutorState getDebugState() = 0;
+  virtual GraphExecutorCacheStats getCacheStats() {
+    return GraphExecutorCacheStats();
+  }
   virtual ~GraphExecutorImplBase() = default;
 
  protected:
@@ -84,7 +87,8 @@ struct GraphExecutorImplBase {
   const size_t num_outputs;
 
   // GraphExecutors can be accessed from multiple threads, so this thread needs
-  // to be held every time we access the fallback or plan_cache.
+  // to be held every time we compile a plan. Lookups of plans that were
+  // already compiled do not take it.
   std::mutex compile_mutex;
 };
 
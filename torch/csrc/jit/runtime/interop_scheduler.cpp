@@ -0,0 +1,176 @@
+#include <torch/csrc/jit/runtime/interop_scheduler.h>
+
+#include <ATen/Parallel.h>
+#include <c10/core/thread_pool.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+#include <c10/util/thread_name.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// the scheduler and worker running on this thread, if any
+thread_local InterOpScheduler* current_scheduler = nullptr;
+thread_local size_t current_worker = 0;
+// tasks launched inline that are running on this thread
+thread_local size_t inline_depth = 0;
+
+} // namespace
+
+constexpr size_t InterOpScheduler::kNumPriorities;
+
+InterOpScheduler::InterOpScheduler(InterOpSchedulerOptions options)
+    : max_inline_depth_(options.max_inline_depth) {
+  size_t num_threads = options.num_threads
+      ? options.num_threads
+      : c10::TaskThreadPoolBase::defaultNumThreads();
+  TORCH_CHECK(num_threads > 0, "InterOpScheduler needs at least one thread");
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_[i]->thread = std::thread([this, i]() { workerLoop(i); });
+  }
+  // otherwise the first launches would run inline
+  while (idle_.load() < num_threads) {
+    std::this_thread::yield();
+  }
+}
+
+InterOpScheduler::~InterOpScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void InterOpScheduler::launch(std::function<void()> fn, Priority priority) {
+  Task task{std::move(fn), at::getThreadLocalDebugInfo(), {}};
+  if (inline_depth < max_inline_depth_ && idle_.load() == 0) {
+    tasks_inlined_.fetch_add(1, std::memory_order_relaxed);
+    ++inline_depth;
+    runTask(task);
+    --inline_depth;
+    return;
+  }
+
+  size_t index = current_scheduler == this
+      ? current_worker
+      : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  task.queued = std::chrono::steady_clock::now();
+  // counted before it is queued, so that pending_ never underflows; a worker
+  // woken in between only finds nothing and waits again
+  pending_.fetch_add(1);
+  {
+    auto& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queues[static_cast<size_t>(priority)].push_back(std::move(task));
+  }
+  tasks_queued_.fetch_add(1, std::memory_order_relaxed);
+  // pairs with the increment of idle_ in workerLoop: either the worker sees
+  // the task before it waits, or we see it idle and wake it
+  if (idle_.load() > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    sleep_cv_.notify_one();
+  }
+}
+
+TaskLauncher InterOpScheduler::launcher(Priority priority) {
+  return [this, priority](std::function<void()> fn) {
+    launch(std::move(fn), priority);
+  };
+}
+
+bool InterOpScheduler::takeTask(size_t index, Task& task) {
+  if (pending_.load() == 0) {
+    return false;
+  }
+  const size_t n = workers_.size();
+  for (size_t p = 0; p < kNumPriorities; ++p) {
+    for (size_t k = 0; k < n; ++k) {
+      auto& worker = *workers_[(index + k) % n];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      auto& queue = worker.queues[p];
+      if (queue.empty()) {
+        continue;
+      }
+      task = std::move(queue.front());
+      queue.pop_front();
+      pending_.fetch_sub(1);
+      if (k > 0) {
+        tasks_stolen_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void InterOpScheduler::runTask(Task& task) {
+  if (task.queued != std::chrono::steady_clock::time_point()) {
+    int64_t delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - task.queued)
+                        .count();
+    tasks_started_.fetch_add(1, std::memory_order_relaxed);
+    total_queue_delay_ns_.fetch_add(delay, std::memory_order_relaxed);
+    int64_t max_delay = max_queue_delay_ns_.load(std::memory_order_relaxed);
+    while (delay > max_delay &&
+           !max_queue_delay_ns_.compare_exchange_weak(
+               max_delay, delay, std::memory_order_relaxed)) {
+    }
+  }
+  at::DebugInfoGuard guard(std::move(task.debug_info));
+  try {
+    task.fn();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in inter-op task: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Exception in inter-op task: unknown";
+  }
+  // release whatever the task holds before going idle
+  task.fn = nullptr;
+}
+
+void InterOpScheduler::workerLoop(size_t index) {
+  c10::setThreadName("InterOpSched");
+  at::init_num_threads();
+  current_scheduler = this;
+  current_worker = index;
+  Task task;
+  for (;;) {
+    if (takeTask(index, task)) {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    idle_.fetch_add(1);
+    sleep_cv_.wait(lock, [this]() { return pending_.load() > 0 || stopping_; });
+    idle_.fetch_sub(1);
+    // queued tasks are run before the scheduler stops
+    if (stopping_ && pending_.load() == 0) {
+      return;
+    }
+  }
+}
+
+InterOpSchedulerStats InterOpScheduler::stats() const {
+  InterOpSchedulerStats stats;
+  stats.tasks_queued = tasks_queued_.load(std::memory_order_relaxed);
+  stats.tasks_inlined = tasks_inlined_.load(std::memory_order_relaxed);
+  stats.tasks_stolen = tasks_stolen_.load(std::memory_order_relaxed);
+  stats.tasks_started = tasks_started_.load(std::memory_order_relaxed);
+  stats.total_queue_delay_ns =
+      total_queue_delay_ns_.load(std::memory_order_relaxed);
+  stats.max_queue_delay_ns =
+      max_queue_delay_ns_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace jit
+} // namespace torch
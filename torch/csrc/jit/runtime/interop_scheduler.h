@@ -0,0 +1,119 @@
+#pragma once
+
+#include <ATen/ThreadLocalDebugInfo.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+struct InterOpSchedulerOptions {
+  // 0 means TaskThreadPoolBase::defaultNumThreads()
+  size_t num_threads = 0;
+  // 0 always queues
+  size_t max_inline_depth = 1;
+};
+
+struct InterOpSchedulerStats {
+  uint64_t tasks_queued = 0;
+  uint64_t tasks_inlined = 0;
+  // queued tasks run by a worker other than the one they were queued on
+  uint64_t tasks_stolen = 0;
+  // time between queueing and starting the queued tasks that have started
+  uint64_t tasks_started = 0;
+  int64_t total_queue_delay_ns = 0;
+  int64_t max_queue_delay_ns = 0;
+};
+
+// A thread pool for the forks of TorchScript programs, which can be used
+// instead of the global inter-op pool behind at::launch by passing one of its
+// launchers to GraphExecutor::run or InterpreterState. Giving unrelated
+// requests their own scheduler, or their own priority on a shared one, keeps
+// the forks of one from queueing behind the forks of another.
+//
+// Every worker has a queue per priority. Tasks launched by a worker go to its
+// own queue and other tasks are spread over the workers; an idle worker takes
+// the oldest task of the highest priority, from its own queues first and then
+// from the others. When no worker is idle, launch() runs the task on the
+// calling thread instead of queueing it, up to max_inline_depth nested
+// launches per thread. Forks never block on each other (wait() suspends the
+// interpreter), so running one inline only delays its caller. This includes
+// the continuation of a wait(), which may run inline on the thread completing
+// the future, as futures fire their callbacks without holding their lock.
+struct TORCH_API InterOpScheduler {
+  enum class Priority : uint8_t { High = 0, Normal = 1, Low = 2 };
+  static constexpr size_t kNumPriorities = 3;
+
+  explicit InterOpScheduler(
+      InterOpSchedulerOptions options = InterOpSchedulerOptions());
+  // Runs the queued tasks, then joins the workers
+  ~InterOpScheduler();
+
+  InterOpScheduler(const InterOpScheduler&) = delete;
+  InterOpScheduler& operator=(const InterOpScheduler&) = delete;
+
+  void launch(std::function<void()> task, Priority priority = Priority::Normal);
+
+  // The scheduler must outlive every run that uses the launcher
+  TaskLauncher launcher(Priority priority = Priority::Normal);
+
+  size_t size() const {
+    return workers_.size();
+  }
+
+  size_t numIdle() const {
+    return idle_.load();
+  }
+
+  InterOpSchedulerStats stats() const;
+
+ private:
+  struct Task {
+    std::function<void()> fn;
+    // propagated like at::launch does
+    std::shared_ptr<at::ThreadLocalDebugInfoBase> debug_info;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> queues[kNumPriorities];
+    std::thread thread;
+  };
+
+  void workerLoop(size_t index);
+  bool takeTask(size_t index, Task& task);
+  void runTask(Task& task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  const size_t max_inline_depth_;
+  std::atomic<size_t> next_worker_{0};
+
+  // queued tasks not yet taken, and workers waiting for one
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> idle_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stopping_ = false;
+
+  std::atomic<uint64_t> tasks_queued_{0};
+  std::atomic<uint64_t> tasks_inlined_{0};
+  std::atomic<uint64_t> tasks_stolen_{0};
+  std::atomic<uint64_t> tasks_started_{0};
+  std::atomic<int64_t> total_queue_delay_ns_{0};
+  std::atomic<int64_t> max_queue_delay_ns_{0};
+};
+
+} // namespace jit
+} // namespace torch
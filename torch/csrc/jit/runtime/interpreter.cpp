@@ -868,11 +868,15 @@ struct CodeImpl {
 
 // InterpreterState state that and used to compute a Code
 struct InterpreterStateImpl : c10::intrusive_ptr_target {
-  InterpreterStateImpl(const Code& code) {
+  InterpreterStateImpl(const Code& code, TaskLauncher taskLauncher)
+      : taskLauncher_(std::move(taskLauncher)) {
     enterFrame(code, 0);
   }
 
  private:
+  // launches forks and continuations, which inherit it
+  TaskLauncher taskLauncher_;
+
   // if we need to suspend, where do we reset the stack?
   // answer: to where it was when we were called, not
   // including any inputs to this function
@@ -1124,15 +1128,18 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 Callback(
                     c10::intrusive_ptr<InterpreterStateImpl> state,
                     Stack stack)
-                    : state_(std::move(state)), stack_(std::move(stack)) {}
+                    : taskLauncher_(state->taskLauncher_),
+                      state_(std::move(state)),
+                      stack_(std::move(stack)) {}
                 void operator()() {
-                  at::launch(InterpreterContinuation(
+                  taskLauncher_(InterpreterContinuation(
                       state_,
                       std::move(stack_),
                       autograd::GradMode::is_enabled()));
                 }
 
                private:
+                TaskLauncher taskLauncher_;
                 InterpreterState state_;
                 Stack stack_;
               };
@@ -1250,14 +1257,15 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
           case FORK: {
             // Move inputs to a separate stack
             InterpreterState forked_interpreter(
-                frames.back().function->code_table_.at(inst.X));
+                frames.back().function->code_table_.at(inst.X),
+                taskLauncher_);
             InterpreterContinuation continuation(
                 forked_interpreter,
                 Stack(stack.end() - inst.N, stack.end()),
                 autograd::GradMode::is_enabled());
             drop(stack, inst.N);
             push(stack, forked_interpreter.getFuture());
-            at::launch(std::move(continuation));
+            taskLauncher_(std::move(continuation));
             ++af.pc;
           } break;
           case WARN: {
@@ -1410,8 +1418,12 @@ size_t Code::register_size() const {
   return pImpl->register_size_;
 }
 
-InterpreterState::InterpreterState(const Code& code)
-    : pImpl(c10::make_intrusive<InterpreterStateImpl>(code)) {}
+InterpreterState::InterpreterState(
+    const Code& code,
+    TaskLauncher taskLauncher)
+    : pImpl(c10::make_intrusive<InterpreterStateImpl>(
+          code,
+          std::move(taskLauncher))) {}
 InterpreterState::~InterpreterState() = default;
 
 void InterpreterState::run(Stack& stack) {
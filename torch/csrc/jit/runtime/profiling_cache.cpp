@@ -0,0 +1,310 @@
+#include <torch/csrc/jit/runtime/profiling_cache.h>
+
+#include <c10/util/Exception.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/runtime/profiling_record.h>
+#include <torch/csrc/jit/serialization/pickle.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Bumped whenever the encoding below changes
+constexpr int64_t kProfilingCacheVersion = 1;
+
+struct ProfilingCacheEntry {
+  std::vector<TypePtr> input_types;
+  std::vector<TypePtr> profiles;
+};
+
+std::mutex& cacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::string, std::vector<ProfilingCacheEntry>>& cache() {
+  static std::unordered_map<std::string, std::vector<ProfilingCacheEntry>>
+      entries;
+  return entries;
+}
+
+bool sameTypes(const std::vector<TypePtr>& a, const std::vector<TypePtr>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (static_cast<bool>(a[i]) != static_cast<bool>(b[i]) ||
+        (a[i] && *a[i] != *b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Must be called with cacheMutex() held
+void insertEntry(const std::string& key, ProfilingCacheEntry entry) {
+  auto& entries = cache()[key];
+  for (auto& e : entries) {
+    if (sameTypes(e.input_types, entry.input_types)) {
+      e = std::move(entry);
+      return;
+    }
+  }
+  entries.push_back(std::move(entry));
+}
+
+// The single output prim::profile nodes of an instrumented graph, in the
+// same order for every instrumentation of the same graph
+void collectProfileNodes(Block* b, std::vector<Node*>& nodes) {
+  for (auto n : b->nodes()) {
+    if (n->kind() == prim::profile && n->outputs().size() == 1) {
+      nodes.push_back(n);
+    }
+    for (auto ib : n->blocks()) {
+      collectProfileNodes(ib, nodes);
+    }
+  }
+}
+
+template <typename T>
+IValue encodeOptional(const c10::optional<T>& value) {
+  return value ? IValue(*value) : IValue();
+}
+
+IValue encodeShape(const VaryingShape& shape) {
+  if (!shape.size()) {
+    return IValue();
+  }
+  std::vector<IValue> dims;
+  for (size_t i = 0; i < *shape.size(); ++i) {
+    dims.push_back(encodeOptional(shape[i]));
+  }
+  return c10::ivalue::Tuple::create(std::move(dims));
+}
+
+VaryingShape decodeShape(const IValue& value) {
+  if (value.isNone()) {
+    return VaryingShape();
+  }
+  VaryingShape::ListOfOptionalInts dims;
+  for (const auto& dim : value.toTuple()->elements()) {
+    dims.push_back(
+        dim.isNone() ? c10::nullopt : c10::optional<int64_t>(dim.toInt()));
+  }
+  return VaryingShape(std::move(dims));
+}
+
+// Only tensor types are stored, anything else is None
+IValue encodeType(const TypePtr& type) {
+  auto tt = type ? type->cast<TensorType>() : nullptr;
+  if (!tt) {
+    return IValue();
+  }
+  return c10::ivalue::Tuple::create(
+      {tt->scalarType() ? IValue(static_cast<int64_t>(*tt->scalarType()))
+                        : IValue(),
+       tt->device() ? IValue(tt->device()->str()) : IValue(),
+       encodeShape(tt->sizes()),
+       encodeShape(tt->strides()),
+       encodeOptional(tt->requiresGrad()),
+       encodeOptional(tt->undefined())});
+}
+
+TypePtr decodeType(const IValue& value) {
+  if (value.isNone()) {
+    return nullptr;
+  }
+  const auto& fields = value.toTuple()->elements();
+  TORCH_CHECK(fields.size() == 6, "Malformed tensor type in profiling cache");
+  auto optionalBool = [](const IValue& v) {
+    return v.isNone() ? c10::nullopt : c10::optional<bool>(v.toBool());
+  };
+  return TensorType::create(
+      fields[0].isNone() ? c10::nullopt
+                         : c10::optional<at::ScalarType>(
+                               static_cast<at::ScalarType>(fields[0].toInt())),
+      fields[1].isNone() ? c10::nullopt
+                         : c10::optional<at::Device>(
+                               at::Device(fields[1].toStringRef())),
+      decodeShape(fields[2]),
+      decodeShape(fields[3]),
+      optionalBool(fields[4]),
+      optionalBool(fields[5]));
+}
+
+IValue encodeTypes(const std::vector<TypePtr>& types) {
+  std::vector<IValue> encoded;
+  for (const auto& type : types) {
+    encoded.push_back(encodeType(type));
+  }
+  return c10::ivalue::Tuple::create(std::move(encoded));
+}
+
+std::vector<TypePtr> decodeTypes(const IValue& value) {
+  std::vector<TypePtr> types;
+  for (const auto& type : value.toTuple()->elements()) {
+    types.push_back(decodeType(type));
+  }
+  return types;
+}
+
+} // namespace
+
+std::atomic<bool>& getProfilingCacheMode() {
+  static std::atomic<bool> profiling_cache_mode{false};
+  return profiling_cache_mode;
+}
+
+std::string profilingCacheKey(const Graph& graph) {
+  // FNV-1a rather than std::hash, so that the keys do not depend on the
+  // standard library the file was written with
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : graph.toString(/*print_source_locations=*/false)) {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+  return key;
+}
+
+std::vector<TypePtr> profilingCacheInputTypes(
+    const Stack& stack,
+    size_t num_inputs) {
+  AT_ASSERT(stack.size() >= num_inputs);
+  std::vector<TypePtr> types;
+  for (const auto& input : last(stack, num_inputs)) {
+    types.push_back(
+        input.isTensor() ? tensorTypeInCurrentExecutionContext(input.toTensor())
+                         : nullptr);
+  }
+  return types;
+}
+
+void storeProfiles(
+    const std::string& key,
+    std::vector<TypePtr> input_types,
+    ProfilingRecord& pr) {
+  AT_ASSERT(pr.ready());
+  std::vector<Node*> nodes;
+  collectProfileNodes(pr.graph()->block(), nodes);
+  ProfilingCacheEntry entry;
+  entry.input_types = std::move(input_types);
+  {
+    // profiling runs that started before the record became ready may still
+    // be updating the types
+    std::lock_guard<std::mutex> lock(pr.mutex_);
+    for (auto n : nodes) {
+      entry.profiles.push_back(n->output()->type());
+    }
+  }
+  GRAPH_DEBUG("Storing ", nodes.size(), " profiles under ", key);
+  std::lock_guard<std::mutex> guard(cacheMutex());
+  insertEntry(key, std::move(entry));
+}
+
+bool restoreProfiles(
+    const std::string& key,
+    const std::vector<TypePtr>& input_types,
+    ProfilingRecord& pr) {
+  std::vector<Node*> nodes;
+  collectProfileNodes(pr.graph()->block(), nodes);
+  std::lock_guard<std::mutex> guard(cacheMutex());
+  auto it = cache().find(key);
+  if (it == cache().end()) {
+    return false;
+  }
+  for (const auto& entry : it->second) {
+    if (!sameTypes(entry.input_types, input_types)) {
+      continue;
+    }
+    if (entry.profiles.size() != nodes.size()) {
+      GRAPH_DEBUG("Ignoring mismatched profiles under ", key);
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(pr.mutex_);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      // only tensor types are stored
+      if (entry.profiles[i]) {
+        nodes[i]->output()->setType(entry.profiles[i]);
+      }
+    }
+    pr.profiling_count_ = 0;
+    GRAPH_DEBUG("Restored ", nodes.size(), " profiles from ", key);
+    return true;
+  }
+  return false;
+}
+
+void saveProfilingCache(const std::string& filename) {
+  std::vector<IValue> entries;
+  {
+    std::lock_guard<std::mutex> guard(cacheMutex());
+    for (const auto& kv : cache()) {
+      for (const auto& entry : kv.second) {
+        entries.push_back(c10::ivalue::Tuple::create(
+            {IValue(kv.first),
+             encodeTypes(entry.input_types),
+             encodeTypes(entry.profiles)}));
+      }
+    }
+  }
+  auto data = pickle_save(c10::ivalue::Tuple::create(
+      {IValue(kProfilingCacheVersion),
+       c10::ivalue::Tuple::create(std::move(entries))}));
+  std::ofstream out(filename, std::ios::binary);
+  TORCH_CHECK(out, "Could not open ", filename, " to save the profiling cache");
+  out.write(data.data(), data.size());
+  TORCH_CHECK(out, "Could not write the profiling cache to ", filename);
+}
+
+void loadProfilingCache(const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  TORCH_CHECK(in, "Could not open ", filename, " to load the profiling cache");
+  std::vector<char> data(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  auto value = pickle_load(data);
+  const auto& fields = value.toTuple()->elements();
+  TORCH_CHECK(
+      fields.size() == 2 && fields[0].toInt() == kProfilingCacheVersion,
+      "Unsupported profiling cache format in ",
+      filename);
+  std::vector<std::pair<std::string, ProfilingCacheEntry>> entries;
+  for (const auto& e : fields[1].toTuple()->elements()) {
+    const auto& entry_fields = e.toTuple()->elements();
+    TORCH_CHECK(
+        entry_fields.size() == 3, "Malformed entry in profiling cache");
+    ProfilingCacheEntry entry;
+    entry.input_types = decodeTypes(entry_fields[1]);
+    entry.profiles = decodeTypes(entry_fields[2]);
+    entries.emplace_back(entry_fields[0].toStringRef(), std::move(entry));
+  }
+  std::lock_guard<std::mutex> guard(cacheMutex());
+  for (auto& entry : entries) {
+    insertEntry(entry.first, std::move(entry.second));
+  }
+}
+
+void clearProfilingCache() {
+  std::lock_guard<std::mutex> guard(cacheMutex());
+  cache().clear();
+}
+
+size_t debugNumCachedProfiles() {
+  std::lock_guard<std::mutex> guard(cacheMutex());
+  size_t n = 0;
+  for (const auto& kv : cache()) {
+    n += kv.second.size();
+  }
+  return n;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ATen/core/jit_type.h>
+#include <ATen/core/stack.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+struct ProfilingRecord;
+
+// Note [Profiling cache]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// ProfilingGraphExecutorImpl runs getNumProfiledRuns() instrumented
+// executions before it specializes a graph, and a new process has to repeat
+// them. When the profiling cache is enabled, every executor that finishes
+// profiling stores the types recorded by its prim::profile nodes, keyed by a
+// hash of its graph and by the types of the inputs of its first run. The
+// cache can be saved to a file and loaded by another process; an executor
+// whose graph and first inputs match an entry then skips profiling and
+// builds its optimized plan on the first run.
+//
+// Only the profiles are stored, the optimized graph is rebuilt from them.
+// The guards inserted from the profiles still check every run, so a stale
+// or colliding entry costs a bailout, not a wrong result.
+
+// Enables recording and restoring profiles, off by default
+TORCH_API std::atomic<bool>& getProfilingCacheMode();
+
+// Returns the key of the profiles of the given graph
+TORCH_API std::string profilingCacheKey(const Graph& graph);
+
+// Returns the types that select a cache entry for the inputs on the stack
+TORCH_API std::vector<TypePtr> profilingCacheInputTypes(
+    const Stack& stack,
+    size_t num_inputs);
+
+// Stores the profiles of a ready record
+TORCH_API void storeProfiles(
+    const std::string& key,
+    std::vector<TypePtr> input_types,
+    ProfilingRecord& pr);
+
+// Applies cached profiles to a newly instrumented record and marks it ready.
+// Returns false, leaving the record untouched, if there is no matching entry.
+TORCH_API bool restoreProfiles(
+    const std::string& key,
+    const std::vector<TypePtr>& input_types,
+    ProfilingRecord& pr);
+
+// Writes all entries to the file, in the format of torch::pickle_save
+TORCH_API void saveProfilingCache(const std::string& filename);
+
+// Adds the entries in the file, replacing entries with the same key and
+// input types
+TORCH_API void loadProfilingCache(const std::string& filename);
+
+TORCH_API void clearProfilingCache();
+
+// Returns the number of cached entries.
+// Only used for testing.
+TORCH_API size_t debugNumCachedProfiles();
+
+} // namespace jit
+} // namespace torch
@@ -19,6 +19,7 @@
 #include <torch/csrc/jit/passes/requires_grad_analysis.h>
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
+#include <torch/csrc/jit/runtime/profiling_cache.h>
 #include <torch/csrc/jit/runtime/profiling_graph_executor_impl.h>
 
 namespace torch {
@@ -163,6 +164,15 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
     auto copy = graph->copy();
     runProfilingInsensitiveOptimizations(copy);
     pr_ = ProfilingRecord::instrumentGraph(copy);
+    if (getProfilingCacheMode()) {
+      auto key = profilingCacheKey(*graph);
+      auto input_types = profilingCacheInputTypes(stack, num_inputs);
+      // a cache hit leaves pr_ ready, so we skip straight to optimizing
+      if (!restoreProfiles(key, input_types, *pr_)) {
+        profiling_cache_key_ = std::move(key);
+        profiled_input_types_ = std::move(input_types);
+      }
+    }
     auto pr_copy = pr_->graph()->copy();
     GRAPH_DUMP("Profiled Graph: ", pr_copy);
     profiling_plan_ = ExecutionPlan(pr_copy);
@@ -174,6 +184,12 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
     return *profiling_plan_;
   }
 
+  if (profiling_cache_key_) {
+    storeProfiles(
+        *profiling_cache_key_, std::move(profiled_input_types_), *pr_);
+    profiling_cache_key_ = c10::nullopt;
+  }
+
   auto copy = pr_->graph()->copy();
   runProfilingOptimizations(copy);
   // cache
@@ -19,6 +19,10 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   c10::optional<ExecutionPlan>
       profiling_plan_; // plan to run in order to profiling the code
   c10::optional<ExecutionPlan> optimized_plan_;
+  // set while profiling with the profiling cache enabled,
+  // see Note [Profiling cache]
+  c10::optional<std::string> profiling_cache_key_;
+  std::vector<TypePtr> profiled_input_types_;
 };
 
 } // namespace jit
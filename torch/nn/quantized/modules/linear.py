@@ -72,12 +72,23 @@ class LinearPackedParams(torch.nn.Module):
                                ' See https://github.com/pytorch/pytorch/issues/24045.'
                                ' Please use state_dict or torch.jit serialization.')
         qweight, bias = self._weight_bias()
-        return qweight, bias, self.training, self.dtype
+        # The backend-packed weight is saved next to the portable weight so
+        # that a process with the same quantized engine and CPU can load it
+        # without prepacking again.
+        packed = torch.ops.quantized.linear_prepack_serialize(self._packed_params)
+        return qweight, bias, self.training, self.dtype, packed
 
     @torch.jit.export
     def __setstate__(self, state):
         self.dtype = state[3]
-        self.set_weight_bias(state[0], state[1])
+        if torch.jit.is_scripting():
+            # TorchScript archives carry the __setstate__ they were saved with
+            self._packed_params = torch.ops.quantized.linear_prepack_deserialize(state[4], state[0], state[1])
+        elif len(state) > 4:
+            self._packed_params = torch.ops.quantized.linear_prepack_deserialize(state[4], state[0], state[1])
+        else:
+            # state saved before the packed weight was added to it
+            self.set_weight_bias(state[0], state[1])
         self.training = state[2]
 
 class Linear(torch.nn.Module):